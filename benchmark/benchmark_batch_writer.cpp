@@ -0,0 +1,92 @@
+#include <catch2/catch_test_macros.hpp>
+#include <catch2/benchmark/catch_benchmark.hpp>
+
+#include "ki_cas_batch_writer.h"
+
+#include <vector>
+
+using namespace KiCAS2;
+
+TEST_CASE("write_native_rationals (100k)") {
+    std::vector<NativeRational> vals;
+    for(size_t i = 0; i < 100000; i++) vals.push_back(NativeRational(i * 2654435761uLL, i + 1));
+
+    BENCHMARK_ADVANCED( "write_native_rational loop" )(Catch::Benchmark::Chronometer meter) {
+        std::string str;
+        meter.measure([&](){
+            str.clear();
+            str.shrink_to_fit();
+            for(size_t i = 0; i < vals.size(); i++){
+                if(i != 0) str += ", ";
+                write_native_rational<TYPESET_OUTPUT>(str, vals[i]);
+            }
+            return str.size();
+        });
+    };
+
+    BENCHMARK_ADVANCED( "write_native_rationals" )(Catch::Benchmark::Chronometer meter) {
+        std::string str;
+        meter.measure([&](){
+            str.clear();
+            str.shrink_to_fit();
+            write_native_rationals(str, vals.data(), vals.size(), TYPESET_BATCH_FORMAT);
+            return str.size();
+        });
+    };
+
+    BENCHMARK_ADVANCED( "write_native_rationals (4 threads)" )(Catch::Benchmark::Chronometer meter) {
+        std::string str;
+        meter.measure([&](){
+            str.clear();
+            str.shrink_to_fit();
+            write_native_rationals(str, vals.data(), vals.size(), TYPESET_BATCH_FORMAT, 4);
+            return str.size();
+        });
+    };
+}
+
+TEST_CASE("write_big_rationals (100k)") {
+    std::vector<fmpq> vals(100000);
+    for(size_t i = 0; i < vals.size(); i++){
+        fmpq_init(&vals[i]);
+        fmpz_set_ui(fmpq_numref(&vals[i]), i);
+        if(i % 16 == 0) fmpz_fac_ui(fmpq_denref(&vals[i]), 30);
+        else fmpz_set_ui(fmpq_denref(&vals[i]), i % 16);
+        fmpq_canonicalise(&vals[i]);
+    }
+
+    BENCHMARK_ADVANCED( "write_big_rational loop" )(Catch::Benchmark::Chronometer meter) {
+        std::string str;
+        meter.measure([&](){
+            str.clear();
+            str.shrink_to_fit();
+            for(size_t i = 0; i < vals.size(); i++){
+                if(i != 0) str += ", ";
+                write_big_rational<PLAINTEXT_OUTPUT>(str, &vals[i]);
+            }
+            return str.size();
+        });
+    };
+
+    BENCHMARK_ADVANCED( "write_big_rationals" )(Catch::Benchmark::Chronometer meter) {
+        std::string str;
+        meter.measure([&](){
+            str.clear();
+            str.shrink_to_fit();
+            write_big_rationals(str, vals.data(), vals.size(), PLAINTEXT_BATCH_FORMAT);
+            return str.size();
+        });
+    };
+
+    BENCHMARK_ADVANCED( "write_big_rationals (4 threads)" )(Catch::Benchmark::Chronometer meter) {
+        std::string str;
+        meter.measure([&](){
+            str.clear();
+            str.shrink_to_fit();
+            write_big_rationals(str, vals.data(), vals.size(), PLAINTEXT_BATCH_FORMAT, 4);
+            return str.size();
+        });
+    };
+
+    for(fmpq& val : vals) fmpq_clear(&val);
+}
@@ -0,0 +1,89 @@
+#include <catch2/catch_test_macros.hpp>
+#include <catch2/benchmark/catch_benchmark.hpp>
+
+#include "ki_cas_big_num_store.h"
+#include <cstdio>
+#include <random>
+#include <thread>
+#include <vector>
+
+using namespace KiCAS2;
+
+/// A DAG's worth of constants: 64 distinct values of a few words, each occurring 1024 times in random order
+static std::vector<fmpq> repeated_constants() {
+    constexpr size_t NUM_DISTINCT = 64;
+    constexpr size_t NUM_REPEATS = 1024;
+    std::mt19937_64 rng(42);
+    std::vector<fmpq> distinct(NUM_DISTINCT);
+    for(fmpq& val : distinct){
+        fmpq_init(&val);
+        fmpq_set_ui(&val, rng() | 1, (rng() >> 1) | 1);
+        fmpq_mul(&val, &val, &val);
+        fmpq_mul(&val, &val, &val);
+    }
+
+    std::vector<fmpq> vals(NUM_DISTINCT * NUM_REPEATS);
+    for(fmpq& val : vals){
+        fmpq_init(&val);
+        fmpq_set(&val, &distinct[rng() % NUM_DISTINCT]);
+    }
+    for(fmpq& val : distinct) fmpq_clear(&val);
+
+    return vals;
+}
+
+TEST_CASE("BigNumStore") {
+    std::vector<fmpq> vals = repeated_constants();
+
+    {
+        BigNumStore store;
+        size_t copied_bytes = 0;
+        for(const fmpq& val : vals){
+            store.intern(&val);
+            copied_bytes += fmpq_heap_bytes(&val);
+        }
+        std::printf("BigNumStore: %zu values held in %zu heap bytes, rather than %zu bytes as copies\n",
+                    vals.size(), store.heapBytes(), copied_bytes);
+    }
+
+    BENCHMARK_ADVANCED( "intern repeated values" )(Catch::Benchmark::Chronometer meter) {
+        BigNumStore store;
+        std::vector<BigNumStore::Handle> handles(vals.size());
+        meter.measure([&](){for(size_t i = 0; i < vals.size(); i++) handles[i] = store.intern(&vals[i]);});
+    };
+
+    BENCHMARK_ADVANCED( "find interned values" )(Catch::Benchmark::Chronometer meter) {
+        BigNumStore store;
+        for(const fmpq& val : vals) store.intern(&val);
+        std::vector<BigNumStore::Handle> handles(vals.size());
+        meter.measure([&](){for(size_t i = 0; i < vals.size(); i++) handles[i] = store.find(&vals[i]);});
+    };
+
+    BENCHMARK_ADVANCED( "find interned values (4 threads)" )(Catch::Benchmark::Chronometer meter) {
+        BigNumStore store;
+        for(const fmpq& val : vals) store.intern(&val);
+        std::vector<BigNumStore::Handle> handles(vals.size());
+        meter.measure([&](){
+            std::vector<std::thread> threads;
+            for(size_t t = 0; t < 4; t++){
+                threads.emplace_back([&store, &vals, &handles, t](){
+                    for(size_t i = t; i < vals.size(); i += 4) handles[i] = store.find(&vals[i]);
+                });
+            }
+            for(std::thread& thread : threads) thread.join();
+        });
+    };
+
+    BENCHMARK_ADVANCED( "fmpq_init_set copies" )(Catch::Benchmark::Chronometer meter) {
+        std::vector<fmpq> copies(vals.size());
+        meter.measure([&](){
+            for(size_t i = 0; i < vals.size(); i++){
+                fmpq_init(&copies[i]);
+                fmpq_set(&copies[i], &vals[i]);
+            }
+            for(fmpq& copy : copies) fmpq_clear(&copy);
+        });
+    };
+
+    for(fmpq& val : vals) fmpq_clear(&val);
+}
@@ -2,6 +2,10 @@
 #include <catch2/benchmark/catch_benchmark.hpp>
 
 #include "ki_cas_big_num_wrapper.h"
+#include "ki_cas_native_rational_array.h"
+#include <random>
+#include <string>
+#include <vector>
 
 using namespace KiCAS2;
 
@@ -276,3 +280,293 @@ TEST_CASE("fmpq_from_scientific_str (rational result)") {
         fmpq_clear(&big_rat);
     };
 }
+
+TEST_CASE("write_big_rational") {
+    fmpq_t val;
+    fmpq_init(val);
+    fmpz_set_si(fmpq_numref(val), -1);
+    fmpz_fac_ui(fmpq_denref(val), 30);
+    std::string str;
+    str.reserve(256);
+
+    BENCHMARK_ADVANCED( "PlaintextStyle" )(Catch::Benchmark::Chronometer meter) {
+        meter.measure([&](){ str.clear(); write_big_rational<PlaintextStyle>(str, val); });
+    };
+
+    BENCHMARK_ADVANCED( "TypesetStyle" )(Catch::Benchmark::Chronometer meter) {
+        meter.measure([&](){ str.clear(); write_big_rational<TypesetStyle>(str, val); });
+    };
+
+    BENCHMARK_ADVANCED( "LatexStyle" )(Catch::Benchmark::Chronometer meter) {
+        meter.measure([&](){ str.clear(); write_big_rational<LatexStyle>(str, val); });
+    };
+
+    BENCHMARK_ADVANCED( "MathMLStyle" )(Catch::Benchmark::Chronometer meter) {
+        meter.measure([&](){ str.clear(); write_big_rational<MathMLStyle>(str, val); });
+    };
+
+    BENCHMARK_ADVANCED( "fmpq_get_str" )(Catch::Benchmark::Chronometer meter) {
+        meter.measure([&](){
+            char* buffer = fmpq_get_str(nullptr, 10, val);
+            str.clear();
+            str += buffer;
+            flint_free(buffer);
+        });
+    };
+
+    fmpq_clear(val);
+}
+
+static void naiveDecimalExpansion(std::string& str, const fmpq_t val, size_t max_fraction_digits) {
+    fmpz_t digit, rem;
+    fmpz_init(digit);
+    fmpz_init(rem);
+    fmpz_tdiv_qr(digit, rem, fmpq_numref(val), fmpq_denref(val));
+    char* buffer = fmpz_get_str(nullptr, 10, digit);
+    str += buffer;
+    flint_free(buffer);
+    str += '.';
+    for(size_t i = 0; i < max_fraction_digits && !fmpz_is_zero(rem); i++){
+        fmpz_mul_ui(rem, rem, 10);
+        fmpz_fdiv_qr(digit, rem, rem, fmpq_denref(val));
+        str += static_cast<char>('0' + fmpz_get_ui(digit));
+    }
+    fmpz_clear(digit);
+    fmpz_clear(rem);
+}
+
+TEST_CASE("write_rational_as_decimal fmpq") {
+    fmpq_t val;
+    fmpq_init(val);
+    fmpz_set_ui(fmpq_numref(val), 1);
+    fmpz_fac_ui(fmpq_denref(val), 30);
+    std::string str;
+    str.reserve(256);
+
+    BENCHMARK_ADVANCED( "write_rational_as_decimal" )(Catch::Benchmark::Chronometer meter) {
+        meter.measure([&](){ str.clear(); write_rational_as_decimal(str, val, 64); });
+    };
+
+    BENCHMARK_ADVANCED( "naiveDecimalExpansion" )(Catch::Benchmark::Chronometer meter) {
+        meter.measure([&](){ str.clear(); naiveDecimalExpansion(str, val, 64); });
+    };
+
+    fmpq_clear(val);
+}
+
+TEST_CASE("Canonical hash") {
+    std::mt19937_64 rng(43);
+    std::vector<NativeRational> native_vals;
+    for(size_t i = 0; i < 1024; i++) native_vals.push_back(NativeRational(rng() % 1000000, rng() % 1000 + 1));
+    std::vector<fmpq> big_vals(1024);
+    for(size_t i = 0; i < big_vals.size(); i++){
+        fmpq_init(&big_vals[i]);
+        fmpq_set_ui(&big_vals[i], rng(), rng() | 1);
+        fmpq_mul_ui(&big_vals[i], &big_vals[i], rng());
+    }
+
+    BENCHMARK_ADVANCED( "std::hash of write_big_rational" )(Catch::Benchmark::Chronometer meter) {
+        std::string str;
+        meter.measure([&](){
+            size_t combined = 0;
+            for(const fmpq& val : big_vals){
+                str.clear();
+                write_big_rational(str, &val);
+                combined ^= std::hash<std::string>()(str);
+            }
+            return combined;
+        });
+    };
+
+    BENCHMARK_ADVANCED( "canonical_hash (fmpq)" )(Catch::Benchmark::Chronometer meter) {
+        meter.measure([&](){
+            size_t combined = 0;
+            for(const fmpq& val : big_vals) combined ^= canonical_hash(&val);
+            return combined;
+        });
+    };
+
+    BENCHMARK_ADVANCED( "std::hash of reduced write_native_rational" )(Catch::Benchmark::Chronometer meter) {
+        std::string str;
+        meter.measure([&](){
+            size_t combined = 0;
+            for(NativeRational val : native_vals){
+                val.reduceInPlace();
+                str.clear();
+                write_native_rational(str, val);
+                combined ^= std::hash<std::string>()(str);
+            }
+            return combined;
+        });
+    };
+
+    BENCHMARK_ADVANCED( "canonical_hash (NativeRational)" )(Catch::Benchmark::Chronometer meter) {
+        meter.measure([&](){
+            size_t combined = 0;
+            for(const NativeRational val : native_vals) combined ^= canonical_hash(val);
+            return combined;
+        });
+    };
+
+    BENCHMARK_ADVANCED( "canonical_hashes (NativeRational)" )(Catch::Benchmark::Chronometer meter) {
+        std::vector<size_t> hashes(native_vals.size());
+        meter.measure([&](){
+            canonical_hashes(hashes.data(), native_vals.data(), native_vals.size());
+            return hashes.back();
+        });
+    };
+
+    for(fmpq& val : big_vals) fmpq_clear(&val);
+}
+
+TEST_CASE("Mixed fmpq and NativeRational arithmetic") {
+    std::mt19937_64 rng(44);
+    std::vector<NativeRational> native_vals;
+    for(size_t i = 0; i < 1024; i++) native_vals.push_back(NativeRational(rng() % 1000000, rng() % 1000 + 1));
+    fmpq_t big_rat;
+    fmpq_init(big_rat);
+    fmpq_set_ui(big_rat, rng(), rng() | 1);
+    fmpq_mul_ui(big_rat, big_rat, rng());
+    fmpq_t result;
+    fmpq_init(result);
+
+    BENCHMARK_ADVANCED( "fmpq_add of converted values" )(Catch::Benchmark::Chronometer meter) {
+        meter.measure([&](){
+            for(const NativeRational val : native_vals){
+                fmpq_t converted;
+                fmpq_init(converted);
+                fmpq_set_ui(converted, val.num, val.den);
+                fmpq_add(result, big_rat, converted);
+                fmpq_clear(converted);
+            }
+        });
+    };
+
+    BENCHMARK_ADVANCED( "fmpq_add_native" )(Catch::Benchmark::Chronometer meter) {
+        meter.measure([&](){for(const NativeRational val : native_vals) fmpq_add_native(result, big_rat, val);});
+    };
+
+    BENCHMARK_ADVANCED( "fmpq_mul of converted values" )(Catch::Benchmark::Chronometer meter) {
+        meter.measure([&](){
+            for(const NativeRational val : native_vals){
+                fmpq_t converted;
+                fmpq_init(converted);
+                fmpq_set_ui(converted, val.num, val.den);
+                fmpq_mul(result, big_rat, converted);
+                fmpq_clear(converted);
+            }
+        });
+    };
+
+    BENCHMARK_ADVANCED( "fmpq_mul_native" )(Catch::Benchmark::Chronometer meter) {
+        meter.measure([&](){for(const NativeRational val : native_vals) fmpq_mul_native(result, big_rat, val);});
+    };
+
+    BENCHMARK_ADVANCED( "fmpq_cmp of converted values" )(Catch::Benchmark::Chronometer meter) {
+        meter.measure([&](){
+            int combined = 0;
+            for(const NativeRational val : native_vals){
+                fmpq_t converted;
+                fmpq_init(converted);
+                fmpq_set_ui(converted, val.num, val.den);
+                combined += fmpq_cmp(big_rat, converted);
+                fmpq_clear(converted);
+            }
+            return combined;
+        });
+    };
+
+    BENCHMARK_ADVANCED( "fmpq_cmp_native" )(Catch::Benchmark::Chronometer meter) {
+        meter.measure([&](){
+            int combined = 0;
+            for(const NativeRational val : native_vals) combined += fmpq_cmp_native(big_rat, val);
+            return combined;
+        });
+    };
+
+    fmpq_clear(result);
+    fmpq_clear(big_rat);
+}
+
+TEST_CASE("Demotion to NativeRational") {
+    // Mostly inline values with some that stay big, as left by a big computation which shrinks again
+    std::mt19937_64 rng(45);
+    std::vector<fmpq> big_vals(1024);
+    for(fmpq& val : big_vals){
+        fmpq_init(&val);
+        fmpq_set_ui(&val, rng() >> 8, (rng() >> 8) | 1);
+        if(rng() % 8 == 0) fmpq_mul(&val, &val, &val);
+    }
+    std::vector<SignedNativeRational> signed_results(big_vals.size());
+    std::vector<NativeRational> results(big_vals.size());
+    std::vector<uint8_t> overflow(big_vals.size());
+
+    BENCHMARK_ADVANCED( "ckd_fmpq2signed" )(Catch::Benchmark::Chronometer meter) {
+        meter.measure([&](){
+            size_t num_failed = 0;
+            for(size_t i = 0; i < big_vals.size(); i++) num_failed += ckd_fmpq2signed(&signed_results[i], &big_vals[i]);
+            return num_failed;
+        });
+    };
+
+    BENCHMARK_ADVANCED( "ckd_fmpq2native" )(Catch::Benchmark::Chronometer meter) {
+        meter.measure([&](){
+            size_t num_failed = 0;
+            for(size_t i = 0; i < big_vals.size(); i++) num_failed += ckd_fmpq2native(&results[i], &big_vals[i]);
+            return num_failed;
+        });
+    };
+
+    BENCHMARK_ADVANCED( "ckd_fmpq2native (batch)" )(Catch::Benchmark::Chronometer meter) {
+        meter.measure([&](){return ckd_fmpq2native(results.data(), overflow.data(), big_vals.data(), big_vals.size());});
+    };
+
+    for(fmpq& val : big_vals) fmpq_clear(&val);
+}
+
+TEST_CASE("Filtered comparisons") {
+    // Products of word-sized fractions, as a CAS ordering compares, where exact comparison cross multiplies
+    std::mt19937_64 rng(46);
+    std::vector<fmpq> big_vals(1024);
+    for(fmpq& val : big_vals){
+        fmpq_init(&val);
+        fmpq_set_ui(&val, rng(), rng() | 1);
+        fmpq_mul(&val, &val, &val);
+    }
+    std::vector<NativeRational> native_vals;
+    for(size_t i = 0; i < big_vals.size(); i++) native_vals.push_back(NativeRational(rng(), rng() | 1));
+
+    BENCHMARK_ADVANCED( "fmpq_cmp" )(Catch::Benchmark::Chronometer meter) {
+        meter.measure([&](){
+            int combined = 0;
+            for(size_t i = 1; i < big_vals.size(); i++) combined += fmpq_cmp(&big_vals[i-1], &big_vals[i]);
+            return combined;
+        });
+    };
+
+    BENCHMARK_ADVANCED( "fmpq_cmp_filtered" )(Catch::Benchmark::Chronometer meter) {
+        meter.measure([&](){
+            int combined = 0;
+            for(size_t i = 1; i < big_vals.size(); i++) combined += fmpq_cmp_filtered(&big_vals[i-1], &big_vals[i]);
+            return combined;
+        });
+    };
+
+    BENCHMARK_ADVANCED( "fmpq_cmp_native" )(Catch::Benchmark::Chronometer meter) {
+        meter.measure([&](){
+            int combined = 0;
+            for(size_t i = 0; i < big_vals.size(); i++) combined += fmpq_cmp_native(&big_vals[i], native_vals[i]);
+            return combined;
+        });
+    };
+
+    BENCHMARK_ADVANCED( "fmpq_cmp_filtered (NativeRational)" )(Catch::Benchmark::Chronometer meter) {
+        meter.measure([&](){
+            int combined = 0;
+            for(size_t i = 0; i < big_vals.size(); i++) combined += fmpq_cmp_filtered(&big_vals[i], native_vals[i]);
+            return combined;
+        });
+    };
+
+    for(fmpq& val : big_vals) fmpq_clear(&val);
+}
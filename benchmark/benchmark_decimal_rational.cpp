@@ -0,0 +1,127 @@
+#include <catch2/catch_test_macros.hpp>
+#include <catch2/benchmark/catch_benchmark.hpp>
+
+#include "ki_cas_decimal_rational.h"
+#include "ki_cas_big_num_wrapper.h"
+#include <random>
+#include <string>
+#include <vector>
+
+using namespace KiCAS2;
+
+/// Decimal literals as found in typical input, with up to four integer and four fractional digits
+static std::vector<std::string> decimalLiterals() {
+    std::mt19937_64 rng(35);
+    std::vector<std::string> literals;
+    for(size_t i = 0; i < 1024; i++){
+        const size_t num_fraction_digits = rng() % 5;
+        std::string literal = std::to_string(rng() % 10000) + '.';
+        for(size_t j = 0; j < num_fraction_digits; j++) literal += static_cast<char>('0' + rng() % 10);
+        literals.push_back(literal);
+    }
+
+    return literals;
+}
+
+TEST_CASE("Decimal literal parsing") {
+    const auto literals = decimalLiterals();
+
+    BENCHMARK_ADVANCED( "ckd_strdecimal2dec" )(Catch::Benchmark::Chronometer meter) {
+        DecimalRational result;
+        size_t num_overflows = 0;
+        meter.measure([&](){
+            for(const std::string& literal : literals) num_overflows += ckd_strdecimal2dec(&result, literal);
+            return num_overflows;
+        });
+    };
+
+    BENCHMARK_ADVANCED( "ckd_strdecimal2rat" )(Catch::Benchmark::Chronometer meter) {
+        NativeRational result;
+        size_t num_overflows = 0;
+        meter.measure([&](){
+            for(const std::string& literal : literals) num_overflows += ckd_strdecimal2rat(&result, literal);
+            return num_overflows;
+        });
+    };
+}
+
+TEST_CASE("Decimal literal sum") {
+    const auto literals = decimalLiterals();
+    std::vector<DecimalRational> decimals(literals.size());
+    std::vector<NativeRational> rationals(literals.size());
+    for(size_t i = 0; i < literals.size(); i++){
+        REQUIRE_FALSE(ckd_strdecimal2dec(&decimals[i], literals[i]));
+        REQUIRE_FALSE(ckd_strdecimal2rat(&rationals[i], literals[i]));
+    }
+
+    BENCHMARK_ADVANCED( "DecimalRational" )(Catch::Benchmark::Chronometer meter) {
+        meter.measure([&](){
+            DecimalRational sum(0, 0, 0);
+            for(const DecimalRational val : decimals) if(ckd_add(&sum, sum, val)) break;
+            return sum;
+        });
+    };
+
+    BENCHMARK_ADVANCED( "NativeRational" )(Catch::Benchmark::Chronometer meter) {
+        meter.measure([&](){
+            NativeRational sum(0, 1);
+            for(const NativeRational val : rationals) if(ckd_add(&sum, sum, val)) break;
+            return sum;
+        });
+    };
+
+    BENCHMARK_ADVANCED( "CanonicalRational" )(Catch::Benchmark::Chronometer meter) {
+        meter.measure([&](){
+            CanonicalRational sum(NativeRational(0, 1));
+            for(const NativeRational val : rationals)
+                if(ckd_add(&sum, sum, CanonicalRational::fromReduced(val))) break;
+            return sum;
+        });
+    };
+
+    BENCHMARK_ADVANCED( "fmpq_t" )(Catch::Benchmark::Chronometer meter) {
+        fmpq_t sum;
+        fmpq_init(sum);
+        fmpq_t val;
+        fmpq_init(val);
+        meter.measure([&](){
+            fmpq_set_ui(sum, 0, 1);
+            for(const NativeRational rat : rationals){
+                fmpq_set_ui(val, rat.num, rat.den);
+                fmpq_add(sum, sum, val);
+            }
+        });
+        fmpq_clear(val);
+        fmpq_clear(sum);
+    };
+}
+
+TEST_CASE("Decimal literal products") {
+    const auto literals = decimalLiterals();
+    std::vector<DecimalRational> decimals(literals.size());
+    std::vector<NativeRational> rationals(literals.size());
+    for(size_t i = 0; i < literals.size(); i++){
+        REQUIRE_FALSE(ckd_strdecimal2dec(&decimals[i], literals[i]));
+        REQUIRE_FALSE(ckd_strdecimal2rat(&rationals[i], literals[i]));
+    }
+
+    BENCHMARK_ADVANCED( "DecimalRational" )(Catch::Benchmark::Chronometer meter) {
+        DecimalRational result;
+        size_t num_overflows = 0;
+        meter.measure([&](){
+            for(size_t i = 1; i < decimals.size(); i++) num_overflows += ckd_mul(&result, decimals[i-1], decimals[i]);
+            return num_overflows;
+        });
+    };
+
+    BENCHMARK_ADVANCED( "CanonicalRational" )(Catch::Benchmark::Chronometer meter) {
+        CanonicalRational result;
+        size_t num_overflows = 0;
+        meter.measure([&](){
+            for(size_t i = 1; i < rationals.size(); i++)
+                num_overflows += ckd_mul(&result, CanonicalRational::fromReduced(rationals[i-1]),
+                                                  CanonicalRational::fromReduced(rationals[i]));
+            return num_overflows;
+        });
+    };
+}
@@ -0,0 +1,129 @@
+#include <catch2/catch_test_macros.hpp>
+#include <catch2/benchmark/catch_benchmark.hpp>
+
+#include "ki_cas_native_float.h"
+#include <charconv>
+#include <cstdio>
+#include <random>
+#include <vector>
+
+using namespace KiCAS2;
+
+static std::vector<FloatingPoint> random_floats(size_t n, int min_exponent, int max_exponent) {
+    std::mt19937_64 generator(42);
+    std::uniform_int_distribution<int> exponent(min_exponent, max_exponent);
+    std::vector<FloatingPoint> vals(n);
+    for(FloatingPoint& val : vals) val = std::ldexp(static_cast<FloatingPoint>(generator()), exponent(generator) - 64);
+    return vals;
+}
+
+static void run_float_benchmarks(const std::vector<FloatingPoint>& vals) {
+    std::string str;
+    str.reserve(64 * vals.size());
+
+    BENCHMARK_ADVANCED( "write_float" )(Catch::Benchmark::Chronometer meter) {
+        meter.measure([&](){
+            str.clear();
+            for(const FloatingPoint val : vals) write_float(str, val);
+        });
+    };
+
+    BENCHMARK_ADVANCED( "write_float (scientific, precision 6)" )(Catch::Benchmark::Chronometer meter) {
+        meter.measure([&](){
+            str.clear();
+            for(const FloatingPoint val : vals) write_float(str, val, FloatNotation::Scientific, 6);
+        });
+    };
+
+#if !defined(__GNUC__) || __GNUC__ > 8
+    BENCHMARK_ADVANCED( "std::to_chars" )(Catch::Benchmark::Chronometer meter) {
+        meter.measure([&](){
+            str.clear();
+            for(const FloatingPoint val : vals){
+                char buffer[64];
+                const std::to_chars_result result = std::to_chars(buffer, buffer+64, val, std::chars_format::general);
+                str.append(buffer, result.ptr - buffer);
+            }
+        });
+    };
+#endif
+
+    BENCHMARK_ADVANCED( "snprintf %.21Lg" )(Catch::Benchmark::Chronometer meter) {
+        meter.measure([&](){
+            str.clear();
+            for(const FloatingPoint val : vals){
+                char buffer[64];
+                const int size = std::snprintf(buffer, 64, "%.21Lg", val);
+                str.append(buffer, static_cast<size_t>(size));
+            }
+        });
+    };
+
+    BENCHMARK_ADVANCED( "snprintf %.6Le" )(Catch::Benchmark::Chronometer meter) {
+        meter.measure([&](){
+            str.clear();
+            for(const FloatingPoint val : vals){
+                char buffer[64];
+                const int size = std::snprintf(buffer, 64, "%.6Le", val);
+                str.append(buffer, static_cast<size_t>(size));
+            }
+        });
+    };
+}
+
+TEST_CASE("write_float (integers)") {
+    std::vector<FloatingPoint> vals(1000);
+    for(size_t i = 0; i < vals.size(); i++) vals[i] = static_cast<FloatingPoint>(i * 7919);
+    run_float_benchmarks(vals);
+}
+
+TEST_CASE("write_float (moderate exponents)") {
+    run_float_benchmarks(random_floats(1000, -30, 30));
+}
+
+TEST_CASE("write_float (full exponent range)") {
+    run_float_benchmarks(random_floats(1000, std::numeric_limits<FloatingPoint>::min_exponent,
+                                             std::numeric_limits<FloatingPoint>::max_exponent - 1));
+}
+
+TEST_CASE("write_float (double, full exponent range)") {
+    std::mt19937_64 generator(42);
+    std::uniform_int_distribution<int> exponent(std::numeric_limits<double>::min_exponent,
+                                                std::numeric_limits<double>::max_exponent - 1);
+    std::vector<double> vals(1000);
+    for(double& val : vals) val = std::ldexp(static_cast<double>(generator() >> 11), exponent(generator) - 53);
+
+    std::string str;
+    str.reserve(64 * vals.size());
+
+    BENCHMARK_ADVANCED( "write_float" )(Catch::Benchmark::Chronometer meter) {
+        meter.measure([&](){
+            str.clear();
+            for(const double val : vals) write_float(str, val);
+        });
+    };
+
+#if !defined(__GNUC__) || __GNUC__ > 8
+    BENCHMARK_ADVANCED( "std::to_chars" )(Catch::Benchmark::Chronometer meter) {
+        meter.measure([&](){
+            str.clear();
+            for(const double val : vals){
+                char buffer[64];
+                const std::to_chars_result result = std::to_chars(buffer, buffer+64, val, std::chars_format::general);
+                str.append(buffer, result.ptr - buffer);
+            }
+        });
+    };
+#endif
+
+    BENCHMARK_ADVANCED( "snprintf %.17g" )(Catch::Benchmark::Chronometer meter) {
+        meter.measure([&](){
+            str.clear();
+            for(const double val : vals){
+                char buffer[64];
+                const int size = std::snprintf(buffer, 64, "%.17g", val);
+                str.append(buffer, static_cast<size_t>(size));
+            }
+        });
+    };
+}
@@ -3,6 +3,12 @@
 
 #include "ki_cas_native_integer.h"
 #include "ki_cas_big_num_wrapper.h"
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <random>
+#include <utility>
+#include <vector>
 
 using namespace KiCAS2;
 
@@ -58,8 +64,97 @@ TEST_CASE("ckd_nrt") {
     };
 };
 
+TEST_CASE("Integer roots (random arguments)") {
+    // Arguments of every bit length, which are almost never exact powers
+    std::mt19937_64 rng(42);
+    std::vector<size_t> args(1024);
+    for(size_t& arg : args) arg = static_cast<size_t>(rng()) >> (rng() % std::numeric_limits<size_t>::digits);
+
+    BENCHMARK_ADVANCED( "ckd_sqrt" )(Catch::Benchmark::Chronometer meter) {
+        meter.measure([&](){
+            size_t combined = 0;
+            for(const size_t arg : args){
+                size_t ans;
+                combined += ckd_sqrt(&ans, arg) + ans;
+            }
+            return combined;
+        });
+    };
+
+    BENCHMARK_ADVANCED( "n_sqrt" )(Catch::Benchmark::Chronometer meter) {
+        meter.measure([&](){
+            size_t combined = 0;
+            for(const size_t arg : args){
+                const size_t ans = n_sqrt(arg);
+                combined += (ans*ans != arg) + ans;
+            }
+            return combined;
+        });
+    };
+
+    BENCHMARK_ADVANCED( "ckd_cbrt" )(Catch::Benchmark::Chronometer meter) {
+        meter.measure([&](){
+            size_t combined = 0;
+            for(const size_t arg : args){
+                size_t ans;
+                combined += ckd_cbrt(&ans, arg) + ans;
+            }
+            return combined;
+        });
+    };
+
+    BENCHMARK_ADVANCED( "n_cbrt" )(Catch::Benchmark::Chronometer meter) {
+        meter.measure([&](){
+            size_t combined = 0;
+            for(const size_t arg : args){
+                const size_t ans = n_cbrt(arg);
+                combined += (ans*ans*ans != arg) + ans;
+            }
+            return combined;
+        });
+    };
+};
+
+TEST_CASE("ckd_nrt (mixed powers)") {
+    // An exact power for every power from 4, alongside its neighbour which is not
+    std::mt19937_64 rng(42);
+    std::vector<std::pair<size_t, size_t>> args;
+    for(size_t power = 4; power < std::numeric_limits<size_t>::digits; power++){
+        for(size_t i = 0; i < 16; i++){
+            size_t base = 2 + rng() % 64;
+            size_t raised;
+            while(ckd_pow(&raised, base, power)) base /= 2;
+            args.emplace_back(raised, power);
+            args.emplace_back(raised - 1, power);
+        }
+    }
+    std::shuffle(args.begin(), args.end(), rng);
+
+    BENCHMARK_ADVANCED( "ckd_nrt" )(Catch::Benchmark::Chronometer meter) {
+        meter.measure([&](){
+            size_t combined = 0;
+            for(const auto& [arg, power] : args){
+                size_t ans;
+                combined += ckd_nrt(&ans, arg, power) + ans;
+            }
+            return combined;
+        });
+    };
+
+    BENCHMARK_ADVANCED( "n_root" )(Catch::Benchmark::Chronometer meter) {
+        meter.measure([&](){
+            size_t combined = 0;
+            for(const auto& [arg, power] : args){
+                const size_t ans = n_root(arg, power);
+                combined += (n_pow(ans, power) != arg) + ans;
+            }
+            return combined;
+        });
+    };
+};
+
 TEST_CASE("knownfit_pow") {
-    BENCHMARK_ADVANCED( "ckd_pow_helper" )(Catch::Benchmark::Chronometer meter) {
+    BENCHMARK_ADVANCED( "ckd_pow" )(Catch::Benchmark::Chronometer meter) {
         size_t ans;
         bool overflowed;
         meter.measure([&](){overflowed = ckd_pow(&ans, 7, 11);});
@@ -79,3 +174,101 @@ TEST_CASE("knownfit_pow") {
         REQUIRE(ans == 1977326743uLL);
     };
 };
+
+TEST_CASE("knownfit_pow (mixed bases and powers)") {
+    // Every power which fits for bases up to 64, with some which overflow for ckd_pow
+    std::vector<std::pair<size_t, size_t>> fitting;
+    std::vector<std::pair<size_t, size_t>> mixed;
+    for(size_t base = 2; base <= 64; base++){
+        for(size_t power = 1; power < 64; power++){
+            const double log2_result = power * std::log2(static_cast<double>(base));
+            if(log2_result < std::numeric_limits<size_t>::digits - 1) fitting.emplace_back(base, power);
+            if(log2_result < 2 * std::numeric_limits<size_t>::digits) mixed.emplace_back(base, power);
+        }
+    }
+
+    BENCHMARK_ADVANCED( "ckd_pow" )(Catch::Benchmark::Chronometer meter) {
+        meter.measure([&](){
+            size_t combined = 0;
+            for(const auto& [base, power] : mixed){
+                size_t ans;
+                combined += ckd_pow(&ans, base, power) ? 1 : ans;
+            }
+            return combined;
+        });
+    };
+
+    BENCHMARK_ADVANCED( "knownfit_pow" )(Catch::Benchmark::Chronometer meter) {
+        meter.measure([&](){
+            size_t combined = 0;
+            for(const auto& [base, power] : fitting) combined += knownfit_pow(base, power);
+            return combined;
+        });
+    };
+
+    BENCHMARK_ADVANCED( "n_pow" )(Catch::Benchmark::Chronometer meter) {
+        meter.measure([&](){
+            size_t combined = 0;
+            for(const auto& [base, power] : fitting) combined += n_pow(base, power);
+            return combined;
+        });
+    };
+};
+
+TEST_CASE("is_perfect_power") {
+    // Every power with a root of at least 2, mixed in with as many random arguments which are almost never powers
+    std::mt19937_64 rng(5);
+    std::vector<size_t> args;
+    for(size_t power = 2; power < std::numeric_limits<size_t>::digits; power++){
+        for(size_t root = 2;; root++){
+            size_t arg;
+            if(ckd_pow(&arg, root, power) || args.size() >= 4096*power) break;
+            args.push_back(arg);
+        }
+    }
+    for(size_t i = args.size(); i > 0; i--) args.push_back(rng() >> (rng() % std::numeric_limits<size_t>::digits));
+    std::shuffle(args.begin(), args.end(), rng);
+
+    BENCHMARK_ADVANCED( "is_perfect_power" )(Catch::Benchmark::Chronometer meter) {
+        meter.measure([&](){
+            size_t combined = 0;
+            for(size_t arg : args){
+                size_t base;
+                combined += is_perfect_power(&base, arg) + base;
+            }
+            return combined;
+        });
+    };
+
+    BENCHMARK_ADVANCED( "Root for every exponent" )(Catch::Benchmark::Chronometer meter) {
+        meter.measure([&](){
+            size_t combined = 0;
+            for(size_t arg : args){
+                size_t base = arg;
+                size_t exponent = 1;
+                for(size_t power = 2; power < std::numeric_limits<size_t>::digits && (size_t(1) << power) <= arg; power++){
+                    size_t root;
+                    const bool inexact = (power == 2) ? ckd_sqrt(&root, arg)
+                                       : (power == 3) ? ckd_cbrt(&root, arg) : ckd_nrt(&root, arg, power);
+                    if(!inexact){
+                        base = root;
+                        exponent = power;
+                    }
+                }
+                combined += exponent + base;
+            }
+            return combined;
+        });
+    };
+
+    BENCHMARK_ADVANCED( "n_is_perfect_power" )(Catch::Benchmark::Chronometer meter) {
+        meter.measure([&](){
+            size_t combined = 0;
+            for(size_t arg : args){
+                ulong base = arg;
+                combined += n_is_perfect_power(&base, arg) + base;
+            }
+            return combined;
+        });
+    };
+};
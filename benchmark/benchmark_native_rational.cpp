@@ -1,8 +1,16 @@
 #include <catch2/catch_test_macros.hpp>
 #include <catch2/benchmark/catch_benchmark.hpp>
 
+#include "ki_cas_native_integer.h"
 #include "ki_cas_native_rational.h"
 #include "ki_cas_big_num_wrapper.h"
+#include "ki_cas_rational_accumulator.h"
+#include "ki_cas_wide_integer.h"
+#include <algorithm>
+#include <cstdio>
+#include <numeric>
+#include <random>
+#include <vector>
 
 using namespace KiCAS2;
 
@@ -90,3 +98,434 @@ TEST_CASE("delayed normalisation") {
         });
     };
 }
+
+/// Ratios of the Fibonacci numbers over the primes, followed by their reciprocals when round_trip is set,
+/// so the product is 1 while the running product overflows half way
+static std::vector<NativeRational> fibonacciOverPrimeChain(size_t length, bool round_trip) {
+    std::vector<NativeRational> chain;
+    size_t fib_prev = 1;
+    size_t fib = 1;
+    size_t prime = 1;
+    for(size_t i = 0; i < length; i++){
+        chain.emplace_back(fib, prime);
+        const size_t fib_next = fib_prev + fib;
+        fib_prev = fib;
+        fib = fib_next;
+        do{ prime++; }while(std::any_of(chain.begin(), chain.end(), [prime](NativeRational entry){
+            return entry.den > 1 && prime % entry.den == 0; }));
+    }
+
+    if(round_trip) for(size_t i = 0; i < length; i++) chain.push_back(chain[i].reciprocal());
+    return chain;
+}
+
+TEST_CASE("delayed normalisation (long chains)") {
+    for(size_t length : {12, 24, 40}){
+        for(bool round_trip : {true, false}){
+            const auto chain = fibonacciOverPrimeChain(length, round_trip);
+            const std::string suffix = " (" + std::to_string(chain.size()) + (round_trip ? " factors, round trip)" : " factors)");
+
+            BENCHMARK_ADVANCED( "chained ckd_mul" + suffix )(Catch::Benchmark::Chronometer meter) {
+                size_t num_overflows = 0;
+                meter.measure([&](){
+                    NativeRational result(1, 1);
+                    for(const NativeRational factor : chain){
+                        if(ckd_mul(&result, result, factor)){
+                            num_overflows++;
+                            break;
+                        }
+                    }
+                    return result;
+                });
+            };
+
+            BENCHMARK_ADVANCED( "RationalProductAccumulator" + suffix )(Catch::Benchmark::Chronometer meter) {
+                meter.measure([&](){
+                    RationalProductAccumulator product;
+                    for(const NativeRational factor : chain) product.mul(factor);
+                    NativeRational result;
+                    if(product.ckd_result(&result) == false) return result.num;
+
+                    fmpq big_result = fmpq_from_product(product);
+                    const size_t size = fmpz_size(&big_result.num);
+                    fmpq_clear(&big_result);
+                    return size;
+                });
+            };
+
+            BENCHMARK_ADVANCED( "fmpq_t" + suffix )(Catch::Benchmark::Chronometer meter) {
+                meter.measure([&](){
+                    fmpq_t result;
+                    fmpq_init(result);
+                    fmpq_set_ui(result, 1, 1);
+                    fmpq_t other;
+                    fmpq_init(other);
+                    for(const NativeRational factor : chain){
+                        fmpq_set_ui(other, factor.num, factor.den);
+                        fmpq_mul(result, result, other);
+                    }
+                    fmpq_clear(other);
+                    fmpq_clear(result);
+                });
+            };
+        }
+    }
+}
+
+static void appendTypesetPerMarker(std::string& str, NativeRational val) {
+    str += "⁜f⏴";
+    write_native_int(str, val.num);
+    str += "⏵⏴";
+    write_native_int(str, val.den);
+    str += "⏵";
+}
+
+TEST_CASE("write_native_rational") {
+    const NativeRational val(2998000000000, 1602176634);
+    std::string str;
+    str.reserve(256);
+
+    BENCHMARK_ADVANCED( "PlaintextStyle" )(Catch::Benchmark::Chronometer meter) {
+        meter.measure([&](){ str.clear(); write_native_rational<PlaintextStyle>(str, val); });
+    };
+
+    BENCHMARK_ADVANCED( "TypesetStyle" )(Catch::Benchmark::Chronometer meter) {
+        meter.measure([&](){ str.clear(); write_native_rational<TypesetStyle>(str, val); });
+    };
+
+    BENCHMARK_ADVANCED( "LatexStyle" )(Catch::Benchmark::Chronometer meter) {
+        meter.measure([&](){ str.clear(); write_native_rational<LatexStyle>(str, val); });
+    };
+
+    BENCHMARK_ADVANCED( "MathMLStyle" )(Catch::Benchmark::Chronometer meter) {
+        meter.measure([&](){ str.clear(); write_native_rational<MathMLStyle>(str, val); });
+    };
+
+    BENCHMARK_ADVANCED( "appendTypesetPerMarker" )(Catch::Benchmark::Chronometer meter) {
+        meter.measure([&](){ str.clear(); appendTypesetPerMarker(str, val); });
+    };
+}
+
+TEST_CASE("write_rational_as_decimal") {
+    std::string str;
+    str.reserve(256);
+
+    BENCHMARK_ADVANCED( "write_rational_as_decimal (terminating)" )(Catch::Benchmark::Chronometer meter) {
+        meter.measure([&](){ str.clear(); write_rational_as_decimal(str, NativeRational(2049, 1024)); });
+    };
+
+    BENCHMARK_ADVANCED( "write_rational_as_decimal (repeating)" )(Catch::Benchmark::Chronometer meter) {
+        meter.measure([&](){ str.clear(); write_rational_as_decimal(str, NativeRational(1, 17)); });
+    };
+
+    BENCHMARK_ADVANCED( "snprintf %.32Lf" )(Catch::Benchmark::Chronometer meter) {
+        char buffer[64];
+        meter.measure([&](){
+            str.clear();
+            str.append(buffer, snprintf(buffer, sizeof(buffer), "%.32Lf", static_cast<long double>(NativeRational(1, 17))));
+        });
+    };
+}
+
+/// The previous ckd_mul, which retried checked multiplies after each gcd
+static bool cascadingGcdMul(NativeRational* result, NativeRational a, NativeRational b) noexcept {
+    if(ckd_mul(&result->num, a.num, b.num) == false && ckd_mul(&result->den, a.den, b.den) == false)
+        return false;
+
+    const size_t gcd_a = std::gcd(a.num, a.den);
+    if(gcd_a != 1){
+        a.num /= gcd_a;
+        a.den /= gcd_a;
+        if(ckd_mul(&result->num, a.num, b.num) == false && ckd_mul(&result->den, a.den, b.den) == false)
+            return false;
+    }
+
+    const size_t gcd_b = std::gcd(b.num, b.den);
+    if(gcd_b != 1){
+        b.num /= gcd_b;
+        b.den /= gcd_b;
+        if(ckd_mul(&result->num, a.num, b.num) == false && ckd_mul(&result->den, a.den, b.den) == false)
+            return false;
+    }
+
+    const size_t gcd_a_num_b_den = std::gcd(a.num, b.den);
+    if(gcd_a_num_b_den != 1){
+        a.num /= gcd_a_num_b_den;
+        b.den /= gcd_a_num_b_den;
+        if(ckd_mul(&result->num, a.num, b.num) == false && ckd_mul(&result->den, a.den, b.den) == false)
+            return false;
+    }
+
+    const size_t gcd_b_num_a_den = std::gcd(b.num, a.den);
+    if(gcd_b_num_a_den != 1){
+        b.num /= gcd_b_num_a_den;
+        a.den /= gcd_b_num_a_den;
+        if(ckd_mul(&result->num, a.num, b.num) == false && ckd_mul(&result->den, a.den, b.den) == false)
+            return false;
+    }
+
+    return true;
+}
+
+/// Canonical operand pairs whose unreduced products have about the given number of bits,
+/// with 8-bit factors shared across the operands which reduce the products by about 16 bits
+static std::vector<std::pair<NativeRational, NativeRational>> operandsWithProductBits(size_t bits) {
+    static constexpr size_t COMMON_BITS = 8;
+    std::mt19937_64 rng(bits);
+    const size_t mask = (size_t(1) << (bits/2 - COMMON_BITS)) - 1;
+    auto random_factor = [&](){ return (rng() & mask) | (mask/2 + 1); };
+    auto random_common = [&](){ return (rng() % (size_t(1) << COMMON_BITS)) | (size_t(1) << (COMMON_BITS-1)); };
+
+    std::vector<std::pair<NativeRational, NativeRational>> operands;
+    for(size_t i = 0; i < 1024; i++){
+        const size_t common_num = random_common();
+        const size_t common_den = random_common();
+        NativeRational a(random_factor() * common_num, random_factor() * common_den);
+        NativeRational b(random_factor() * common_den, random_factor() * common_num);
+        a.reduceInPlace();
+        b.reduceInPlace();
+        operands.emplace_back(a, b);
+    }
+
+    return operands;
+}
+
+TEST_CASE("ckd_mul near overflow") {
+    for(size_t bits : {48, 64, 72, 80, 88}){
+        const auto operands = operandsWithProductBits(bits);
+        const std::string suffix = " (" + std::to_string(bits) + "-bit products)";
+
+        BENCHMARK_ADVANCED( "ckd_mul" + suffix )(Catch::Benchmark::Chronometer meter) {
+            NativeRational result;
+            size_t num_overflows = 0;
+            meter.measure([&](){
+                for(const auto& [a, b] : operands) num_overflows += ckd_mul(&result, a, b);
+                return num_overflows;
+            });
+        };
+
+        BENCHMARK_ADVANCED( "cascadingGcdMul" + suffix )(Catch::Benchmark::Chronometer meter) {
+            NativeRational result;
+            size_t num_overflows = 0;
+            meter.measure([&](){
+                for(const auto& [a, b] : operands) num_overflows += cascadingGcdMul(&result, a, b);
+                return num_overflows;
+            });
+        };
+    }
+}
+
+/// The previous ckd_add, which reduced by three gcds and could still overflow when the sum fits once reduced
+static bool threeGcdAdd(NativeRational* result, NativeRational a, NativeRational b) noexcept {
+    size_t a_num_times_b_den;
+    size_t b_num_times_a_den;
+
+    if(ckd_mul(&result->den, a.den, b.den) == false
+       && ckd_mul(&a_num_times_b_den, a.num, b.den) == false
+       && ckd_mul(&b_num_times_a_den, b.num, a.den) == false
+       && ckd_add(&result->num, a_num_times_b_den, b_num_times_a_den) == false)
+        return false;
+
+    const size_t gcd_a_den_b_den = std::gcd(a.den, b.den);
+    const size_t gcd_a = std::gcd(a.num, a.den);
+    const size_t gcd_b = std::gcd(b.num, b.den);
+
+    const size_t a_den_divisor = knownfit_mul(gcd_a, gcd_a_den_b_den);
+    const size_t b_den_divior = knownfit_mul(gcd_b, gcd_a_den_b_den);
+
+    if(a_den_divisor != 1) a.den /= a_den_divisor;
+    if(b_den_divior != 1) b.den /= b_den_divior;
+    if(gcd_a != 1) a.num /= gcd_a;
+    if(gcd_b != 1) b.num /= gcd_b;
+
+    return ckd_mul(&result->den, a.den, b.den*gcd_a_den_b_den)
+       || ckd_mul(&a_num_times_b_den, a.num, b.den)
+       || ckd_mul(&b_num_times_a_den, b.num, a.den)
+       || ckd_add(&result->num, a_num_times_b_den, b_num_times_a_den);
+}
+
+TEST_CASE("ckd_add near overflow") {
+    for(size_t bits : {48, 64, 72, 80, 88}){
+        const auto operands = operandsWithProductBits(bits);
+        const std::string suffix = " (" + std::to_string(bits) + "-bit products)";
+
+        BENCHMARK_ADVANCED( "ckd_add" + suffix )(Catch::Benchmark::Chronometer meter) {
+            NativeRational result;
+            size_t num_overflows = 0;
+            meter.measure([&](){
+                for(const auto& [a, b] : operands) num_overflows += ckd_add(&result, a, b);
+                return num_overflows;
+            });
+        };
+
+        BENCHMARK_ADVANCED( "threeGcdAdd" + suffix )(Catch::Benchmark::Chronometer meter) {
+            NativeRational result;
+            size_t num_overflows = 0;
+            meter.measure([&](){
+                for(const auto& [a, b] : operands) num_overflows += threeGcdAdd(&result, a, b);
+                return num_overflows;
+            });
+        };
+    }
+}
+
+/// Keeping results canonical, compared with reducing NativeRational results after each operation
+TEST_CASE("CanonicalRational") {
+    for(size_t bits : {48, 72, 88}){
+        std::vector<std::pair<CanonicalRational, CanonicalRational>> operands;
+        for(const auto& [a, b] : operandsWithProductBits(bits))
+            operands.emplace_back(CanonicalRational::fromReduced(a), CanonicalRational::fromReduced(b));
+        const std::string suffix = " (" + std::to_string(bits) + "-bit products)";
+
+        BENCHMARK_ADVANCED( "NativeRational ckd_mul then reduceInPlace" + suffix )(Catch::Benchmark::Chronometer meter) {
+            NativeRational result;
+            size_t num_overflows = 0;
+            meter.measure([&](){
+                for(const auto& [a, b] : operands){
+                    if(ckd_mul(&result, NativeRational(a), NativeRational(b))) num_overflows++;
+                    else result.reduceInPlace();
+                }
+                return num_overflows;
+            });
+        };
+
+        BENCHMARK_ADVANCED( "CanonicalRational ckd_mul" + suffix )(Catch::Benchmark::Chronometer meter) {
+            CanonicalRational result;
+            size_t num_overflows = 0;
+            meter.measure([&](){
+                for(const auto& [a, b] : operands) num_overflows += ckd_mul(&result, a, b);
+                return num_overflows;
+            });
+        };
+
+        BENCHMARK_ADVANCED( "NativeRational ckd_add then reduceInPlace" + suffix )(Catch::Benchmark::Chronometer meter) {
+            NativeRational result;
+            size_t num_overflows = 0;
+            meter.measure([&](){
+                for(const auto& [a, b] : operands){
+                    if(ckd_add(&result, NativeRational(a), NativeRational(b))) num_overflows++;
+                    else result.reduceInPlace();
+                }
+                return num_overflows;
+            });
+        };
+
+        BENCHMARK_ADVANCED( "CanonicalRational ckd_add" + suffix )(Catch::Benchmark::Chronometer meter) {
+            CanonicalRational result;
+            size_t num_overflows = 0;
+            meter.measure([&](){
+                for(const auto& [a, b] : operands) num_overflows += ckd_add(&result, a, b);
+                return num_overflows;
+            });
+        };
+    }
+}
+
+/// Alternating-sign terms with small denominators, as in a series which cancels as it goes
+static std::vector<SignedNativeRational> alternatingTerms() {
+    std::vector<SignedNativeRational> terms;
+    for(size_t k = 0; k < 1024; k++) terms.emplace_back(NativeRational(k % 11 + 1, k % 7 + 1), k % 2 == 1);
+    return terms;
+}
+
+TEST_CASE("SignedNativeRational alternating series") {
+    const auto terms = alternatingTerms();
+
+    BENCHMARK_ADVANCED( "SignedNativeRational sum" )(Catch::Benchmark::Chronometer meter) {
+        meter.measure([&](){
+            SignedNativeRational sum(NativeRational(0, 1));
+            for(const SignedNativeRational term : terms) if(ckd_add(&sum, sum, term)) break;
+            return sum;
+        });
+    };
+
+    BENCHMARK_ADVANCED( "fmpq_t sum" )(Catch::Benchmark::Chronometer meter) {
+        std::vector<fmpq> big_terms;
+        for(const SignedNativeRational term : terms) big_terms.push_back(fmpq_from_signed_native_rational(term));
+        fmpq_t sum;
+        fmpq_init(sum);
+        meter.measure([&](){
+            fmpq_set_ui(sum, 0, 1);
+            for(fmpq& term : big_terms) fmpq_add(sum, sum, &term);
+        });
+        fmpq_clear(sum);
+        for(fmpq& term : big_terms) fmpq_clear(&term);
+    };
+
+    // Horner evaluation at a negative point alternates the sign of each partial result
+    const SignedNativeRational x(NativeRational(3, 4), true);
+    constexpr size_t DEGREE = 16;
+
+    BENCHMARK_ADVANCED( "SignedNativeRational Horner" )(Catch::Benchmark::Chronometer meter) {
+        size_t num_overflows = 0;
+        meter.measure([&](){
+            for(size_t start = 0; start + DEGREE < terms.size(); start += DEGREE){
+                SignedNativeRational result = terms[start];
+                for(size_t k = 1; k <= DEGREE; k++)
+                    if(ckd_mul(&result, result, x) || ckd_add(&result, result, terms[start+k])){
+                        num_overflows++;
+                        break;
+                    }
+            }
+            return num_overflows;
+        });
+    };
+
+    BENCHMARK_ADVANCED( "fmpq_t Horner" )(Catch::Benchmark::Chronometer meter) {
+        std::vector<fmpq> big_terms;
+        for(const SignedNativeRational term : terms) big_terms.push_back(fmpq_from_signed_native_rational(term));
+        fmpq big_x = fmpq_from_signed_native_rational(x);
+        fmpq_t result;
+        fmpq_init(result);
+        meter.measure([&](){
+            for(size_t start = 0; start + DEGREE < terms.size(); start += DEGREE){
+                fmpq_set(result, &big_terms[start]);
+                for(size_t k = 1; k <= DEGREE; k++){
+                    fmpq_mul(result, result, &big_x);
+                    fmpq_add(result, result, &big_terms[start+k]);
+                }
+            }
+        });
+        fmpq_clear(result);
+        fmpq_clear(&big_x);
+        for(fmpq& term : big_terms) fmpq_clear(&term);
+    };
+}
+
+TEST_CASE("gcd") {
+    std::mt19937_64 rng(33);
+    for(size_t bits : {16, 32, 64}){
+        const size_t mask = (bits >= std::numeric_limits<size_t>::digits) ? std::numeric_limits<size_t>::max()
+                                                                           : (size_t(1) << bits) - 1;
+        std::vector<NativeRational> vals;
+        for(size_t i = 0; i < 1024; i++){
+            const size_t common = 1 + (rng() & 0xFFF);
+            vals.push_back(NativeRational((rng() & mask) / common * common, ((rng() & mask) / common + 1) * common));
+        }
+        const std::string suffix = " (" + std::to_string(bits) + "-bit)";
+
+        BENCHMARK_ADVANCED( "binary_gcd" + suffix )(Catch::Benchmark::Chronometer meter) {
+            size_t total = 0;
+            meter.measure([&](){
+                for(const NativeRational& val : vals) total += binary_gcd(val.num, val.den);
+                return total;
+            });
+        };
+
+        BENCHMARK_ADVANCED( "std::gcd" + suffix )(Catch::Benchmark::Chronometer meter) {
+            size_t total = 0;
+            meter.measure([&](){
+                for(const NativeRational& val : vals) total += std::gcd(val.num, val.den);
+                return total;
+            });
+        };
+
+        BENCHMARK_ADVANCED( "reduceInPlace" + suffix )(Catch::Benchmark::Chronometer meter) {
+            std::vector<NativeRational> copies = vals;
+            meter.measure([&](){
+                for(NativeRational& val : copies) val.reduceInPlace();
+                return copies.back().den;
+            });
+        };
+    }
+}
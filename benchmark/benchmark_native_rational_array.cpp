@@ -0,0 +1,153 @@
+#include <catch2/catch_test_macros.hpp>
+#include <catch2/benchmark/catch_benchmark.hpp>
+
+#include "ki_cas_native_rational_array.h"
+#include <random>
+#include <string>
+#include <vector>
+
+using namespace KiCAS2;
+
+static constexpr size_t SIZE = 1000000;
+
+/// A column of measurement-sized values, with one lane in a thousand too large for the branch-free pass
+static NativeRationalArray column(size_t seed) {
+    std::mt19937_64 rng(seed);
+    NativeRationalArray vals;
+    for(size_t i = 0; i < SIZE; i++){
+        const bool large = (rng() % 1000 == 0);
+        vals.push_back(NativeRational(large ? rng() : rng() % 1000000, rng() % 1000 + 1));
+    }
+
+    return vals;
+}
+
+TEST_CASE("NativeRationalArray kernels (1M elements)") {
+    const NativeRationalArray a = column(40);
+    const NativeRationalArray b = column(41);
+    std::vector<NativeRational> a_scalar;
+    std::vector<NativeRational> b_scalar;
+    for(size_t i = 0; i < SIZE; i++){
+        a_scalar.push_back(a[i]);
+        b_scalar.push_back(b[i]);
+    }
+
+    NativeRationalArray result;
+    std::vector<uint8_t> overflow;
+    std::vector<NativeRational> scalar_result(SIZE);
+    std::vector<uint8_t> scalar_overflow(SIZE);
+
+    BENCHMARK_ADVANCED( "ckd_add array" )(Catch::Benchmark::Chronometer meter) {
+        meter.measure([&](){ return ckd_add(&result, a, b, &overflow); });
+    };
+    BENCHMARK_ADVANCED( "ckd_add scalar loop" )(Catch::Benchmark::Chronometer meter) {
+        meter.measure([&](){
+            for(size_t i = 0; i < SIZE; i++) scalar_overflow[i] = ckd_add(&scalar_result[i], a_scalar[i], b_scalar[i]);
+            return scalar_overflow.back();
+        });
+    };
+
+    BENCHMARK_ADVANCED( "ckd_mul array" )(Catch::Benchmark::Chronometer meter) {
+        meter.measure([&](){ return ckd_mul(&result, a, b, &overflow); });
+    };
+    BENCHMARK_ADVANCED( "ckd_mul scalar loop" )(Catch::Benchmark::Chronometer meter) {
+        meter.measure([&](){
+            for(size_t i = 0; i < SIZE; i++) scalar_overflow[i] = ckd_mul(&scalar_result[i], a_scalar[i], b_scalar[i]);
+            return scalar_overflow.back();
+        });
+    };
+
+    BENCHMARK_ADVANCED( "ckd_div array" )(Catch::Benchmark::Chronometer meter) {
+        meter.measure([&](){ return ckd_div(&result, a, b, &overflow); });
+    };
+    BENCHMARK_ADVANCED( "ckd_div scalar loop" )(Catch::Benchmark::Chronometer meter) {
+        meter.measure([&](){
+            for(size_t i = 0; i < SIZE; i++) scalar_overflow[i] = ckd_div(&scalar_result[i], a_scalar[i], b_scalar[i]);
+            return scalar_overflow.back();
+        });
+    };
+
+    BENCHMARK_ADVANCED( "ckd_sub array" )(Catch::Benchmark::Chronometer meter) {
+        meter.measure([&](){ return ckd_sub(&result, a, b, &overflow); });
+    };
+    BENCHMARK_ADVANCED( "ckd_sub scalar loop" )(Catch::Benchmark::Chronometer meter) {
+        meter.measure([&](){
+            for(size_t i = 0; i < SIZE; i++)
+                scalar_overflow[i] = a_scalar[i] < b_scalar[i] || ckd_sub(&scalar_result[i], a_scalar[i], b_scalar[i]);
+            return scalar_overflow.back();
+        });
+    };
+
+    std::vector<int8_t> ordering;
+    BENCHMARK_ADVANCED( "cmp array" )(Catch::Benchmark::Chronometer meter) {
+        meter.measure([&](){ cmp(&ordering, a, b); return ordering.back(); });
+    };
+    BENCHMARK_ADVANCED( "operator< scalar loop" )(Catch::Benchmark::Chronometer meter) {
+        meter.measure([&](){
+            for(size_t i = 0; i < SIZE; i++) scalar_overflow[i] = a_scalar[i] < b_scalar[i];
+            return scalar_overflow.back();
+        });
+    };
+}
+
+/// Full-width random values, or parsed decimals such as 12.3400 as 123400/10000
+static std::vector<NativeRational> uncanonicalised(bool decimal_origin) {
+    std::mt19937_64 rng(41);
+    std::vector<NativeRational> vals;
+    for(size_t i = 0; i < SIZE; i++){
+        if(decimal_origin){
+            size_t power_of_ten = 1;
+            for(size_t digits = rng() % 12; digits > 0; digits--) power_of_ten *= 10;
+            vals.push_back(NativeRational(rng() % 1000000000000, power_of_ten));
+        }else{
+            vals.push_back(NativeRational(rng(), rng() | 1));
+        }
+    }
+
+    return vals;
+}
+
+TEST_CASE("Canonicalise (1M elements)") {
+    for(bool decimal_origin : {false, true}){
+        const std::vector<NativeRational> vals = uncanonicalised(decimal_origin);
+        const std::string suffix = decimal_origin ? " (decimal origin)" : " (random)";
+
+        BENCHMARK_ADVANCED( "reduceInPlace loop" + suffix )(Catch::Benchmark::Chronometer meter) {
+            std::vector<NativeRational> copy;
+            meter.measure([&](){
+                copy = vals;  // Cancelling canonical values would measure a different workload
+                for(NativeRational& val : copy) val.reduceInPlace();
+                return copy.back().den;
+            });
+        };
+
+        BENCHMARK_ADVANCED( "canonicalise" + suffix )(Catch::Benchmark::Chronometer meter) {
+            std::vector<NativeRational> copy;
+            meter.measure([&](){
+                copy = vals;
+                canonicalise(copy.data(), copy.size());
+                return copy.back().den;
+            });
+        };
+
+        BENCHMARK_ADVANCED( "canonicalise SoA" + suffix )(Catch::Benchmark::Chronometer meter) {
+            NativeRationalArray soa;
+            for(const NativeRational val : vals) soa.push_back(val);
+            NativeRationalArray copy;
+            meter.measure([&](){
+                copy = soa;
+                canonicalise(&copy);
+                return copy.den.back();
+            });
+        };
+
+        BENCHMARK_ADVANCED( "canonicalise 4 threads" + suffix )(Catch::Benchmark::Chronometer meter) {
+            std::vector<NativeRational> copy;
+            meter.measure([&](){
+                copy = vals;
+                canonicalise(copy.data(), copy.size(), 4);
+                return copy.back().den;
+            });
+        };
+    }
+}
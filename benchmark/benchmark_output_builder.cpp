@@ -0,0 +1,65 @@
+#include <catch2/catch_test_macros.hpp>
+#include <catch2/benchmark/catch_benchmark.hpp>
+
+#include "ki_cas_output_builder.h"
+
+#include "ki_cas_big_num_wrapper.h"
+#include "ki_cas_native_float.h"
+#include "ki_cas_native_integer.h"
+#include "ki_cas_native_rational.h"
+#include <vector>
+
+using namespace KiCAS2;
+
+static void append(std::string& str, char ch) { str += ch; }
+static void append(OutputBuilder& out, char ch) { out.append(ch); }
+
+TEST_CASE("serialise 1M mixed numbers") {
+    constexpr size_t N = 1000000;
+
+    // Cycle through each writer, with a big rational in place of every fourth plaintext rational
+    std::vector<size_t> ints;
+    std::vector<NativeRational> rationals;
+    std::vector<FloatingPoint> floats;
+    for(size_t i = 0; i < N/4; i++){
+        ints.push_back(i * 2654435761uLL);
+        rationals.push_back(NativeRational(i*7 + 1, i*3 + 2));
+        floats.push_back(static_cast<FloatingPoint>(i) / 7);
+    }
+
+    fmpq_t big_rational;
+    fmpq_init(big_rational);
+    fmpz_set_si(fmpq_numref(big_rational), -1);
+    fmpz_fac_ui(fmpq_denref(big_rational), 30);
+
+    const auto serialise = [&](auto& out){
+        for(size_t i = 0; i < N/4; i++){
+            write_native_int(out, ints[i]);
+            append(out, ' ');
+            write_native_rational<TYPESET_OUTPUT>(out, rationals[i]);
+            append(out, ' ');
+            write_float(out, floats[i]);
+            append(out, ' ');
+            if(i % 4 == 0) write_big_rational<PLAINTEXT_OUTPUT>(out, big_rational);
+            else write_native_rational<PLAINTEXT_OUTPUT>(out, rationals[i]);
+            append(out, '\n');
+        }
+    };
+
+    std::string expected;
+    serialise(expected);
+
+    BENCHMARK_ADVANCED( "std::string" )(Catch::Benchmark::Chronometer meter) {
+        std::string str;
+        meter.measure([&](){ str.clear(); str.shrink_to_fit(); serialise(str); return str.size(); });
+        REQUIRE(str == expected);
+    };
+
+    BENCHMARK_ADVANCED( "OutputBuilder" )(Catch::Benchmark::Chronometer meter) {
+        OutputBuilder out;
+        meter.measure([&](){ out.clear(); serialise(out); return out.size(); });
+        REQUIRE(out.str() == expected);
+    };
+
+    fmpq_clear(big_rational);
+}
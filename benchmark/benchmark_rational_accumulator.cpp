@@ -0,0 +1,102 @@
+#include <catch2/catch_test_macros.hpp>
+#include <catch2/benchmark/catch_benchmark.hpp>
+
+#include "ki_cas_rational_accumulator.h"
+#include "ki_cas_big_num_wrapper.h"
+#include <random>
+#include <vector>
+
+using namespace KiCAS2;
+
+/// Canonical values over a common denominator, such as prices in cents, and over small mixed denominators
+static std::vector<NativeRational> summands(bool common_denominator) {
+    std::mt19937_64 rng(38);
+    std::vector<NativeRational> vals;
+    for(size_t i = 0; i < 1024; i++){
+        NativeRational val(rng() % 100000, common_denominator ? 100 : rng() % 12 + 1);
+        val.reduceInPlace();
+        vals.push_back(val);
+    }
+
+    return vals;
+}
+
+TEST_CASE("Rational sum") {
+    for(bool common_denominator : {true, false}){
+        const auto vals = summands(common_denominator);
+        const std::string suffix = common_denominator ? " (cents)" : " (mixed denominators)";
+
+        BENCHMARK_ADVANCED( "ckd_sum" + suffix )(Catch::Benchmark::Chronometer meter) {
+            NativeRational result;
+            meter.measure([&](){ return ckd_sum(&result, vals.data(), vals.size()); });
+        };
+
+        BENCHMARK_ADVANCED( "chained ckd_add" + suffix )(Catch::Benchmark::Chronometer meter) {
+            meter.measure([&](){
+                NativeRational sum(0, 1);
+                for(const NativeRational val : vals) if(ckd_add(&sum, sum, val)) break;
+                sum.reduceInPlace();
+                return sum;
+            });
+        };
+
+        BENCHMARK_ADVANCED( "fmpq_t" + suffix )(Catch::Benchmark::Chronometer meter) {
+            fmpq_t sum;
+            fmpq_init(sum);
+            fmpq_t val;
+            fmpq_init(val);
+            meter.measure([&](){
+                fmpq_set_ui(sum, 0, 1);
+                for(const NativeRational rat : vals){
+                    fmpq_set_ui(val, rat.num, rat.den);
+                    fmpq_add(sum, sum, val);
+                }
+            });
+            fmpq_clear(val);
+            fmpq_clear(sum);
+        };
+    }
+}
+
+TEST_CASE("Rational dot product") {
+    const auto a = summands(true);
+    const auto b = summands(false);
+
+    BENCHMARK_ADVANCED( "ckd_dot" )(Catch::Benchmark::Chronometer meter) {
+        NativeRational result;
+        meter.measure([&](){ return ckd_dot(&result, a.data(), b.data(), a.size()); });
+    };
+
+    BENCHMARK_ADVANCED( "chained ckd_mul and ckd_add" )(Catch::Benchmark::Chronometer meter) {
+        meter.measure([&](){
+            NativeRational sum(0, 1);
+            for(size_t i = 0; i < a.size(); i++){
+                NativeRational product;
+                if(ckd_mul(&product, a[i], b[i]) || ckd_add(&sum, sum, product)) break;
+            }
+            sum.reduceInPlace();
+            return sum;
+        });
+    };
+
+    BENCHMARK_ADVANCED( "fmpq_t" )(Catch::Benchmark::Chronometer meter) {
+        fmpq_t sum;
+        fmpq_init(sum);
+        fmpq_t a_val;
+        fmpq_init(a_val);
+        fmpq_t b_val;
+        fmpq_init(b_val);
+        meter.measure([&](){
+            fmpq_set_ui(sum, 0, 1);
+            for(size_t i = 0; i < a.size(); i++){
+                fmpq_set_ui(a_val, a[i].num, a[i].den);
+                fmpq_set_ui(b_val, b[i].num, b[i].den);
+                fmpq_mul(a_val, a_val, b_val);
+                fmpq_add(sum, sum, a_val);
+            }
+        });
+        fmpq_clear(b_val);
+        fmpq_clear(a_val);
+        fmpq_clear(sum);
+    };
+}
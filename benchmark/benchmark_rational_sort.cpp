@@ -0,0 +1,76 @@
+#include <catch2/catch_test_macros.hpp>
+#include <catch2/benchmark/catch_benchmark.hpp>
+
+#include "ki_cas_rational_sort.h"
+#include <algorithm>
+#include <numeric>
+#include <random>
+#include <string>
+#include <vector>
+
+using namespace KiCAS2;
+
+static constexpr size_t SIZE = 1000000;
+
+/// Full-width random values, or prices with many duplicates
+static std::vector<NativeRational> unsorted(bool prices) {
+    std::mt19937_64 rng(42);
+    std::vector<NativeRational> vals;
+    for(size_t i = 0; i < SIZE; i++){
+        if(prices) vals.push_back(NativeRational(rng() % 100000, 100));
+        else vals.push_back(NativeRational(rng() >> (rng() % 64), (rng() >> (rng() % 64)) | 1));
+    }
+
+    return vals;
+}
+
+TEST_CASE("Sort (1M elements)") {
+    for(bool prices : {false, true}){
+        const std::vector<NativeRational> vals = unsorted(prices);
+        const std::string suffix = prices ? " (prices)" : " (random)";
+
+        BENCHMARK_ADVANCED( "std::sort" + suffix )(Catch::Benchmark::Chronometer meter) {
+            std::vector<NativeRational> copy;
+            meter.measure([&](){
+                copy = vals;
+                std::sort(copy.begin(), copy.end());
+                return copy.back().num;
+            });
+        };
+
+        BENCHMARK_ADVANCED( "sort_native_rationals" + suffix )(Catch::Benchmark::Chronometer meter) {
+            std::vector<NativeRational> copy;
+            meter.measure([&](){
+                copy = vals;
+                sort_native_rationals(copy.data(), copy.size());
+                return copy.back().num;
+            });
+        };
+
+        BENCHMARK_ADVANCED( "sort_native_rationals 4 threads" + suffix )(Catch::Benchmark::Chronometer meter) {
+            std::vector<NativeRational> copy;
+            meter.measure([&](){
+                copy = vals;
+                sort_native_rationals(copy.data(), copy.size(), 4);
+                return copy.back().num;
+            });
+        };
+
+        BENCHMARK_ADVANCED( "std::stable_sort of indices" + suffix )(Catch::Benchmark::Chronometer meter) {
+            std::vector<size_t> indices(SIZE);
+            meter.measure([&](){
+                std::iota(indices.begin(), indices.end(), size_t(0));
+                std::stable_sort(indices.begin(), indices.end(), [&vals](size_t a, size_t b){ return vals[a] < vals[b]; });
+                return indices.back();
+            });
+        };
+
+        BENCHMARK_ADVANCED( "argsort_native_rationals" + suffix )(Catch::Benchmark::Chronometer meter) {
+            std::vector<size_t> indices(SIZE);
+            meter.measure([&](){
+                argsort_native_rationals(indices.data(), vals.data(), vals.size());
+                return indices.back();
+            });
+        };
+    }
+}
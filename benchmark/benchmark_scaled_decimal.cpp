@@ -0,0 +1,145 @@
+#include <catch2/catch_test_macros.hpp>
+#include <catch2/benchmark/catch_benchmark.hpp>
+
+#include "ki_cas_scaled_decimal.h"
+#include "ki_cas_big_num_wrapper.h"
+#include <random>
+#include <string>
+#include <vector>
+
+using namespace KiCAS2;
+
+/// Quantities in engineering units, such as `4.70e-6`, with three significant digits and a multiple-of-three exponent
+static std::vector<std::string> engineeringLiterals() {
+    std::mt19937_64 rng(36);
+    std::vector<std::string> literals;
+    for(size_t i = 0; i < 1024; i++){
+        const size_t significand = 100 + rng() % 900;
+        const int exponent = 3 * static_cast<int>(rng() % 5) - 6;
+        literals.push_back(std::to_string(significand / 100) + '.' + std::to_string(significand % 100 / 10)
+                           + std::to_string(significand % 10) + 'e' + std::to_string(exponent));
+    }
+
+    return literals;
+}
+
+TEST_CASE("Engineering literal parsing") {
+    const auto literals = engineeringLiterals();
+
+    BENCHMARK_ADVANCED( "ckd_strscientific2scaled" )(Catch::Benchmark::Chronometer meter) {
+        ScaledDecimal result;
+        size_t num_overflows = 0;
+        meter.measure([&](){
+            for(const std::string& literal : literals) num_overflows += ckd_strscientific2scaled(&result, literal);
+            return num_overflows;
+        });
+    };
+
+    BENCHMARK_ADVANCED( "ckd_strscientific2rat" )(Catch::Benchmark::Chronometer meter) {
+        NativeRational result;
+        size_t num_overflows = 0;
+        meter.measure([&](){
+            for(const std::string& literal : literals) num_overflows += ckd_strscientific2rat(&result, literal);
+            return num_overflows;
+        });
+    };
+}
+
+TEST_CASE("Engineering literal sum") {
+    const auto literals = engineeringLiterals();
+    std::vector<ScaledDecimal> scaled(literals.size());
+    std::vector<NativeRational> rationals(literals.size());
+    std::vector<DecimalRational> decimals(literals.size());
+    for(size_t i = 0; i < literals.size(); i++){
+        REQUIRE_FALSE(ckd_strscientific2scaled(&scaled[i], literals[i]));
+        REQUIRE_FALSE(ckd_strscientific2rat(&rationals[i], literals[i]));
+        rationals[i].reduceInPlace();
+        REQUIRE_FALSE(ckd_rat2dec(&decimals[i], rationals[i]));
+    }
+
+    BENCHMARK_ADVANCED( "ScaledDecimal" )(Catch::Benchmark::Chronometer meter) {
+        meter.measure([&](){
+            ScaledDecimal sum(0, 0);
+            for(const ScaledDecimal val : scaled) if(ckd_add(&sum, sum, val)) break;
+            return sum;
+        });
+    };
+
+    BENCHMARK_ADVANCED( "DecimalRational" )(Catch::Benchmark::Chronometer meter) {
+        meter.measure([&](){
+            DecimalRational sum(0, 0, 0);
+            for(const DecimalRational val : decimals) if(ckd_add(&sum, sum, val)) break;
+            return sum;
+        });
+    };
+
+    BENCHMARK_ADVANCED( "NativeRational" )(Catch::Benchmark::Chronometer meter) {
+        meter.measure([&](){
+            NativeRational sum(0, 1);
+            for(const NativeRational val : rationals) if(ckd_add(&sum, sum, val)) break;
+            return sum;
+        });
+    };
+
+    BENCHMARK_ADVANCED( "fmpq_t" )(Catch::Benchmark::Chronometer meter) {
+        fmpq_t sum;
+        fmpq_init(sum);
+        fmpq_t val;
+        fmpq_init(val);
+        meter.measure([&](){
+            fmpq_set_ui(sum, 0, 1);
+            for(const NativeRational rat : rationals){
+                fmpq_set_ui(val, rat.num, rat.den);
+                fmpq_add(sum, sum, val);
+            }
+        });
+        fmpq_clear(val);
+        fmpq_clear(sum);
+    };
+}
+
+TEST_CASE("Engineering literal products") {
+    const auto literals = engineeringLiterals();
+    std::vector<ScaledDecimal> scaled(literals.size());
+    std::vector<DecimalRational> decimals(literals.size());
+    for(size_t i = 0; i < literals.size(); i++){
+        REQUIRE_FALSE(ckd_strscientific2scaled(&scaled[i], literals[i]));
+        NativeRational rational;
+        REQUIRE_FALSE(ckd_strscientific2rat(&rational, literals[i]));
+        rational.reduceInPlace();
+        REQUIRE_FALSE(ckd_rat2dec(&decimals[i], rational));
+    }
+
+    BENCHMARK_ADVANCED( "ScaledDecimal" )(Catch::Benchmark::Chronometer meter) {
+        ScaledDecimal result;
+        size_t num_overflows = 0;
+        meter.measure([&](){
+            for(size_t i = 1; i < scaled.size(); i++) num_overflows += ckd_mul(&result, scaled[i-1], scaled[i]);
+            return num_overflows;
+        });
+    };
+
+    BENCHMARK_ADVANCED( "DecimalRational" )(Catch::Benchmark::Chronometer meter) {
+        DecimalRational result;
+        size_t num_overflows = 0;
+        meter.measure([&](){
+            for(size_t i = 1; i < decimals.size(); i++) num_overflows += ckd_mul(&result, decimals[i-1], decimals[i]);
+            return num_overflows;
+        });
+    };
+}
+
+TEST_CASE("Engineering literal writing") {
+    const auto literals = engineeringLiterals();
+    std::vector<ScaledDecimal> scaled(literals.size());
+    for(size_t i = 0; i < literals.size(); i++) REQUIRE_FALSE(ckd_strscientific2scaled(&scaled[i], literals[i]));
+
+    BENCHMARK_ADVANCED( "write_scaled_decimal" )(Catch::Benchmark::Chronometer meter) {
+        OutputBuilder out;
+        meter.measure([&](){
+            out.clear();
+            for(const ScaledDecimal val : scaled) write_scaled_decimal(out, val);
+            return out.size();
+        });
+    };
+}
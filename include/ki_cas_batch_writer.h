@@ -0,0 +1,60 @@
+#ifndef KI_CAS_BATCH_WRITER_H
+#define KI_CAS_BATCH_WRITER_H
+
+#include "ki_cas_big_num_wrapper.h"
+#include "ki_cas_native_rational.h"
+#include <stddef.h>
+#include <string>
+#include <string_view>
+
+namespace KiCAS2 {
+
+/// Text placed between and around each value written by a batch writer
+struct RationalBatchFormat {
+    std::string_view separator;
+    std::string_view negative;
+    std::string_view fraction_open;
+    std::string_view fraction_middle;
+    std::string_view fraction_close;
+    std::string_view integer_open;
+    std::string_view integer_close;
+    bool omit_unit_denominator;
+};
+
+/// Batch format with the markers of an output style from ki_cas_typesetting_flags.h
+template<typename Style>
+constexpr RationalBatchFormat batch_format(std::string_view separator) noexcept {
+    return {separator,
+            Style::negative,
+            Style::fraction_open, Style::fraction_middle, Style::fraction_close,
+            Style::integer_open, Style::integer_close,
+            Style::omit_unit_denominator};
+}
+
+/// Plaintext values such as `-3/2, 5`
+inline constexpr RationalBatchFormat PLAINTEXT_BATCH_FORMAT = batch_format<PlaintextStyle>(", ");
+
+/// Typeset fractions, matching the typeset output of write_native_rational and write_big_rational
+inline constexpr RationalBatchFormat TYPESET_BATCH_FORMAT = batch_format<TypesetStyle>(", ");
+
+/// Append the values to the end of the string with the separator between them.
+/// The exact size of the output is found before a single resize,
+/// then formatting is split across up to num_threads threads.
+void write_native_rationals(std::string& str,
+                            const NativeRational* vals,
+                            size_t num_vals,
+                            const RationalBatchFormat& format = PLAINTEXT_BATCH_FORMAT,
+                            size_t num_threads = 1);
+
+/// Append the values to the end of the string with the separator between them.
+/// The size of the output is bounded before a single resize,
+/// then formatting is split across up to num_threads threads.
+void write_big_rationals(std::string& str,
+                         const fmpq* vals,
+                         size_t num_vals,
+                         const RationalBatchFormat& format = PLAINTEXT_BATCH_FORMAT,
+                         size_t num_threads = 1);
+
+}  // namespace KiCAS2
+
+#endif // KI_CAS_BATCH_WRITER_H
@@ -0,0 +1,104 @@
+#ifndef KI_CAS_BIG_NUM_STORE_H
+#define KI_CAS_BIG_NUM_STORE_H
+
+#include "ki_cas_big_num_wrapper.h"
+#include <atomic>
+#include <cstdint>
+#include <limits>
+#include <memory>
+#include <mutex>
+#include <stddef.h>
+#include <vector>
+
+namespace KiCAS2 {
+
+/// Interning store of immutable canonical fmpq values, which hands out small handles so that
+/// a constant appearing many times is held once. Integers are stored with a denominator of 1.
+/// Lookups are lock-free, while insertions are serialised, so that repeated constants rarely take the lock.
+/// Entries are reference counted, and an entry whose count falls to zero stays findable until collect().
+class BigNumStore {
+public:
+    using Handle = uint32_t;
+    static constexpr Handle NO_HANDLE = std::numeric_limits<Handle>::max();
+
+    BigNumStore();
+    ~BigNumStore();
+    BigNumStore(const BigNumStore&) = delete;
+    BigNumStore& operator=(const BigNumStore&) = delete;
+
+    /// Return the handle of a canonical value, taking a reference, and copy the value in if it is new
+    Handle intern(const fmpq_t val);
+
+    /// Return the handle of an integer, taking a reference, and copy the value in if it is new
+    Handle intern(const fmpz_t val);
+
+    /// As intern, but take the limbs of a new value rather than copying them. The value is cleared.
+    Handle internClear(fmpq_t val);
+
+    /// Return the handle of a canonical value without taking a reference, or NO_HANDLE if it is absent
+    Handle find(const fmpq_t val) const noexcept;
+
+    /// The value of a handle, which is valid until its entry is collected
+    const fmpq* get(Handle handle) const noexcept;
+
+    void retain(Handle handle) noexcept;
+    void release(Handle handle) noexcept;
+    size_t refCount(Handle handle) const noexcept;
+
+    /// Intern the result of arithmetic on two stored values, taking a reference
+    Handle add(Handle a, Handle b);
+    Handle sub(Handle a, Handle b);
+    Handle mul(Handle a, Handle b);
+    Handle div(Handle a, Handle b);  /// The divisor must be nonzero
+
+    /// Free the entries whose count is zero, so that their handles may be reused.
+    /// Must not run concurrently with any other call. Returns the number of entries freed.
+    size_t collect();
+
+    /// The number of entries held, including those with a count of zero which are not yet collected
+    size_t size() const noexcept;
+
+    /// Heap bytes owned by the limbs of the held values
+    size_t heapBytes() const noexcept;
+
+private:
+    struct Entry {
+        fmpq val;
+        size_t hash;
+        std::atomic<size_t> refs;
+    };
+
+    /// Open addressed slots holding the top bits of the hash and the handle plus one, or zero if empty.
+    /// Slots are never overwritten while the table is current, so readers probe without locking.
+    struct Table {
+        explicit Table(size_t capacity);
+
+        size_t mask;
+        std::unique_ptr<std::atomic<uint64_t>[]> slots;
+    };
+
+    Entry& entry(Handle handle) const noexcept;
+    Handle findIn(const Table& table, const fmpq_t val, size_t hash) const noexcept;
+    Handle insert(fmpq_t val, size_t hash, bool take_limbs);
+    Handle newEntry();
+    void placeInTable(Table& table, Handle handle, size_t hash) noexcept;
+
+    /// Entries live in chunks which double in size and never move, so a handle stays valid as the store grows
+    static constexpr size_t FIRST_CHUNK_BITS = 6;
+    static constexpr size_t MAX_CHUNKS = std::numeric_limits<Handle>::digits - FIRST_CHUNK_BITS;
+    std::atomic<Entry*> chunks[MAX_CHUNKS];
+
+    std::atomic<Table*> table;
+    std::vector<std::unique_ptr<Table>> tables;  // The current table last, earlier tables kept for readers still probing
+    size_t num_slots_used = 0;
+
+    std::mutex insert_mutex;
+    Handle num_handles = 0;
+    std::vector<Handle> free_handles;
+    std::atomic<size_t> num_entries;
+    std::atomic<size_t> heap_bytes;
+};
+
+}  // namespace KiCAS2
+
+#endif // KI_CAS_BIG_NUM_STORE_H
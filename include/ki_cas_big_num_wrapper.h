@@ -9,7 +9,12 @@
 #include <flint/fmpq.h>
 #include <flint/fmpz.h>
 
+#include "ki_cas_decimal_rational.h"
+#include "ki_cas_output_builder.h"
+#include "ki_cas_rational_accumulator.h"
+#include "ki_cas_scaled_decimal.h"
 #include "ki_cas_typesetting_flags.h"
+#include <cstdint>
 #include <string>
 #include <string_view>
 
@@ -39,6 +44,13 @@ size_t mpz_sizeinbase10upperbound(const mpz_t val) noexcept;
 /// Return an overestimate of how many base10 digits are required to express the fmpz_t
 size_t fmpz_sizeinbase10upperbound(const fmpz_t val) noexcept;
 
+/// Return an upper bound on the chars fmpz_get_abs_str needs to write the fmpz_t, exact for small values
+size_t fmpz_abs_str_upperbound(const fmpz_t val) noexcept;
+
+/// Write the base10 magnitude of an fmpz_t, which may be followed by a null terminator.
+/// Returns the end of the written digits.
+char* fmpz_get_abs_str(char* str, const fmpz_t val) noexcept;
+
 /// Take the absolute value of an fmpq_t in place
 void fmpq_abs_inplace(fmpq_t val) noexcept;
 
@@ -54,8 +66,26 @@ void fmpz_init_set_strview(fmpz_t f, std::string_view str);
 /// Append an mpz_t to the end of the string
 void write_big_int(std::string& str, const mpz_t val);
 
-/// Append an fmpq_t to the end of the string
-template<bool typeset_fraction=false> void write_big_rational(std::string& str, const fmpq_t val);
+/// Append an mpz_t to the end of the output
+void write_big_int(OutputBuilder& out, const mpz_t val);
+
+/// Append an fmpq_t to the end of the string, formatted by one of the styles in ki_cas_typesetting_flags.h
+template<typename Style=PlaintextStyle> void write_big_rational(std::string& str, const fmpq_t val);
+
+/// Append an fmpq_t to the end of the output, formatted by one of the styles in ki_cas_typesetting_flags.h
+template<typename Style=PlaintextStyle> void write_big_rational(OutputBuilder& out, const fmpq_t val);
+
+/// Append the decimal expansion of a canonical fmpq_t to the end of the string, e.g. `-3/8` as `-0.375`.
+/// An expansion which does not terminate within max_fraction_digits is written with its repetend
+/// in parentheses if that ends within the limit, e.g. `1/6` as `0.1(6)`, and is otherwise cut off, e.g. `0.0588...`.
+void write_rational_as_decimal(std::string& str, const fmpq_t val,
+                               size_t max_fraction_digits = DEFAULT_MAX_FRACTION_DIGITS);
+
+/// Append the decimal expansion of a canonical fmpq_t to the end of the output, e.g. `-3/8` as `-0.375`.
+/// An expansion which does not terminate within max_fraction_digits is written with its repetend
+/// in parentheses if that ends within the limit, e.g. `1/6` as `0.1(6)`, and is otherwise cut off, e.g. `0.0588...`.
+void write_rational_as_decimal(OutputBuilder& out, const fmpq_t val,
+                               size_t max_fraction_digits = DEFAULT_MAX_FRACTION_DIGITS);
 
 /// Create an fmpq_t from a string of the form `(['0'-'9']+ '.' ['0'-'9']*) | ['0'-'9']* '.' ['0'-'9']+`..
 fmpq fmpq_from_decimal_str(std::string_view str);
@@ -68,6 +98,134 @@ fmpq fmpq_from_decimal_str(std::string_view str, size_t decimal_index);
 /// or `'.' ['0'-'9']+ 'e' ('+' | '-')? ['0'-'9']+`
 fmpq fmpq_from_scientific_str(std::string_view str);
 
+/// Create a canonical fmpq_t from a DecimalRational
+fmpq fmpq_from_decimal_rational(DecimalRational val);
+
+/// Set a DecimalRational from a canonical fmpq_t.
+/// Returns true if the value is negative, does not fit, or has a denominator with prime factors other than 2 and 5.
+bool ckd_fmpq2dec(DecimalRational* result, const fmpq_t val) noexcept;
+
+/// Create a canonical fmpq_t from a SignedNativeRational
+fmpq fmpq_from_signed_native_rational(SignedNativeRational val);
+
+/// Set a SignedNativeRational from an fmpq_t, keeping its sign.
+/// Returns true if the numerator or denominator does not fit.
+bool ckd_fmpq2signed(SignedNativeRational* result, const fmpq_t val) noexcept;
+
+/// Set result from a nonnegative mpz_t of at most one limb. Returns true if it is negative or does not fit.
+bool ckd_mpz2word(size_t* result, const mpz_t val) noexcept;
+
+/// Set result from a nonnegative fmpz_t, reading its limbs only if it is not inline.
+/// Returns true if it is negative or does not fit.
+bool ckd_fmpz2word(size_t* result, const fmpz_t val) noexcept;
+
+/// Set the double word (high, low) from a nonnegative mpz_t of at most two limbs.
+/// Returns true if it is negative or does not fit.
+bool ckd_mpz2wide(size_t* high, size_t* low, const mpz_t val) noexcept;
+
+/// Set the double word (high, low) from a nonnegative fmpz_t. Returns true if it is negative or does not fit.
+bool ckd_fmpz2wide(size_t* high, size_t* low, const fmpz_t val) noexcept;
+
+/// Set a NativeRational from a canonical fmpq_t. Returns true if it is negative or does not fit.
+bool ckd_fmpq2native(NativeRational* result, const fmpq_t val) noexcept;
+
+/// Set each result from a nonnegative fmpz_t, and the overflow mask to 1 for values which are negative or do not fit.
+/// Inline values are demoted by a single comparison each. Returns true if any value fails.
+bool ckd_fmpz2word(size_t* results, uint8_t* overflow, const fmpz* vals, size_t num_vals) noexcept;
+
+/// Set each result from a canonical fmpq_t, and the overflow mask to 1 for values which are negative or do not fit.
+/// Inline values are demoted by a single comparison each. Returns true if any value fails.
+bool ckd_fmpq2native(NativeRational* results, uint8_t* overflow, const fmpq* vals, size_t num_vals) noexcept;
+
+/// Create a canonical fmpq_t from a product whose result does not fit natively, cancelling its factors first
+fmpq fmpq_from_product(RationalProductAccumulator& product);
+
+/// Set result to the canonical a + b for a canonical fmpq_t, by word multiplies and gcds without converting b.
+/// The result may alias a.
+void fmpq_add_native(fmpq_t result, const fmpq_t a, NativeRational b);
+
+/// Set result to the canonical a - b for a canonical fmpq_t, by word multiplies and gcds without converting b.
+/// The result may alias a.
+void fmpq_sub_native(fmpq_t result, const fmpq_t a, NativeRational b);
+
+/// Set result to the canonical a * b for a canonical fmpq_t, cancelling word gcds before multiplying.
+/// The result may alias a.
+void fmpq_mul_native(fmpq_t result, const fmpq_t a, NativeRational b);
+
+/// Set result to the canonical a / b for a canonical fmpq_t and nonzero b. The result may alias a.
+void fmpq_div_native(fmpq_t result, const fmpq_t a, NativeRational b);
+
+/// Compare a canonical fmpq_t with a NativeRational, returning a negative, zero or positive value
+/// as a is less than, equal to or greater than b. The cross products are compared a word at a time.
+int fmpq_cmp_native(const fmpq_t a, NativeRational b) noexcept;
+
+/// How filtered comparisons were settled, to measure the hit rate of the filter
+struct FilteredCmpCounters {
+    size_t by_bit_length = 0;  /// Settled by signs or bit lengths
+    size_t by_estimate = 0;  /// Settled by floating-point estimates of the leading words
+    size_t exact = 0;  /// Needed an exact comparison
+};
+
+/// Compare canonical fmpq_t values, returning a negative, zero or positive value as a is less than, equal to or
+/// greater than b. Bit lengths and then floating-point estimates bound each value, so cross products are formed only
+/// when the bounds overlap. If counters is given, the stage which settled the comparison is counted.
+int fmpq_cmp_filtered(const fmpq_t a, const fmpq_t b, FilteredCmpCounters* counters = nullptr) noexcept;
+
+/// Compare a canonical fmpq_t with a NativeRational, falling back to fmpq_cmp_native when the bounds overlap.
+/// Values of a few words skip the filter, since fmpq_cmp_native reads each word only once.
+int fmpq_cmp_filtered(const fmpq_t a, NativeRational b, FilteredCmpCounters* counters = nullptr) noexcept;
+
+/// Compare a canonical fmpq_t with a word, falling back to fmpq_cmp_native when the bounds overlap
+int fmpq_cmp_filtered(const fmpq_t a, size_t b, FilteredCmpCounters* counters = nullptr) noexcept;
+
+/// Hash from the limbs of a canonical fmpq without formatting, equal to canonical_hash of the value as a NativeRational
+size_t canonical_hash(const fmpq_t val) noexcept;
+
+/// Heap bytes owned by an fmpz_t, which are zero for a value stored inline
+size_t fmpz_heap_bytes(const fmpz_t val) noexcept;
+
+/// Heap bytes owned by the numerator and denominator of an fmpq_t
+size_t fmpq_heap_bytes(const fmpq_t val) noexcept;
+
+/// A decimal fmpz mantissa * 10^exponent, which ScaledDecimal arithmetic promotes to on overflow.
+/// The mantissa is signed, and must be freed with bigdec_clear.
+struct BigScaledDecimal {
+    fmpz mantissa;
+    slong exponent;
+};
+
+/// Create a BigScaledDecimal from a ScaledDecimal, keeping its decimal places
+BigScaledDecimal bigdec_from_scaled(ScaledDecimal val);
+
+/// Free the mantissa of a BigScaledDecimal
+void bigdec_clear(BigScaledDecimal* val) noexcept;
+
+/// Set result to a + b, with the smaller exponent of the operands. The result may alias an operand.
+void bigdec_add(BigScaledDecimal* result, const BigScaledDecimal& a, const BigScaledDecimal& b);
+
+/// Set result to a - b, with the smaller exponent of the operands. The result may alias an operand.
+void bigdec_sub(BigScaledDecimal* result, const BigScaledDecimal& a, const BigScaledDecimal& b);
+
+/// Set result to a * b. The result may alias an operand.
+void bigdec_mul(BigScaledDecimal* result, const BigScaledDecimal& a, const BigScaledDecimal& b);
+
+/// Compare by value, returning a negative, zero or positive value as a is less than, equal to or greater than b
+int bigdec_cmp(const BigScaledDecimal& a, const BigScaledDecimal& b);
+
+/// Set a ScaledDecimal from a BigScaledDecimal with the same decimal places.
+/// Returns true if the value is negative or does not fit.
+bool ckd_bigdec2scaled(ScaledDecimal* result, const BigScaledDecimal& val) noexcept;
+
+/// Append a BigScaledDecimal to the end of the string in the notations of write_float.
+/// Fixed notation keeps the decimal places of the exponent, while the others drop trailing zeros.
+void write_big_scaled_decimal(std::string& str, const BigScaledDecimal& val,
+                              FloatNotation notation = FloatNotation::General);
+
+/// Append a BigScaledDecimal to the end of the output in the notations of write_float.
+/// Fixed notation keeps the decimal places of the exponent, while the others drop trailing zeros.
+void write_big_scaled_decimal(OutputBuilder& out, const BigScaledDecimal& val,
+                              FloatNotation notation = FloatNotation::General);
+
 #if !defined(NDEBUG) && defined(TEST_GMP_LEAKS)
 bool isAllGmpMemoryFreed() noexcept;  /// Return if all allocated GMP memory has been freed
 bool isAllGmpMemoryFreed_resetIfNot() noexcept;  /// Return if freed and reset to avoid cascading test failures
@@ -80,4 +238,12 @@ bool isAllGmpMemoryFreed_resetIfNot() noexcept;  /// Return if freed and reset t
 
 }
 
+namespace std {
+
+template<> struct hash<fmpq> {
+    size_t operator()(const fmpq& val) const noexcept { return KiCAS2::canonical_hash(&val); }
+};
+
+}  // namespace std
+
 #endif // KI_CAS_BIG_NUM_WRAPPER_H
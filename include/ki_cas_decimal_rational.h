@@ -0,0 +1,61 @@
+#ifndef KI_CAS_DECIMAL_RATIONAL_H
+#define KI_CAS_DECIMAL_RATIONAL_H
+
+#include "ki_cas_native_rational.h"
+#include <stddef.h>
+#include <stdint.h>
+#include <string_view>
+
+namespace KiCAS2 {
+
+/// A rational whose denominator 2^twos * 5^fives fits in a word, such as a parsed decimal literal.
+/// Values are canonical, so the mantissa is odd if twos > 0, not a multiple of 5 if fives > 0, and 0 is 0/1.
+/// Arithmetic aligns operands by shifts and powers of five, and reduces by trailing zeros and divisibility by 5.
+struct DecimalRational {
+    size_t mantissa;
+    uint8_t twos;
+    uint8_t fives;
+
+    DecimalRational() noexcept = default;
+
+    /// Construct from canonical fields with a denominator which fits, asserts otherwise
+    DecimalRational(size_t mantissa, uint8_t twos, uint8_t fives) noexcept;
+
+    /// The denominator 2^twos * 5^fives
+    size_t den() const noexcept;
+
+    /// Canonical conversion, which always fits
+    operator NativeRational() const noexcept;
+
+    friend bool operator==(DecimalRational a, DecimalRational b) noexcept;
+    friend bool operator!=(DecimalRational a, DecimalRational b) noexcept;
+    friend bool operator>(DecimalRational a, DecimalRational b) noexcept;
+    friend bool operator>=(DecimalRational a, DecimalRational b) noexcept;
+    friend bool operator<(DecimalRational a, DecimalRational b) noexcept;
+    friend bool operator<=(DecimalRational a, DecimalRational b) noexcept;
+};
+
+/// Returns true if the denominator 2^twos * 5^fives does not fit in a word
+bool ckd_decimal_den(size_t* result, size_t twos, size_t fives) noexcept;
+
+/// Returns true if the calculation overflows. The result is canonical.
+bool ckd_mul(DecimalRational* result, DecimalRational a, DecimalRational b) noexcept;
+
+/// Returns true if the calculation overflows. The result is canonical.
+bool ckd_add(DecimalRational* result, DecimalRational a, DecimalRational b) noexcept;
+
+/// Returns true if the calculation overflows. The result is canonical.
+/// Requires a ≥ b, asserts otherwise
+bool ckd_sub(DecimalRational* result, DecimalRational a, DecimalRational b) noexcept;
+
+/// Set a DecimalRational from a NativeRational, which need not be reduced.
+/// Returns true if the reduced denominator has prime factors other than 2 and 5.
+bool ckd_rat2dec(DecimalRational* result, NativeRational val) noexcept;
+
+/// Set a DecimalRational from a string of the form `(['0'-'9']+ ('.' ['0'-'9']*)?) | '.' ['0'-'9']+`.
+/// Returns true if the value is too large to fit.
+bool ckd_strdecimal2dec(DecimalRational* result, std::string_view str) noexcept;
+
+}  // namespace KiCAS2
+
+#endif // KI_CAS_DECIMAL_RATIONAL_H
@@ -1,14 +1,46 @@
 #ifndef KI_CAS_NATIVE_FLOAT_H
 #define KI_CAS_NATIVE_FLOAT_H
 
+#include "ki_cas_output_builder.h"
+#include <stddef.h>
 #include <string>
 
 namespace KiCAS2 {
 
 typedef long double FloatingPoint;
 
-/// Append a float to the end of the string
-void write_float(std::string& str, FloatingPoint val);
+/// Notation of a written float, following printf's %g, %f and %e conversions
+enum class FloatNotation {
+    General,
+    Fixed,
+    Scientific,
+};
+
+/// Append a float to the end of the string with the fewest digits which read back as the same value.
+/// General notation switches to scientific for decimal exponents below -4 or above 5.
+void write_float(std::string& str, FloatingPoint val, FloatNotation notation = FloatNotation::General);
+
+/// Append a float to the end of the output with the fewest digits which read back as the same value
+void write_float(OutputBuilder& out, FloatingPoint val, FloatNotation notation = FloatNotation::General);
+
+/// Append a float to the end of the string, exactly rounded to a printf precision with ties to even
+void write_float(std::string& str, FloatingPoint val, FloatNotation notation, size_t precision);
+
+/// Append a float to the end of the output, exactly rounded to a printf precision with ties to even
+void write_float(OutputBuilder& out, FloatingPoint val, FloatNotation notation, size_t precision);
+
+/// Append a double to the end of the string with the fewest digits which read back as the same double,
+/// which may be fewer than for the same value as a FloatingPoint
+void write_float(std::string& str, double val, FloatNotation notation = FloatNotation::General);
+
+/// Append a double to the end of the output with the fewest digits which read back as the same double
+void write_float(OutputBuilder& out, double val, FloatNotation notation = FloatNotation::General);
+
+/// Append a double to the end of the string, exactly rounded to a printf precision with ties to even
+void write_float(std::string& str, double val, FloatNotation notation, size_t precision);
+
+/// Append a double to the end of the output, exactly rounded to a printf precision with ties to even
+void write_float(OutputBuilder& out, double val, FloatNotation notation, size_t precision);
 
 /// Parse a string to a floating point number
 FloatingPoint strdecimal2floatingpoint(std::string_view str) noexcept;
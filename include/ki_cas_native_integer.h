@@ -1,6 +1,7 @@
 #ifndef KI_CAS_NATIVE_INTEGER_H
 #define KI_CAS_NATIVE_INTEGER_H
 
+#include "ki_cas_output_builder.h"
 #include <stdint.h>
 #include <stddef.h>
 #include <string>
@@ -19,13 +20,14 @@ size_t knownfit_mul(size_t a, size_t b) noexcept;
 /// Incudes debug assertion that the calculation does not underflow
 size_t knownfit_sub(size_t a, size_t b) noexcept;
 
-/// Returns true if no pure integer root exists
+/// Returns true if no pure integer root exists, with the floor of the root in result either way
 bool ckd_sqrt(size_t* result, size_t arg) noexcept;
 
-/// Returns true if no pure integer root exists
+/// Returns true if no pure integer root exists, with the floor of the root in result either way
 bool ckd_cbrt(size_t* result, size_t arg) noexcept;
 
-/// Returns true if no pure integer root exists
+/// Returns true if no pure integer root exists, with the floor of the root in result either way.
+/// The power must be at least 4.
 bool ckd_nrt(size_t* result, size_t arg, size_t power) noexcept;
 
 /// Returns true if the calculation overflows
@@ -34,9 +36,16 @@ bool ckd_pow(size_t* result, size_t base, size_t power) noexcept;
 /// Incudes debug assertion that the calculation does not overflow
 size_t knownfit_pow(size_t base, size_t power) noexcept;
 
+/// Returns the largest exponent for which arg is a perfect power, setting base so that base^exponent == arg.
+/// Returns 1 with base == arg if arg is not a perfect power, which includes 0 and 1.
+size_t is_perfect_power(size_t* base, size_t arg) noexcept;
+
 /// Append an integer to the end of the string
 void write_native_int(std::string& str, size_t val);
 
+/// Append an integer to the end of the output
+void write_native_int(OutputBuilder& out, size_t val);
+
 /// Set an integer from a string of the form `['0' - '9']+`. Returns true if the value is too large to fit.
 bool ckd_str2int(size_t* result, std::string_view str) noexcept;
 
@@ -1,7 +1,9 @@
 #ifndef KI_CAS_NATIVE_RATIONAL_H
 #define KI_CAS_NATIVE_RATIONAL_H
 
+#include "ki_cas_output_builder.h"
 #include "ki_cas_typesetting_flags.h"
+#include <functional>
 #include <stddef.h>
 #include <string>
 
@@ -82,11 +84,143 @@ bool ckd_sub(NativeRational* result, size_t a, NativeRational b) noexcept;
 /// reduction is performed if required to fit, but the result is NOT canonicalised
 bool ckd_sub(NativeRational* result, NativeRational a, NativeRational b) noexcept;
 
-/// Append a rational to the end of the string
-template<bool typeset_fraction=false> void write_native_rational(std::string& str, NativeRational val);
+/// Returns the largest exponent for which the numerator and denominator of arg in lowest terms are both perfect powers,
+/// setting base, in lowest terms, so that each part of base raised to the exponent gives the part of reduced arg.
+/// Returns 1 with base == reduced arg if there is no exponent above 1, which includes a numerator of 0.
+size_t is_perfect_power(NativeRational* base, NativeRational arg) noexcept;
+
+/// A NativeRational whose numerator and denominator are known to be coprime.
+/// Arithmetic on canonical operands only needs gcds across the operands, and keeps results canonical.
+class CanonicalRational {
+public:
+    CanonicalRational() noexcept = default;
+
+    /// Canonicalise an arbitrary NativeRational
+    explicit CanonicalRational(NativeRational val) noexcept;
+
+    /// Wrap a value which is already fully reduced, such as a parsed value. Asserts in debug builds.
+    static CanonicalRational fromReduced(NativeRational val) noexcept;
+
+    size_t num() const noexcept { return val.num; }
+    size_t den() const noexcept { return val.den; }
+    operator NativeRational() const noexcept { return val; }
+
+    CanonicalRational reciprocal() const noexcept;
+
+private:
+    NativeRational val;
+};
+static_assert(sizeof(CanonicalRational) == sizeof(NativeRational));
+
+/// Returns true if the calculation overflows. The result is canonical.
+bool ckd_mul(CanonicalRational* result, CanonicalRational a, size_t b) noexcept;
+
+/// Returns true if the calculation overflows. The result is canonical.
+bool ckd_mul(CanonicalRational* result, CanonicalRational a, CanonicalRational b) noexcept;
+
+/// Returns true if the calculation overflows. The result is canonical.
+bool ckd_div(CanonicalRational* result, CanonicalRational a, size_t b) noexcept;
+
+/// Returns true if the calculation overflows. The result is canonical.
+bool ckd_div(CanonicalRational* result, CanonicalRational a, CanonicalRational b) noexcept;
+
+/// Returns true if the calculation overflows. The result is canonical.
+bool ckd_add(CanonicalRational* result, CanonicalRational a, size_t b) noexcept;
+
+/// Returns true if the calculation overflows. The result is canonical.
+bool ckd_add(CanonicalRational* result, CanonicalRational a, CanonicalRational b) noexcept;
+
+/// Returns true if the calculation overflows. The result is canonical.
+/// Requires a ≥ b, asserts otherwise
+bool ckd_sub(CanonicalRational* result, CanonicalRational a, CanonicalRational b) noexcept;
+
+/// A NativeRational magnitude with a sign, so values which may go negative keep to native arithmetic.
+/// Zero is never negative, so each value has a single sign.
+class SignedNativeRational {
+public:
+    SignedNativeRational() noexcept = default;
+    explicit SignedNativeRational(NativeRational magnitude, bool is_negative = false) noexcept;
+
+    NativeRational magnitude() const noexcept { return val; }
+    bool isNegative() const noexcept { return is_negative; }
+    operator long double() const noexcept;
+    operator double() const noexcept;
+
+    friend bool operator==(SignedNativeRational a, SignedNativeRational b) noexcept;
+    friend bool operator!=(SignedNativeRational a, SignedNativeRational b) noexcept;
+    friend bool operator>(SignedNativeRational a, SignedNativeRational b) noexcept;
+    friend bool operator>=(SignedNativeRational a, SignedNativeRational b) noexcept;
+    friend bool operator<(SignedNativeRational a, SignedNativeRational b) noexcept;
+    friend bool operator<=(SignedNativeRational a, SignedNativeRational b) noexcept;
+
+    SignedNativeRational negated() const noexcept;
+    SignedNativeRational reciprocal() const noexcept;
+
+private:
+    NativeRational val;
+    bool is_negative;
+};
+
+/// Returns true if the calculation overflows
+/// reduction is performed if required to fit, but the result is NOT canonicalised
+bool ckd_mul(SignedNativeRational* result, SignedNativeRational a, SignedNativeRational b) noexcept;
+
+/// Returns true if the calculation overflows
+/// reduction is performed if required to fit, but the result is NOT canonicalised
+bool ckd_div(SignedNativeRational* result, SignedNativeRational a, SignedNativeRational b) noexcept;
+
+/// Returns true if the calculation overflows
+/// reduction is performed if required to fit, but the result is NOT canonicalised
+bool ckd_add(SignedNativeRational* result, SignedNativeRational a, SignedNativeRational b) noexcept;
+
+/// Returns true if the calculation overflows
+/// reduction is performed if required to fit, but the result is NOT canonicalised
+bool ckd_sub(SignedNativeRational* result, SignedNativeRational a, SignedNativeRational b) noexcept;
+
+/// Hash from the words of the reduced value, equal for equal values however they are represented,
+/// including unreduced NativeRationals and fmpq values from canonical_hash in ki_cas_big_num_wrapper.h
+size_t canonical_hash(NativeRational val) noexcept;
+
+/// Hash as canonical_hash for a NativeRational, without reducing
+size_t canonical_hash(CanonicalRational val) noexcept;
+
+/// Hash as canonical_hash for a NativeRational, distinguishing negative values
+size_t canonical_hash(SignedNativeRational val) noexcept;
+
+/// Append a rational to the end of the string, formatted by one of the styles in ki_cas_typesetting_flags.h
+template<typename Style=PlaintextStyle> void write_native_rational(std::string& str, NativeRational val);
+
+/// Append a rational to the end of the output, formatted by one of the styles in ki_cas_typesetting_flags.h
+template<typename Style=PlaintextStyle> void write_native_rational(OutputBuilder& out, NativeRational val);
+
+/// Append a signed rational to the end of the string, formatted by one of the styles in ki_cas_typesetting_flags.h
+template<typename Style=PlaintextStyle> void write_native_rational(std::string& str, SignedNativeRational val);
+
+/// Append a signed rational to the end of the output, formatted by one of the styles in ki_cas_typesetting_flags.h
+template<typename Style=PlaintextStyle> void write_native_rational(OutputBuilder& out, SignedNativeRational val);
+
+/// Append the decimal expansion of a rational to the end of the string, e.g. `3/8` as `0.375`.
+/// An expansion which does not terminate within max_fraction_digits is written with its repetend
+/// in parentheses if that ends within the limit, e.g. `1/6` as `0.1(6)`, and is otherwise cut off, e.g. `0.0588...`.
+void write_rational_as_decimal(std::string& str, NativeRational val,
+                               size_t max_fraction_digits = DEFAULT_MAX_FRACTION_DIGITS);
+
+/// Append the decimal expansion of a rational to the end of the output, e.g. `3/8` as `0.375`.
+/// An expansion which does not terminate within max_fraction_digits is written with its repetend
+/// in parentheses if that ends within the limit, e.g. `1/6` as `0.1(6)`, and is otherwise cut off, e.g. `0.0588...`.
+void write_rational_as_decimal(OutputBuilder& out, NativeRational val,
+                               size_t max_fraction_digits = DEFAULT_MAX_FRACTION_DIGITS);
+
+/// Append the decimal expansion of a signed rational to the end of the string, e.g. `-3/8` as `-0.375`.
+void write_rational_as_decimal(std::string& str, SignedNativeRational val,
+                               size_t max_fraction_digits = DEFAULT_MAX_FRACTION_DIGITS);
+
+/// Append the decimal expansion of a signed rational to the end of the output, e.g. `-3/8` as `-0.375`.
+void write_rational_as_decimal(OutputBuilder& out, SignedNativeRational val,
+                               size_t max_fraction_digits = DEFAULT_MAX_FRACTION_DIGITS);
 
 /// Set a NativeRational from a string of the form `'.' ['0'-'9']*`.
-/// The resulting NativeRational is fully reduced.
+/// The resulting NativeRational is fully reduced, so may be wrapped by CanonicalRational::fromReduced.
 /// Returns true if the value is too large to fit.
 bool ckd_strdecimaltail2rat(NativeRational* result, std::string_view str) noexcept;
 
@@ -109,4 +243,20 @@ bool ckd_strscientific2rat(NativeRational* result, std::string_view str) noexcep
 
 }  // namespace KiCAS2
 
+namespace std {
+
+template<> struct hash<KiCAS2::NativeRational> {
+    size_t operator()(KiCAS2::NativeRational val) const noexcept { return KiCAS2::canonical_hash(val); }
+};
+
+template<> struct hash<KiCAS2::CanonicalRational> {
+    size_t operator()(KiCAS2::CanonicalRational val) const noexcept { return KiCAS2::canonical_hash(val); }
+};
+
+template<> struct hash<KiCAS2::SignedNativeRational> {
+    size_t operator()(KiCAS2::SignedNativeRational val) const noexcept { return KiCAS2::canonical_hash(val); }
+};
+
+}  // namespace std
+
 #endif // KI_CAS_NATIVE_RATIONAL_H
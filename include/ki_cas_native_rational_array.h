@@ -0,0 +1,67 @@
+#ifndef KI_CAS_NATIVE_RATIONAL_ARRAY_H
+#define KI_CAS_NATIVE_RATIONAL_ARRAY_H
+
+#include "ki_cas_native_rational.h"
+#include <stddef.h>
+#include <stdint.h>
+#include <vector>
+
+namespace KiCAS2 {
+
+/// NativeRationals as a structure of arrays, so elementwise kernels stream numerators and denominators separately
+struct NativeRationalArray {
+    std::vector<size_t> num;
+    std::vector<size_t> den;
+
+    NativeRationalArray() noexcept = default;
+    explicit NativeRationalArray(size_t size);
+
+    size_t size() const noexcept { return num.size(); }
+    NativeRational operator[](size_t index) const noexcept { return NativeRational(num[index], den[index]); }
+    void set(size_t index, NativeRational val) noexcept;
+    void push_back(NativeRational val);
+};
+
+// The elementwise kernels run a branch-free pass which flags any lane whose wide products do not fit,
+// then a scalar pass over the flagged lanes which reduces as required to fit.
+// Results are NOT canonicalised, matching the scalar functions. The result may alias an operand.
+
+/// Set result to the elementwise a + b, and the overflow mask to 1 for lanes which overflow.
+/// Returns true if any lane overflows.
+bool ckd_add(NativeRationalArray* result, const NativeRationalArray& a, const NativeRationalArray& b,
+             std::vector<uint8_t>* overflow);
+
+/// Set result to the elementwise a - b, and the overflow mask to 1 for lanes which overflow or where a < b.
+/// Returns true if any lane overflows or is negative.
+bool ckd_sub(NativeRationalArray* result, const NativeRationalArray& a, const NativeRationalArray& b,
+             std::vector<uint8_t>* overflow);
+
+/// Set result to the elementwise a * b, and the overflow mask to 1 for lanes which overflow.
+/// Returns true if any lane overflows.
+bool ckd_mul(NativeRationalArray* result, const NativeRationalArray& a, const NativeRationalArray& b,
+             std::vector<uint8_t>* overflow);
+
+/// Set result to the elementwise a / b, and the overflow mask to 1 for lanes which overflow.
+/// Requires nonzero elements of b, asserts otherwise. Returns true if any lane overflows.
+bool ckd_div(NativeRationalArray* result, const NativeRationalArray& a, const NativeRationalArray& b,
+             std::vector<uint8_t>* overflow);
+
+/// Cancel every element to lowest terms, stepping Stein's algorithm across a block of elements at a time
+/// so that the iterations of different elements overlap. The array is split across up to num_threads threads.
+void canonicalise(NativeRationalArray* vals, size_t num_threads = 1);
+
+/// Cancel every value to lowest terms, as canonicalise for a NativeRationalArray
+void canonicalise(NativeRational* vals, size_t num_vals, size_t num_threads = 1);
+
+/// Set hashes to canonical_hash of every element, reducing a block of elements at a time as canonicalise does
+void canonical_hashes(size_t* hashes, const NativeRationalArray& vals) noexcept;
+
+/// Set hashes to canonical_hash of every value, as canonical_hashes for a NativeRationalArray
+void canonical_hashes(size_t* hashes, const NativeRational* vals, size_t num_vals) noexcept;
+
+/// Set result to -1, 0 or 1 as each element of a is less than, equal to or greater than the element of b
+void cmp(std::vector<int8_t>* result, const NativeRationalArray& a, const NativeRationalArray& b);
+
+}  // namespace KiCAS2
+
+#endif // KI_CAS_NATIVE_RATIONAL_ARRAY_H
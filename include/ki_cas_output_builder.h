@@ -0,0 +1,65 @@
+#ifndef KI_CAS_OUTPUT_BUILDER_H
+#define KI_CAS_OUTPUT_BUILDER_H
+
+#include <stddef.h>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace KiCAS2 {
+
+/// Output sink which appends to a list of fixed chunks rather than a single growing buffer,
+/// so large serialisations never copy previously written text.
+/// Chunks are kept by clear(), so a reused builder acts as an arena with no further allocation.
+class OutputBuilder {
+public:
+    static constexpr size_t DEFAULT_CHUNK_SIZE = 64 * 1024;
+
+    explicit OutputBuilder(size_t chunk_size = DEFAULT_CHUNK_SIZE);
+
+    /// Return space for at least n contiguous chars, which is valid until the next reservation.
+    /// Nothing is added to the output until the written length is passed to commit().
+    char* reserve(size_t n);
+
+    /// Add the first n chars of the last reservation to the output
+    void commit(size_t n) noexcept;
+
+    /// Append a string to the output
+    void append(std::string_view str);
+
+    /// Append a character to the output
+    void append(char ch);
+
+    /// The number of chars in the output
+    size_t size() const noexcept;
+
+    /// Discard the output, but retain the allocated chunks for reuse
+    void clear() noexcept;
+
+    /// Append the output to the end of the string
+    void appendTo(std::string& str) const;
+
+    /// Return the output as a contiguous string
+    std::string str() const;
+
+    /// Write the output to a file descriptor, using writev where available.
+    /// Returns true if the write fails.
+    bool writeTo(int fd) const;
+
+private:
+    struct Chunk {
+        std::unique_ptr<char[]> data;
+        size_t capacity;
+        size_t size;
+    };
+
+    std::vector<Chunk> chunks;
+    size_t active = 0;
+    size_t total_size = 0;
+    const size_t chunk_size;
+};
+
+}  // namespace KiCAS2
+
+#endif // KI_CAS_OUTPUT_BUILDER_H
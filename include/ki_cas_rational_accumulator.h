@@ -0,0 +1,78 @@
+#ifndef KI_CAS_RATIONAL_ACCUMULATOR_H
+#define KI_CAS_RATIONAL_ACCUMULATOR_H
+
+#include "ki_cas_native_rational.h"
+#include <stddef.h>
+#include <vector>
+
+namespace KiCAS2 {
+
+/// A running sum of NativeRationals over the lcm of their denominators with a three-word numerator.
+/// Terms are added without reducing, and the sum is reduced once when the result is taken.
+/// The numerator cannot overflow, since it is bounded by the number of terms times the square of a word.
+class RationalSumAccumulator {
+public:
+    RationalSumAccumulator() noexcept;
+
+    /// Returns true if the reduced denominator of the sum overflows, in which case the sum is unchanged.
+    /// The running sum is cancelled to lowest terms before giving up.
+    bool ckd_add(NativeRational val) noexcept;
+
+    /// Add a * b to the sum. Returns true if the product or the lcm of the denominators overflows,
+    /// in which case the sum is unchanged.
+    bool ckd_add_product(NativeRational a, NativeRational b) noexcept;
+
+    /// Set result to the canonical sum. Returns true if it does not fit.
+    bool ckd_result(NativeRational* result) const noexcept;
+
+private:
+    /// Cancel the running sum to lowest terms, returning true if the denominator changed
+    bool reduceInPlace() noexcept;
+
+    /// Add a term whose lcm with the running denominator overflows a word, cancelling the sum over the double-word lcm
+    bool ckd_add_reduced(NativeRational val) noexcept;
+
+    size_t num[3];  // Most significant word first
+    size_t den;
+};
+
+/// A running product of NativeRationals which never fails.
+/// Whenever a product does not fit after reduction, the running value is parked as numerator and denominator factors,
+/// which are cancelled pairwise only once the chain is complete.
+class RationalProductAccumulator {
+public:
+    RationalProductAccumulator() noexcept;
+
+    void mul(NativeRational factor);
+    void div(NativeRational factor);
+
+    /// Cancel each numerator factor against each denominator factor, parking the running value first.
+    /// Afterwards the factors are pairwise coprime, so their products form a canonical fraction.
+    void cancel();
+
+    /// Set result to the canonical product. Returns true if it does not fit, in which case
+    /// the factors are left cancelled for a single big construction such as fmpq_from_product.
+    bool ckd_result(NativeRational* result);
+
+    /// The part of the product not parked as factors
+    NativeRational running() const noexcept { return val; }
+    const std::vector<size_t>& numeratorFactors() const noexcept { return num_factors; }
+    const std::vector<size_t>& denominatorFactors() const noexcept { return den_factors; }
+
+private:
+    NativeRational val;
+    std::vector<size_t> num_factors;
+    std::vector<size_t> den_factors;
+};
+
+/// Set result to the canonical sum of num_vals values, reducing once at the end.
+/// Returns true if the calculation overflows.
+bool ckd_sum(NativeRational* result, const NativeRational* vals, size_t num_vals) noexcept;
+
+/// Set result to the canonical dot product of num_vals pairs of values, reducing the sum once at the end.
+/// Returns true if the calculation overflows.
+bool ckd_dot(NativeRational* result, const NativeRational* a, const NativeRational* b, size_t num_vals) noexcept;
+
+}  // namespace KiCAS2
+
+#endif // KI_CAS_RATIONAL_ACCUMULATOR_H
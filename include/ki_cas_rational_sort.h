@@ -0,0 +1,24 @@
+#ifndef KI_CAS_RATIONAL_SORT_H
+#define KI_CAS_RATIONAL_SORT_H
+
+#include "ki_cas_native_rational.h"
+#include <stddef.h>
+
+namespace KiCAS2 {
+
+/// A word which never decreases as the value increases, so that sorting by key leaves only ties to compare exactly.
+/// The top bits hold the binary exponent and the rest the truncated bits after the leading one, found exactly.
+size_t rational_sort_key(NativeRational val) noexcept;
+
+/// Sort the values in ascending order.
+/// Values are radix sorted by rational_sort_key, with exact comparisons only between values of equal key.
+/// Blocks are sorted across up to num_threads threads and then merged.
+void sort_native_rationals(NativeRational* vals, size_t num_vals, size_t num_threads = 1);
+
+/// Set indices to the permutation which sorts the values in ascending order, keeping equal values in order.
+/// Sorts as sort_native_rationals without moving the values.
+void argsort_native_rationals(size_t* indices, const NativeRational* vals, size_t num_vals, size_t num_threads = 1);
+
+}  // namespace KiCAS2
+
+#endif // KI_CAS_RATIONAL_SORT_H
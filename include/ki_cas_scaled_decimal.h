@@ -0,0 +1,61 @@
+#ifndef KI_CAS_SCALED_DECIMAL_H
+#define KI_CAS_SCALED_DECIMAL_H
+
+#include "ki_cas_native_float.h"
+#include "ki_cas_output_builder.h"
+#include <stddef.h>
+#include <stdint.h>
+#include <string>
+#include <string_view>
+
+namespace KiCAS2 {
+
+/// An exact decimal mantissa * 10^exponent, as for quantities in engineering units.
+/// Trailing zeros of the mantissa are kept, so `12.50` keeps both decimal places in fixed notation.
+struct ScaledDecimal {
+    size_t mantissa;
+    int16_t exponent;
+
+    ScaledDecimal() noexcept = default;
+    ScaledDecimal(size_t mantissa, int16_t exponent) noexcept;
+
+    /// Comparisons are by value, so `1.5` equals `1.50`
+    friend bool operator==(ScaledDecimal a, ScaledDecimal b) noexcept;
+    friend bool operator!=(ScaledDecimal a, ScaledDecimal b) noexcept;
+    friend bool operator>(ScaledDecimal a, ScaledDecimal b) noexcept;
+    friend bool operator>=(ScaledDecimal a, ScaledDecimal b) noexcept;
+    friend bool operator<(ScaledDecimal a, ScaledDecimal b) noexcept;
+    friend bool operator<=(ScaledDecimal a, ScaledDecimal b) noexcept;
+};
+
+/// Returns true if the calculation overflows
+bool ckd_mul(ScaledDecimal* result, ScaledDecimal a, ScaledDecimal b) noexcept;
+
+/// Returns true if the calculation overflows. The result has the smaller exponent of the operands.
+bool ckd_add(ScaledDecimal* result, ScaledDecimal a, ScaledDecimal b) noexcept;
+
+/// Returns true if the calculation overflows. The result has the smaller exponent of the operands.
+/// Requires a ≥ b, asserts otherwise
+bool ckd_sub(ScaledDecimal* result, ScaledDecimal a, ScaledDecimal b) noexcept;
+
+/// Append a scaled decimal to the end of the string in the notations of write_float.
+/// Fixed notation keeps the decimal places of the exponent, while the others drop trailing zeros.
+void write_scaled_decimal(std::string& str, ScaledDecimal val, FloatNotation notation = FloatNotation::General);
+
+/// Append a scaled decimal to the end of the output in the notations of write_float.
+/// Fixed notation keeps the decimal places of the exponent, while the others drop trailing zeros.
+void write_scaled_decimal(OutputBuilder& out, ScaledDecimal val, FloatNotation notation = FloatNotation::General);
+
+/// Set a ScaledDecimal from a string of the form `(['0'-'9']+ ('.' ['0'-'9']*)?) | '.' ['0'-'9']+`.
+/// Every written decimal place is kept. Returns true if the value is too large to fit.
+bool ckd_strdecimal2scaled(ScaledDecimal* result, std::string_view str) noexcept;
+
+/// Set a ScaledDecimal from a string of the form:
+/// `['0'-'9']+ ('.' ['0'-'9']*)? 'e' ('+' | '-')? ['0'-'9']+`.
+/// or `'.' ['0'-'9']+ 'e' ('+' | '-')? ['0'-'9']+`
+/// Every written decimal place is kept. Returns true if the value is too large to fit.
+bool ckd_strscientific2scaled(ScaledDecimal* result, std::string_view str) noexcept;
+
+}  // namespace KiCAS2
+
+#endif // KI_CAS_SCALED_DECIMAL_H
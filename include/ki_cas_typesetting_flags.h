@@ -1,10 +1,73 @@
 #ifndef KI_CAS_TYPESETTING_FLAGS_H
 #define KI_CAS_TYPESETTING_FLAGS_H
 
+#include <stddef.h>
+#include <string_view>
+
+namespace KiCAS2 {
+
+/// Plaintext output, e.g. `-3/2`
+struct PlaintextStyle {
+    static constexpr std::string_view negative = "-";
+    static constexpr std::string_view fraction_open = "";
+    static constexpr std::string_view fraction_middle = "/";
+    static constexpr std::string_view fraction_close = "";
+    static constexpr std::string_view integer_open = "";
+    static constexpr std::string_view integer_close = "";
+    static constexpr bool omit_unit_denominator = true;  /// Write canonical integers without a fraction
+};
+
+/// KiCAS typeset output, e.g. `-⁜f⏴3⏵⏴2⏵`
+struct TypesetStyle {
+    static constexpr std::string_view negative = "-";
+    static constexpr std::string_view fraction_open = "⁜f⏴";
+    static constexpr std::string_view fraction_middle = "⏵⏴";
+    static constexpr std::string_view fraction_close = "⏵";
+    static constexpr std::string_view integer_open = "";
+    static constexpr std::string_view integer_close = "";
+    static constexpr bool omit_unit_denominator = false;
+};
+
+/// LaTeX output, e.g. `-\frac{3}{2}`
+struct LatexStyle {
+    static constexpr std::string_view negative = "-";
+    static constexpr std::string_view fraction_open = "\\frac{";
+    static constexpr std::string_view fraction_middle = "}{";
+    static constexpr std::string_view fraction_close = "}";
+    static constexpr std::string_view integer_open = "";
+    static constexpr std::string_view integer_close = "";
+    static constexpr bool omit_unit_denominator = true;
+};
+
+/// Presentation MathML output, e.g. `<mo>-</mo><mfrac><mn>3</mn><mn>2</mn></mfrac>`
+struct MathMLStyle {
+    static constexpr std::string_view negative = "<mo>-</mo>";
+    static constexpr std::string_view fraction_open = "<mfrac><mn>";
+    static constexpr std::string_view fraction_middle = "</mn><mn>";
+    static constexpr std::string_view fraction_close = "</mn></mfrac>";
+    static constexpr std::string_view integer_open = "<mn>";
+    static constexpr std::string_view integer_close = "</mn>";
+    static constexpr bool omit_unit_denominator = true;
+};
+
+/// Total length of the markers written around a fraction
+template<typename Style>
+inline constexpr size_t FRACTION_MARKERS_SIZE =
+    Style::fraction_open.size() + Style::fraction_middle.size() + Style::fraction_close.size();
+
+/// Total length of the markers written around an integer
+template<typename Style>
+inline constexpr size_t INTEGER_MARKERS_SIZE = Style::integer_open.size() + Style::integer_close.size();
+
+/// Fraction digits written by write_rational_as_decimal before a decimal expansion is cut off
+inline constexpr size_t DEFAULT_MAX_FRACTION_DIGITS = 32;
+
+}  // namespace KiCAS2
+
 /// Flag indicating text output should be plaintext
-inline constexpr bool PLAINTEXT_OUTPUT = false;
+typedef KiCAS2::PlaintextStyle PLAINTEXT_OUTPUT;
 
 /// Flag indicating text output should be typeset
-inline constexpr bool TYPESET_OUTPUT = true;
+typedef KiCAS2::TypesetStyle TYPESET_OUTPUT;
 
 #endif // KI_CAS_TYPESETTING_FLAGS_H
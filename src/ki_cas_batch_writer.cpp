@@ -0,0 +1,135 @@
+#include "ki_cas_batch_writer.h"
+
+#include "ki_cas_digit_writing.h"
+#include "ki_cas_parallel.h"
+#include <algorithm>
+#include <cassert>
+#include <cstring>
+#include <vector>
+
+namespace KiCAS2 {
+
+static char* write_native_rational(char* dest, NativeRational val, const RationalBatchFormat& format) noexcept {
+    if(format.omit_unit_denominator && val.den == 1){
+        dest = write_marker(dest, format.integer_open);
+        dest = write_base10_digits(dest, val.num, count_base10_digits(val.num));
+        return write_marker(dest, format.integer_close);
+    }
+
+    dest = write_marker(dest, format.fraction_open);
+    dest = write_base10_digits(dest, val.num, count_base10_digits(val.num));
+    dest = write_marker(dest, format.fraction_middle);
+    dest = write_base10_digits(dest, val.den, count_base10_digits(val.den));
+    return write_marker(dest, format.fraction_close);
+}
+
+void write_native_rationals(std::string& str,
+                            const NativeRational* vals,
+                            size_t num_vals,
+                            const RationalBatchFormat& format,
+                            size_t num_threads) {
+    if(num_vals == 0) return;
+
+    const size_t fraction_markers_size =
+        format.fraction_open.size() + format.fraction_middle.size() + format.fraction_close.size();
+    const size_t integer_markers_size = format.integer_open.size() + format.integer_close.size();
+
+    // Find the exact size of each value, with the separator which precedes it
+    std::vector<size_t> offsets(num_vals + 1);
+    parallel_for(num_vals, num_threads, [&](size_t begin, size_t end){
+        for(size_t i = begin; i < end; i++){
+            const NativeRational val = vals[i];
+            const size_t den_size = fraction_markers_size + count_base10_digits(val.den);
+            const bool omit_den = format.omit_unit_denominator & (val.den == 1);
+            offsets[i+1] = format.separator.size() + count_base10_digits(val.num)
+                           + (omit_den ? integer_markers_size : den_size);
+        }
+    });
+    offsets[0] = str.size();
+    offsets[1] -= format.separator.size();
+    for(size_t i = 1; i <= num_vals; i++) offsets[i] += offsets[i-1];
+
+    str.resize(offsets[num_vals]);
+    char* const data = str.data();
+
+    // Each value is formatted into its own disjoint slice
+    parallel_for(num_vals, num_threads, [&](size_t begin, size_t end){
+        for(size_t i = begin; i < end; i++){
+            char* dest = data + offsets[i];
+            if(i != 0) dest = write_marker(dest, format.separator);
+            dest = write_native_rational(dest, vals[i], format);
+            assert(dest == data + offsets[i+1]);
+        }
+    });
+}
+
+static char* write_big_rational(char* dest, const fmpq_t val, const RationalBatchFormat& format) noexcept {
+    const fmpz* num = fmpq_numref(val);
+    const fmpz* den = fmpq_denref(val);
+
+    if(fmpz_sgn(num) == -1) dest = write_marker(dest, format.negative);
+    if(format.omit_unit_denominator && fmpz_is_one(den)){
+        dest = write_marker(dest, format.integer_open);
+        dest = fmpz_get_abs_str(dest, num);
+        return write_marker(dest, format.integer_close);
+    }
+
+    dest = write_marker(dest, format.fraction_open);
+    dest = fmpz_get_abs_str(dest, num);
+    dest = write_marker(dest, format.fraction_middle);
+    dest = fmpz_get_abs_str(dest, den);
+    return write_marker(dest, format.fraction_close);
+}
+
+void write_big_rationals(std::string& str,
+                         const fmpq* vals,
+                         size_t num_vals,
+                         const RationalBatchFormat& format,
+                         size_t num_threads) {
+    if(num_vals == 0) return;
+
+    const size_t fraction_markers_size =
+        format.fraction_open.size() + format.fraction_middle.size() + format.fraction_close.size();
+    const size_t integer_markers_size = format.integer_open.size() + format.integer_close.size();
+
+    // Bound the size of each value, with the separator which precedes it
+    std::vector<size_t> offsets(num_vals + 1);
+    parallel_for(num_vals, num_threads, [&](size_t begin, size_t end){
+        for(size_t i = begin; i < end; i++){
+            const fmpz* num = fmpq_numref(vals + i);
+            const fmpz* den = fmpq_denref(vals + i);
+            const bool omit_den = format.omit_unit_denominator && fmpz_is_one(den);
+            offsets[i+1] = format.separator.size() + format.negative.size() * (fmpz_sgn(num) == -1)
+                           + fmpz_abs_str_upperbound(num)
+                           + (omit_den ? integer_markers_size : fraction_markers_size + fmpz_abs_str_upperbound(den));
+        }
+    });
+    offsets[0] = str.size();
+    offsets[1] -= format.separator.size();
+    for(size_t i = 1; i <= num_vals; i++) offsets[i] += offsets[i-1];
+
+    str.resize(offsets[num_vals]);
+    char* const data = str.data();
+
+    // Each value is formatted into its own disjoint slice, recording where it ends
+    std::vector<char*> ends(num_vals);
+    parallel_for(num_vals, num_threads, [&](size_t begin, size_t end){
+        for(size_t i = begin; i < end; i++){
+            char* dest = data + offsets[i];
+            if(i != 0) dest = write_marker(dest, format.separator);
+            ends[i] = write_big_rational(dest, vals + i, format);
+            assert(ends[i] <= data + offsets[i+1]);
+        }
+    });
+
+    // Close any gaps left by overestimated sizes
+    char* dest = data + offsets[0];
+    for(size_t i = 0; i < num_vals; i++){
+        const size_t size = ends[i] - (data + offsets[i]);
+        if(dest != data + offsets[i]) memmove(dest, data + offsets[i], size);
+        dest += size;
+    }
+    str.resize(dest - data);
+}
+
+}  // namespace KiCAS2
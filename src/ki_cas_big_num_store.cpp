@@ -0,0 +1,252 @@
+#include "ki_cas_big_num_store.h"
+
+#include "ki_cas_wide_integer.h"
+#include <cassert>
+
+namespace KiCAS2 {
+
+static constexpr size_t WORD_BITS = std::numeric_limits<size_t>::digits;
+static constexpr size_t INITIAL_TABLE_CAPACITY = 64;
+
+/// The top 32 bits of the hash, kept in the slot so that most mismatches are rejected without reading the entry
+static uint64_t slot_tag(size_t hash) noexcept {
+    return static_cast<uint64_t>(hash >> (WORD_BITS - 32)) << 32;
+}
+
+BigNumStore::Table::Table(size_t capacity)
+    : mask(capacity - 1), slots(new std::atomic<uint64_t>[capacity]) {
+    assert((capacity & mask) == 0);
+    for(size_t i = 0; i < capacity; i++) slots[i].store(0, std::memory_order_relaxed);
+}
+
+BigNumStore::BigNumStore() : num_entries(0), heap_bytes(0) {
+    for(std::atomic<Entry*>& chunk : chunks) chunk.store(nullptr, std::memory_order_relaxed);
+    tables.emplace_back(new Table(INITIAL_TABLE_CAPACITY));
+    table.store(tables.back().get(), std::memory_order_release);
+}
+
+BigNumStore::~BigNumStore() {
+    for(size_t c = 0; c < MAX_CHUNKS; c++){
+        Entry* chunk = chunks[c].load(std::memory_order_relaxed);
+        if(chunk == nullptr) break;
+        for(size_t i = 0; i < (size_t(1) << (FIRST_CHUNK_BITS + c)); i++) fmpq_clear(&chunk[i].val);
+        delete[] chunk;
+    }
+}
+
+BigNumStore::Entry& BigNumStore::entry(Handle handle) const noexcept {
+    // Chunk c holds the handles from 2^(FIRST_CHUNK_BITS+c) - 2^FIRST_CHUNK_BITS onwards
+    const size_t shifted = static_cast<size_t>(handle) + (size_t(1) << FIRST_CHUNK_BITS);
+    const size_t chunk_bits = WORD_BITS - 1 - count_leading_zeros(shifted);
+    const size_t c = chunk_bits - FIRST_CHUNK_BITS;
+    assert(c < MAX_CHUNKS);
+    return chunks[c].load(std::memory_order_acquire)[shifted - (size_t(1) << chunk_bits)];
+}
+
+BigNumStore::Handle BigNumStore::findIn(const Table& table, const fmpq_t val, size_t hash) const noexcept {
+    const uint64_t tag = slot_tag(hash);
+    for(size_t i = hash & table.mask;; i = (i + 1) & table.mask){
+        const uint64_t slot = table.slots[i].load(std::memory_order_acquire);
+        if(slot == 0) return NO_HANDLE;
+        if((slot & ~uint64_t(0xFFFFFFFF)) != tag) continue;
+
+        const Handle handle = static_cast<Handle>(slot) - 1;
+        if(fmpq_equal(&entry(handle).val, val)) return handle;
+    }
+}
+
+BigNumStore::Handle BigNumStore::find(const fmpq_t val) const noexcept {
+    assert(fmpq_is_canonical(val));
+    return findIn(*table.load(std::memory_order_acquire), val, canonical_hash(val));
+}
+
+BigNumStore::Handle BigNumStore::intern(const fmpq_t val) {
+    assert(fmpq_is_canonical(val));
+    const size_t hash = canonical_hash(val);
+    const Handle handle = findIn(*table.load(std::memory_order_acquire), val, hash);
+    if(handle != NO_HANDLE){
+        retain(handle);
+        return handle;
+    }
+
+    return insert(const_cast<fmpq*>(val), hash, false);
+}
+
+BigNumStore::Handle BigNumStore::intern(const fmpz_t val) {
+    fmpq_t integer;
+    fmpq_init(integer);
+    fmpz_set(fmpq_numref(integer), val);
+    return internClear(integer);
+}
+
+BigNumStore::Handle BigNumStore::internClear(fmpq_t val) {
+    assert(fmpq_is_canonical(val));
+    const size_t hash = canonical_hash(val);
+    const Handle handle = findIn(*table.load(std::memory_order_acquire), val, hash);
+    if(handle != NO_HANDLE){
+        retain(handle);
+        fmpq_clear(val);
+        return handle;
+    }
+
+    return insert(val, hash, true);
+}
+
+BigNumStore::Handle BigNumStore::insert(fmpq_t val, size_t hash, bool take_limbs) {
+    std::lock_guard<std::mutex> lock(insert_mutex);
+
+    // Another thread may have inserted the value since the lock-free lookup
+    Handle handle = findIn(*tables.back(), val, hash);
+    if(handle != NO_HANDLE){
+        retain(handle);
+        if(take_limbs) fmpq_clear(val);
+        return handle;
+    }
+
+    handle = newEntry();
+    Entry& e = entry(handle);
+    if(take_limbs){
+        fmpq_swap(&e.val, val);
+        fmpq_clear(val);
+    }else{
+        fmpq_set(&e.val, val);
+    }
+    e.hash = hash;
+    e.refs.store(1, std::memory_order_relaxed);
+    num_entries.fetch_add(1, std::memory_order_relaxed);
+    heap_bytes.fetch_add(fmpq_heap_bytes(&e.val), std::memory_order_relaxed);
+
+    // Grow at half full, publishing the new table only once it holds every entry
+    if(2*(num_slots_used + 1) > tables.back()->mask + 1){
+        std::unique_ptr<Table> grown(new Table(2*(tables.back()->mask + 1)));
+        const Table& old = *tables.back();
+        for(size_t i = 0; i <= old.mask; i++){
+            const uint64_t slot = old.slots[i].load(std::memory_order_relaxed);
+            if(slot != 0) placeInTable(*grown, static_cast<Handle>(slot) - 1, entry(static_cast<Handle>(slot) - 1).hash);
+        }
+        tables.push_back(std::move(grown));
+        table.store(tables.back().get(), std::memory_order_release);
+    }
+
+    placeInTable(*tables.back(), handle, hash);
+    num_slots_used++;
+
+    return handle;
+}
+
+BigNumStore::Handle BigNumStore::newEntry() {
+    if(!free_handles.empty()){
+        const Handle handle = free_handles.back();
+        free_handles.pop_back();
+        return handle;
+    }
+
+    const Handle handle = num_handles++;
+    const size_t shifted = static_cast<size_t>(handle) + (size_t(1) << FIRST_CHUNK_BITS);
+    if((shifted & (shifted - 1)) == 0){  // First handle of a new chunk
+        const size_t c = WORD_BITS - 1 - count_leading_zeros(shifted) - FIRST_CHUNK_BITS;
+        assert(c < MAX_CHUNKS);
+        const size_t chunk_size = size_t(1) << (FIRST_CHUNK_BITS + c);
+        Entry* chunk = new Entry[chunk_size];
+        for(size_t i = 0; i < chunk_size; i++) fmpq_init(&chunk[i].val);
+        chunks[c].store(chunk, std::memory_order_release);
+    }
+
+    return handle;
+}
+
+void BigNumStore::placeInTable(Table& table, Handle handle, size_t hash) noexcept {
+    size_t i = hash & table.mask;
+    while(table.slots[i].load(std::memory_order_relaxed) != 0) i = (i + 1) & table.mask;
+    table.slots[i].store(slot_tag(hash) | (static_cast<uint64_t>(handle) + 1), std::memory_order_release);
+}
+
+const fmpq* BigNumStore::get(Handle handle) const noexcept {
+    return &entry(handle).val;
+}
+
+void BigNumStore::retain(Handle handle) noexcept {
+    entry(handle).refs.fetch_add(1, std::memory_order_relaxed);
+}
+
+void BigNumStore::release(Handle handle) noexcept {
+    const size_t prev = entry(handle).refs.fetch_sub(1, std::memory_order_relaxed);
+    assert(prev != 0);
+    (void)prev;
+}
+
+size_t BigNumStore::refCount(Handle handle) const noexcept {
+    return entry(handle).refs.load(std::memory_order_relaxed);
+}
+
+BigNumStore::Handle BigNumStore::add(Handle a, Handle b) {
+    fmpq_t result;
+    fmpq_init(result);
+    fmpq_add(result, get(a), get(b));
+    return internClear(result);
+}
+
+BigNumStore::Handle BigNumStore::sub(Handle a, Handle b) {
+    fmpq_t result;
+    fmpq_init(result);
+    fmpq_sub(result, get(a), get(b));
+    return internClear(result);
+}
+
+BigNumStore::Handle BigNumStore::mul(Handle a, Handle b) {
+    fmpq_t result;
+    fmpq_init(result);
+    fmpq_mul(result, get(a), get(b));
+    return internClear(result);
+}
+
+BigNumStore::Handle BigNumStore::div(Handle a, Handle b) {
+    assert(!fmpq_is_zero(get(b)));
+    fmpq_t result;
+    fmpq_init(result);
+    fmpq_div(result, get(a), get(b));
+    return internClear(result);
+}
+
+size_t BigNumStore::collect() {
+    std::lock_guard<std::mutex> lock(insert_mutex);
+
+    // Rebuild the table from the surviving entries, since open addressing cannot drop slots in place
+    const Table& old = *tables.back();
+    std::unique_ptr<Table> rebuilt(new Table(old.mask + 1));
+    size_t num_freed = 0;
+    for(size_t i = 0; i <= old.mask; i++){
+        const uint64_t slot = old.slots[i].load(std::memory_order_relaxed);
+        if(slot == 0) continue;
+
+        const Handle handle = static_cast<Handle>(slot) - 1;
+        Entry& e = entry(handle);
+        if(e.refs.load(std::memory_order_relaxed) != 0){
+            placeInTable(*rebuilt, handle, e.hash);
+        }else{
+            heap_bytes.fetch_sub(fmpq_heap_bytes(&e.val), std::memory_order_relaxed);
+            fmpq_clear(&e.val);
+            fmpq_init(&e.val);
+            free_handles.push_back(handle);
+            num_freed++;
+        }
+    }
+
+    tables.clear();
+    tables.push_back(std::move(rebuilt));
+    table.store(tables.back().get(), std::memory_order_release);
+    num_slots_used -= num_freed;
+    num_entries.fetch_sub(num_freed, std::memory_order_relaxed);
+
+    return num_freed;
+}
+
+size_t BigNumStore::size() const noexcept {
+    return num_entries.load(std::memory_order_relaxed);
+}
+
+size_t BigNumStore::heapBytes() const noexcept {
+    return heap_bytes.load(std::memory_order_relaxed);
+}
+
+}  // namespace KiCAS2
@@ -1,9 +1,15 @@
 #include "ki_cas_big_num_wrapper.h"
 
+#include <algorithm>
 #include <cassert>
+#include "ki_cas_canonical_hash.h"
+#include "ki_cas_digit_writing.h"
 #include "ki_cas_native_integer.h"
 #include "ki_cas_native_rational.h"
+#include "ki_cas_wide_integer.h"
+#include <cstring>
 #include <limits>
+#include <vector>
 
 #ifndef NDEBUG
 #include <iostream>
@@ -23,35 +29,7 @@ void mpz_neg_inplace(mpz_t rop) noexcept {
 }
 
 void fmpz_10_pow_ui(fmpz_t f, ulong rhs) {
-    constexpr size_t powers_of_ten[] = {
-        1,
-        10,
-        100,
-        1000,
-        10000,
-        100000,
-        1000000,
-        10000000,
-        100000000,
-        1000000000uLL,
-#if defined(__x86_64__) || defined(__aarch64__) || defined( _WIN64 )  // 64-bit
-        10000000000,
-        100000000000,
-        1000000000000,
-        10000000000000,
-        100000000000000,
-        1000000000000000,
-        10000000000000000,
-        100000000000000000,
-        1000000000000000000,
-        10000000000000000000uLL,
-#endif
-    };
-
-    // Check this rather than specify it to make sure the macro worked
-    static_assert(sizeof(powers_of_ten)/sizeof(size_t) == std::numeric_limits<size_t>::digits10+1);
-
-    if(rhs <= std::numeric_limits<size_t>::digits10){
+    if(rhs < NUM_POWERS_OF_TEN){
         fmpz_init_set_ui(f, powers_of_ten[rhs]);
     }else{
         fmpz_init(f);
@@ -66,16 +44,17 @@ void fmpz_10_pow_fmpz(fmpz_t f, const fmpz_t rhs) {
 
 size_t mpz_sizeinbase10upperbound(const mpz_t val) noexcept {
     // return mpz_sizeinbase(val, 10);  // Avoid computation, make a quick upper bound
-    return mpz_size(val) * std::numeric_limits<mp_limb_t>::digits10;
+    return mpz_size(val) * (std::numeric_limits<mp_limb_t>::digits10 + 1);
 }
 
 size_t fmpz_sizeinbase10upperbound(const fmpz_t val) noexcept {
     // return fmpz_sizeinbase(val, 10);  // Avoid computation, make a quick upper bound
-    return fmpz_size(val) * std::numeric_limits<mp_limb_t>::digits10;
+    return fmpz_size(val) * (std::numeric_limits<mp_limb_t>::digits10 + 1);
 }
 
 void fmpq_abs_inplace(fmpq_t val) noexcept {
-    val->num = std::abs(val->num);
+    // The magnitude of a big numerator is flipped in place, since its coefficient is a tagged pointer
+    fmpz_abs(fmpq_numref(val), fmpq_numref(val));
 }
 
 void mpz_init_set_strview(mpz_t f, std::string_view str) {
@@ -153,57 +132,228 @@ void write_big_int(std::string& str, const mpz_t val) {
     str.resize(null_terminator_index);
 }
 
-static void write_big_int(std::string& str, const fmpz_t val, bool is_negative) {
-    // Resize str to ensure sufficient capacity for the largest possible number
-    static constexpr size_t base = 10;
-    static constexpr size_t PLUS_ONE_FOR_SIGN = 1;
+size_t fmpz_abs_str_upperbound(const fmpz_t val) noexcept {
+    // Small values are sized exactly, while mpz_sizeinbase may exceed the exact size by one.
+    // mpz_get_str also writes a null terminator.
     static constexpr size_t PLUS_ONE_FOR_NULL_TERMINATOR = 1;
 
-    const size_t max_digits = fmpz_sizeinbase(val, base) + (PLUS_ONE_FOR_SIGN + PLUS_ONE_FOR_NULL_TERMINATOR);
+    if(!COEFF_IS_MPZ(*val)) return count_base10_digits(static_cast<size_t>(std::abs(*val)));
+    return mpz_sizeinbase(COEFF_TO_PTR(*val), 10) + PLUS_ONE_FOR_NULL_TERMINATOR;
+}
+
+char* fmpz_get_abs_str(char* str, const fmpz_t val) noexcept {
+    if(!COEFF_IS_MPZ(*val)){
+        const size_t abs_val = static_cast<size_t>(std::abs(*val));
+        return write_base10_digits(str, abs_val, count_base10_digits(abs_val));
+    }
+
+    // Shallow copy with a positive size to print the magnitude without allocating
+    __mpz_struct abs_val = *COEFF_TO_PTR(*val);
+    abs_val._mp_size = std::abs(abs_val._mp_size);
+    mpz_get_str(str, 10, &abs_val);
+    return str + strlen(str);
+}
+
+template<typename Style>
+static size_t write_big_rational_upperbound(const fmpz_t num, const fmpz_t den) noexcept {
+    const size_t num_size = Style::negative.size() + fmpz_abs_str_upperbound(num);
+    if(Style::omit_unit_denominator && fmpz_is_one(den)) return num_size + INTEGER_MARKERS_SIZE<Style>;
+    return num_size + fmpz_abs_str_upperbound(den) + FRACTION_MARKERS_SIZE<Style>;
+}
+
+template<typename Style>
+static char* write_big_rational(char* dest, const fmpz_t num, const fmpz_t den) noexcept {
+    if(fmpz_sgn(num) == -1) dest = write_marker(dest, Style::negative);
+
+    if(Style::omit_unit_denominator && fmpz_is_one(den)){
+        dest = write_marker(dest, Style::integer_open);
+        dest = fmpz_get_abs_str(dest, num);
+        return write_marker(dest, Style::integer_close);
+    }
+
+    dest = write_marker(dest, Style::fraction_open);
+    dest = fmpz_get_abs_str(dest, num);
+    dest = write_marker(dest, Style::fraction_middle);
+    dest = fmpz_get_abs_str(dest, den);
+    return write_marker(dest, Style::fraction_close);
+}
+
+template<typename Style> void write_big_rational(std::string& str, const fmpq_t val) {
+    const fmpz* num = fmpq_numref(val);
+    const fmpz* den = fmpq_denref(val);
+
+    // Resize once for the largest possible output, then trim where the bound exceeded the need
     const size_t start_index = str.size();
-    str.resize(str.size() + max_digits);
+    str.resize(start_index + write_big_rational_upperbound<Style>(num, den));
+    const char* end = write_big_rational<Style>(str.data() + start_index, num, den);
+    str.resize(end - str.data());
+}
+template void write_big_rational<PlaintextStyle>(std::string&, const fmpq_t);
+template void write_big_rational<TypesetStyle>(std::string&, const fmpq_t);
+template void write_big_rational<LatexStyle>(std::string&, const fmpq_t);
+template void write_big_rational<MathMLStyle>(std::string&, const fmpq_t);
 
-    // Append the number to the end of str, overwriting any sign character
-    const char backup = str[start_index-1];
-    fmpz_get_str(str.data() + start_index - is_negative, base, val);
-    str[start_index-1] = backup;
+void write_big_int(OutputBuilder& out, const mpz_t val) {
+    // Reserve sufficient capacity for the largest possible number
+    static constexpr size_t base = 10;
+    static constexpr size_t PLUS_ONE_FOR_SIGN = 1;
+    static constexpr size_t PLUS_ONE_FOR_NULL_TERMINATOR = 1;
 
-    // Resize where prior allocation exceeded the actual need
-    const size_t null_terminator_index = str.find('\0', start_index);
-    str.resize(null_terminator_index);
+    const size_t max_digits = mpz_sizeinbase10upperbound(val) + (PLUS_ONE_FOR_SIGN + PLUS_ONE_FOR_NULL_TERMINATOR);
+    char* buffer = out.reserve(max_digits);
+
+    mpz_get_str(buffer, base, val);
+    out.commit(strlen(buffer));
 }
 
-template<bool typeset_fraction> void write_big_rational(std::string& str, const fmpq_t val) {
+template<typename Style> void write_big_rational(OutputBuilder& out, const fmpq_t val) {
     const fmpz* num = fmpq_numref(val);
     const fmpz* den = fmpq_denref(val);
 
-    if(typeset_fraction){
-        const bool is_negative = (fmpz_sgn(num) == -1);
-        if(is_negative) str += '-';
-        str += "⁜f⏴";
-        write_big_int(str, num, is_negative);
-        str += "⏵⏴";
-        write_big_int(str, den, false);
-        str += "⏵";
-    }else{
-        static constexpr size_t base = 10;
-        static constexpr size_t PLUS_ONE_FOR_SIGN = 1;
-        static constexpr size_t PLUS_ONE_FOR_NULL_TERMINATOR = 1;
-        static constexpr size_t PLUS_ONE_FOR_DIVISION = 1;
-        const size_t max_digits = fmpz_sizeinbase10upperbound(num) + fmpz_sizeinbase10upperbound(den)
-                                  + (PLUS_ONE_FOR_SIGN + PLUS_ONE_FOR_NULL_TERMINATOR + PLUS_ONE_FOR_DIVISION);
-        const size_t start_index = str.size();
-        str.resize(str.size() + max_digits);
-
-        _fmpq_get_str(str.data() + start_index, base, num, den);
-
-        // Resize where prior allocation exceeded the actual need
-        const size_t null_terminator_index = str.find('\0', start_index);
-        str.resize(null_terminator_index);
+    char* buffer = out.reserve(write_big_rational_upperbound<Style>(num, den));
+    const char* end = write_big_rational<Style>(buffer, num, den);
+    out.commit(end - buffer);
+}
+template void write_big_rational<PlaintextStyle>(OutputBuilder&, const fmpq_t);
+template void write_big_rational<TypesetStyle>(OutputBuilder&, const fmpq_t);
+template void write_big_rational<LatexStyle>(OutputBuilder&, const fmpq_t);
+template void write_big_rational<MathMLStyle>(OutputBuilder&, const fmpq_t);
+
+/// Digits per block of the long division, chosen so that each quotient fits a ulong
+static constexpr size_t DECIMAL_BLOCK_DIGITS = std::numeric_limits<ulong>::digits10;
+
+static constexpr ulong decimal_block_power() noexcept {
+    ulong power = 1;
+    for(size_t i = 0; i < DECIMAL_BLOCK_DIGITS; i++) power *= 10;
+    return power;
+}
+
+static size_t rational_as_decimal_upperbound(const fmpz_t integer_part, size_t max_fraction_digits) noexcept {
+    static constexpr size_t PLUS_ONE_FOR_SIGN = 1;
+    static constexpr size_t PLUS_ONE_FOR_DECIMAL_POINT = 1;
+    static constexpr size_t PLUS_ONE_FOR_NULL_TERMINATOR = 1;
+    return PLUS_ONE_FOR_SIGN + fmpz_abs_str_upperbound(integer_part) + PLUS_ONE_FOR_DECIMAL_POINT
+           + max_fraction_digits + DECIMAL_CUTOFF_MARKER.size() + PLUS_ONE_FOR_NULL_TERMINATOR;
+}
+
+/// Write the fraction digits of rem/den for a remainder 0 < rem < den, consuming the remainder
+static char* write_fraction_digits(char* dest, fmpz_t rem, const fmpz_t den, size_t max_fraction_digits) {
+    static constexpr fmpz_t FMPZ_FIVE = {5};
+
+    // Digits before any repetend are given by the valuations of the denominator in 2 and 5
+    fmpz_t cofactor;
+    fmpz_init(cofactor);
+    const size_t twos = fmpz_val2(den);
+    fmpz_tdiv_q_2exp(cofactor, den, twos);
+    const size_t fives = static_cast<size_t>(fmpz_remove(cofactor, cofactor, FMPZ_FIVE));
+    const size_t preperiod = std::max(twos, fives);
+    const bool terminates = fmpz_is_one(cofactor);
+
+    if(terminates && preperiod <= max_fraction_digits){
+        // The remainder scaled to an integer over 10^preperiod, written with its leading zeros
+        fmpz_mul_2exp(rem, rem, preperiod - twos);
+        fmpz_pow_ui(cofactor, FMPZ_FIVE, preperiod - fives);
+        fmpz_mul(rem, rem, cofactor);
+        fmpz_clear(cofactor);
+
+        const size_t num_digits = fmpz_get_abs_str(dest, rem) - dest;
+        assert(num_digits <= preperiod);
+        memmove(dest + (preperiod - num_digits), dest, num_digits);
+        memset(dest, '0', preperiod - num_digits);
+        return dest + preperiod;
     }
+    fmpz_clear(cofactor);
+
+    // Two remainders below den whose expansions agree to as many digits as den has are equal,
+    // so digits of the periodic part which repeat for that long confirm the end of the repetend.
+    // Borders of the periodic digits are tracked as they are generated to find the first such repeat.
+    const size_t confirm_digits = fmpz_sizeinbase(den, 10);
+    const size_t num_digits_needed =
+        (terminates || preperiod >= max_fraction_digits) ? max_fraction_digits : max_fraction_digits + confirm_digits;
+    std::string digits;
+    std::vector<size_t> borders;
+    size_t period = 0;
+
+    fmpz_t block;
+    fmpz_init(block);
+    while(period == 0 && digits.size() < num_digits_needed && !fmpz_is_zero(rem)){
+        fmpz_mul_ui(rem, rem, decimal_block_power());
+        fmpz_fdiv_qr(block, rem, rem, den);
+        const size_t block_start = digits.size();
+        digits.resize(block_start + DECIMAL_BLOCK_DIGITS);
+        write_zero_padded_digits(digits.data() + block_start, fmpz_get_ui(block), DECIMAL_BLOCK_DIGITS);
+
+        for(size_t i = std::max(block_start, preperiod); i < digits.size(); i++){
+            const char* periodic = digits.data() + preperiod;
+            const size_t j = i - preperiod;
+            size_t border = (j == 0) ? 0 : borders[j-1];
+            while(border != 0 && periodic[border] != periodic[j]) border = borders[border-1];
+            if(j != 0 && periodic[border] == periodic[j]) border++;
+            borders.push_back(border);
+
+            if(border >= confirm_digits){
+                period = j + 1 - border;
+                break;
+            }
+        }
+    }
+    fmpz_clear(block);
+
+    if(period != 0 && preperiod + period <= max_fraction_digits){
+        dest = write_marker(dest, std::string_view(digits.data(), preperiod));
+        *dest++ = '(';
+        dest = write_marker(dest, std::string_view(digits.data() + preperiod, period));
+        *dest++ = ')';
+        return dest;
+    }else if(terminates && preperiod <= max_fraction_digits){
+        return write_marker(dest, std::string_view(digits.data(), preperiod));
+    }
+
+    dest = write_marker(dest, std::string_view(digits.data(), max_fraction_digits));
+    return write_marker(dest, DECIMAL_CUTOFF_MARKER);
+}
+
+static char* write_rational_as_decimal(char* dest, const fmpq_t val, fmpz_t integer_part, fmpz_t rem,
+                                       size_t max_fraction_digits) {
+    if(fmpq_sgn(val) == -1) *dest++ = '-';
+    dest = fmpz_get_abs_str(dest, integer_part);
+    if(fmpz_is_zero(rem)) return dest;
+    if(max_fraction_digits == 0) return write_marker(dest, DECIMAL_CUTOFF_MARKER);
+    *dest++ = '.';
+    return write_fraction_digits(dest, rem, fmpq_denref(val), max_fraction_digits);
+}
+
+void write_rational_as_decimal(std::string& str, const fmpq_t val, size_t max_fraction_digits) {
+    fmpz_t integer_part, rem;
+    fmpz_init(integer_part);
+    fmpz_init(rem);
+    fmpz_tdiv_qr(integer_part, rem, fmpq_numref(val), fmpq_denref(val));
+    fmpz_abs(rem, rem);
+
+    // Resize once for the largest possible output, then trim where the bound exceeded the need
+    const size_t start_index = str.size();
+    str.resize(start_index + rational_as_decimal_upperbound(integer_part, max_fraction_digits));
+    const char* end = write_rational_as_decimal(str.data() + start_index, val, integer_part, rem, max_fraction_digits);
+    str.resize(end - str.data());
+
+    fmpz_clear(integer_part);
+    fmpz_clear(rem);
+}
+
+void write_rational_as_decimal(OutputBuilder& out, const fmpq_t val, size_t max_fraction_digits) {
+    fmpz_t integer_part, rem;
+    fmpz_init(integer_part);
+    fmpz_init(rem);
+    fmpz_tdiv_qr(integer_part, rem, fmpq_numref(val), fmpq_denref(val));
+    fmpz_abs(rem, rem);
+
+    char* buffer = out.reserve(rational_as_decimal_upperbound(integer_part, max_fraction_digits));
+    const char* end = write_rational_as_decimal(buffer, val, integer_part, rem, max_fraction_digits);
+    out.commit(end - buffer);
+
+    fmpz_clear(integer_part);
+    fmpz_clear(rem);
 }
-template void write_big_rational<false>(std::string&, const fmpq_t);
-template void write_big_rational<true>(std::string&, const fmpq_t);
 
 inline static fmpq conv(NativeRational val) {
     fmpq ans {0, 0};
@@ -213,6 +363,470 @@ inline static fmpq conv(NativeRational val) {
     return ans;
 }
 
+fmpq fmpq_from_decimal_rational(DecimalRational val) {
+    return conv(val);
+}
+
+bool ckd_fmpq2dec(DecimalRational* result, const fmpq_t val) noexcept {
+    assert(fmpq_is_canonical(val));
+
+    return fmpz_sgn(fmpq_numref(val)) == -1
+           || !fmpz_abs_fits_ui(fmpq_numref(val))
+           || !fmpz_abs_fits_ui(fmpq_denref(val))
+           || ckd_rat2dec(result, NativeRational(fmpz_get_ui(fmpq_numref(val)), fmpz_get_ui(fmpq_denref(val))));
+}
+
+fmpq fmpq_from_signed_native_rational(SignedNativeRational val) {
+    NativeRational magnitude = val.magnitude();
+    magnitude.reduceInPlace();
+    fmpq ans = conv(magnitude);
+    if(val.isNegative()) fmpz_neg(&ans.num, &ans.num);
+
+    return ans;
+}
+
+/// The magnitude of an fmpz_t which is known to fit a ulong
+static ulong fmpz_get_abs_ui(const fmpz_t val) noexcept {
+    assert(fmpz_abs_fits_ui(val));
+    if(!COEFF_IS_MPZ(*val)) return static_cast<ulong>(std::abs(*val));
+    return mpz_getlimbn(COEFF_TO_PTR(*val), 0);
+}
+
+bool ckd_fmpq2signed(SignedNativeRational* result, const fmpq_t val) noexcept {
+    const fmpz* num = fmpq_numref(val);
+    const fmpz* den = fmpq_denref(val);
+    if(!fmpz_abs_fits_ui(num) || !fmpz_abs_fits_ui(den)) return true;
+
+    *result = SignedNativeRational(NativeRational(fmpz_get_abs_ui(num), fmpz_get_ui(den)), fmpz_sgn(num) == -1);
+    return false;
+}
+
+bool ckd_mpz2word(size_t* result, const mpz_t val) noexcept {
+    static_assert(sizeof(mp_limb_t) == sizeof(size_t));
+    if(mpz_sgn(val) < 0 || mpz_size(val) > 1) return true;
+    *result = mpz_getlimbn(val, 0);
+    return false;
+}
+
+bool ckd_fmpz2word(size_t* result, const fmpz_t val) noexcept {
+    if(COEFF_IS_MPZ(*val)) return ckd_mpz2word(result, COEFF_TO_PTR(*val));
+    *result = static_cast<size_t>(*val);
+    return *val < 0;
+}
+
+bool ckd_mpz2wide(size_t* high, size_t* low, const mpz_t val) noexcept {
+    static_assert(sizeof(mp_limb_t) == sizeof(size_t));
+    if(mpz_sgn(val) < 0 || mpz_size(val) > 2) return true;
+    *high = mpz_getlimbn(val, 1);
+    *low = mpz_getlimbn(val, 0);
+    return false;
+}
+
+bool ckd_fmpz2wide(size_t* high, size_t* low, const fmpz_t val) noexcept {
+    if(COEFF_IS_MPZ(*val)) return ckd_mpz2wide(high, low, COEFF_TO_PTR(*val));
+    *high = 0;
+    *low = static_cast<size_t>(*val);
+    return *val < 0;
+}
+
+bool ckd_fmpq2native(NativeRational* result, const fmpq_t val) noexcept {
+    return ckd_fmpz2word(&result->num, fmpq_numref(val)) || ckd_fmpz2word(&result->den, fmpq_denref(val));
+}
+
+/// Whether an fmpz is inline and nonnegative, since negative and pointer tagged coefficients exceed COEFF_MAX as words
+static bool fmpz_is_inline_word(fmpz val) noexcept {
+    return static_cast<size_t>(val) <= static_cast<size_t>(COEFF_MAX);
+}
+
+bool ckd_fmpz2word(size_t* results, uint8_t* overflow, const fmpz* vals, size_t num_vals) noexcept {
+    // Demote the inline values in a branch-free pass, then revisit only the values which are not inline
+    uint8_t any_big = 0;
+    for(size_t i = 0; i < num_vals; i++){
+        results[i] = static_cast<size_t>(vals[i]);
+        overflow[i] = !fmpz_is_inline_word(vals[i]);
+        any_big |= overflow[i];
+    }
+    if(!any_big) return false;
+
+    uint8_t any_overflow = 0;
+    for(size_t i = 0; i < num_vals; i++){
+        if(overflow[i]) overflow[i] = ckd_fmpz2word(results + i, vals + i);
+        any_overflow |= overflow[i];
+    }
+
+    return any_overflow;
+}
+
+bool ckd_fmpq2native(NativeRational* results, uint8_t* overflow, const fmpq* vals, size_t num_vals) noexcept {
+    uint8_t any_big = 0;
+    for(size_t i = 0; i < num_vals; i++){
+        results[i].num = static_cast<size_t>(vals[i].num);
+        results[i].den = static_cast<size_t>(vals[i].den);
+        overflow[i] = !fmpz_is_inline_word(vals[i].num) | !fmpz_is_inline_word(vals[i].den);
+        any_big |= overflow[i];
+    }
+    if(!any_big) return false;
+
+    uint8_t any_overflow = 0;
+    for(size_t i = 0; i < num_vals; i++){
+        if(overflow[i]) overflow[i] = ckd_fmpq2native(results + i, vals + i);
+        any_overflow |= overflow[i];
+    }
+
+    return any_overflow;
+}
+
+fmpq fmpq_from_product(RationalProductAccumulator& product) {
+    // Once cancelled, the product is the factors or else the reduced running value
+    product.cancel();
+    fmpq ans = conv(product.running());
+    for(const size_t factor : product.numeratorFactors()) fmpz_mul_ui(&ans.num, &ans.num, factor);
+    for(const size_t factor : product.denominatorFactors()) fmpz_mul_ui(&ans.den, &ans.den, factor);
+
+    return ans;
+}
+
+/// Set result to a + b or a - b. The denominators are cancelled by their word gcd before the word multiply-add,
+/// and any factor shared by the sum and the denominator must divide that gcd, as in fmpq_add.
+static void fmpq_addsub_native(fmpq_t result, const fmpq_t a, NativeRational b, bool subtract) {
+    b.reduceInPlace();
+    if(b.num == 0){
+        fmpq_set(result, a);
+        return;
+    }
+
+    fmpz* num = fmpq_numref(result);
+    fmpz* den = fmpq_denref(result);
+    const size_t gcd = binary_gcd(fmpz_fdiv_ui(fmpq_denref(a), b.den), b.den);
+
+    // The reduced denominator of a is set first, so that the result may alias a
+    fmpz_divexact_ui(den, fmpq_denref(a), gcd);
+    fmpz_mul_ui(num, fmpq_numref(a), b.den / gcd);
+    if(subtract) fmpz_submul_ui(num, den, b.num);
+    else fmpz_addmul_ui(num, den, b.num);
+
+    if(fmpz_is_zero(num)){
+        fmpz_set_ui(den, 1);
+        return;
+    }
+
+    const size_t sum_gcd = gcd == 1 ? 1 : binary_gcd(fmpz_fdiv_ui(num, gcd), gcd);
+    if(sum_gcd != 1) fmpz_divexact_ui(num, num, sum_gcd);
+    fmpz_mul_ui(den, den, b.den / sum_gcd);
+}
+
+void fmpq_add_native(fmpq_t result, const fmpq_t a, NativeRational b) {
+    fmpq_addsub_native(result, a, b, false);
+}
+
+void fmpq_sub_native(fmpq_t result, const fmpq_t a, NativeRational b) {
+    fmpq_addsub_native(result, a, b, true);
+}
+
+void fmpq_mul_native(fmpq_t result, const fmpq_t a, NativeRational b) {
+    b.reduceInPlace();
+    if(b.num == 0 || fmpq_is_zero(a)){
+        fmpz_set_ui(fmpq_numref(result), 0);
+        fmpz_set_ui(fmpq_denref(result), 1);
+        return;
+    }
+
+    // Each numerator is cancelled against the other denominator, leaving the products canonical
+    const size_t num_gcd = binary_gcd(fmpz_fdiv_ui(fmpq_numref(a), b.den), b.den);
+    const size_t den_gcd = binary_gcd(fmpz_fdiv_ui(fmpq_denref(a), b.num), b.num);
+    fmpz_divexact_ui(fmpq_numref(result), fmpq_numref(a), num_gcd);
+    fmpz_mul_ui(fmpq_numref(result), fmpq_numref(result), b.num / den_gcd);
+    fmpz_divexact_ui(fmpq_denref(result), fmpq_denref(a), den_gcd);
+    fmpz_mul_ui(fmpq_denref(result), fmpq_denref(result), b.den / num_gcd);
+}
+
+void fmpq_div_native(fmpq_t result, const fmpq_t a, NativeRational b) {
+    assert(b.num != 0);
+    fmpq_mul_native(result, a, b.reciprocal());
+}
+
+/// The words of the magnitude of an fmpz_t, least significant first, pointing to word if the value is inline
+static const size_t* fmpz_abs_words(const fmpz_t val, size_t* word, size_t* num_words) noexcept {
+    if(!COEFF_IS_MPZ(*val)){
+        *word = static_cast<size_t>(std::abs(*val));
+        *num_words = *word != 0;
+        return word;
+    }
+
+    static_assert(sizeof(mp_limb_t) == sizeof(size_t));
+    const mpz_srcptr big = COEFF_TO_PTR(*val);
+    *num_words = mpz_size(big);
+    return reinterpret_cast<const size_t*>(mpz_limbs_read(big));
+}
+
+/// Compare a * a_factor with b * b_factor, where a and b are words least significant first.
+/// The products are formed a word at a time from the least significant, so the last differing word decides.
+static int cmp_scaled_words(const size_t* a, size_t a_size, size_t a_factor,
+                            const size_t* b, size_t b_size, size_t b_factor) noexcept {
+    int result = 0;
+    size_t a_carry = 0;
+    size_t b_carry = 0;
+    for(size_t i = 0; i < a_size || i < b_size; i++){
+        size_t a_high;
+        size_t a_word = mul_wide(i < a_size ? a[i] : 0, a_factor, &a_high) + a_carry;
+        a_carry = a_high + (a_word < a_carry);
+
+        size_t b_high;
+        size_t b_word = mul_wide(i < b_size ? b[i] : 0, b_factor, &b_high) + b_carry;
+        b_carry = b_high + (b_word < b_carry);
+
+        if(a_word != b_word) result = a_word < b_word ? -1 : 1;
+    }
+    if(a_carry != b_carry) result = a_carry < b_carry ? -1 : 1;
+
+    return result;
+}
+
+int fmpq_cmp_native(const fmpq_t a, NativeRational b) noexcept {
+    const int sign = fmpz_sgn(fmpq_numref(a));
+    if(sign <= 0) return sign < 0 || b.num != 0 ? -1 : 0;
+    if(b.num == 0) return 1;
+
+    // a.num/a.den against b.num/b.den by the cross products a.num*b.den and b.num*a.den
+    size_t num_word, den_word, num_size, den_size;
+    const size_t* num = fmpz_abs_words(fmpq_numref(a), &num_word, &num_size);
+    const size_t* den = fmpz_abs_words(fmpq_denref(a), &den_word, &den_size);
+    return cmp_scaled_words(num, num_size, b.den, den, den_size, b.num);
+}
+
+/// The leading 64 bits of a positive integer, given as words least significant first, shifted so that the top bit is set.
+/// Sets the exponent so that the integer lies in [bits, bits + 1) * 2^exponent.
+/// On 32-bit targets the bits are gathered from up to three words, so that an estimate keeps as many bits as on 64-bit.
+static uint64_t leading_bits(const size_t* words, size_t num_words, ptrdiff_t* exponent) noexcept {
+    constexpr size_t WORD_BITS = std::numeric_limits<size_t>::digits;
+    constexpr size_t LEADING_BITS = std::numeric_limits<uint64_t>::digits;
+    assert(num_words != 0 && words[num_words - 1] != 0);
+    const size_t shift = count_leading_zeros(words[num_words - 1]);
+    size_t filled = WORD_BITS - shift;
+    *exponent = static_cast<ptrdiff_t>(num_words * WORD_BITS - shift) - static_cast<ptrdiff_t>(LEADING_BITS);
+
+    uint64_t bits = static_cast<uint64_t>(words[num_words - 1]) << (LEADING_BITS - filled);
+    for(size_t i = num_words - 1; i-- > 0 && filled < LEADING_BITS; filled += WORD_BITS){
+        if(filled + WORD_BITS <= LEADING_BITS) bits |= static_cast<uint64_t>(words[i]) << (LEADING_BITS - filled - WORD_BITS);
+        else bits |= static_cast<uint64_t>(words[i]) >> (filled + WORD_BITS - LEADING_BITS);
+    }
+    return bits;
+}
+
+/// Leading bits of the numerator and denominator kept by an estimate, which are exact as doubles
+static constexpr size_t ESTIMATE_BITS = 53;
+static_assert(ESTIMATE_BITS <= std::numeric_limits<double>::digits);
+static_assert(ESTIMATE_BITS <= std::numeric_limits<uint64_t>::digits);
+
+/// A positive rational as num / den * 2^exponent, from the leading ESTIMATE_BITS of its numerator and denominator.
+/// Each is below its true value by a relative 2^(1 - ESTIMATE_BITS), so the true ratio lies in (1/2, 2).
+struct MagnitudeEstimate {
+    double num;
+    double den;
+    ptrdiff_t exponent;
+};
+
+static MagnitudeEstimate estimate_magnitude(const size_t* num, size_t num_size, const size_t* den, size_t den_size) noexcept {
+    // Converting a signed value with no more bits than a double avoids the slower conversion of a full unsigned word
+    constexpr size_t SHIFT = std::numeric_limits<uint64_t>::digits - ESTIMATE_BITS;
+    ptrdiff_t num_exponent, den_exponent;
+    const int64_t num_bits = static_cast<int64_t>(leading_bits(num, num_size, &num_exponent) >> SHIFT);
+    const int64_t den_bits = static_cast<int64_t>(leading_bits(den, den_size, &den_exponent) >> SHIFT);
+    return MagnitudeEstimate{static_cast<double>(num_bits), static_cast<double>(den_bits), num_exponent - den_exponent};
+}
+
+/// Compare positive magnitudes by their estimates, returning true and setting result if the bounds do not overlap
+static bool estimates_separate(int* result, MagnitudeEstimate a, MagnitudeEstimate b, FilteredCmpCounters* counters) noexcept {
+    // Ratios in (1/2, 2) cannot overlap once the exponents differ by 2
+    if(a.exponent >= b.exponent + 2 || b.exponent >= a.exponent + 2){
+        *result = a.exponent > b.exponent ? 1 : -1;
+        if(counters) counters->by_bit_length++;
+        return true;
+    }
+
+    // The cross products of the leading bits are within a relative 2^(3 - ESTIMATE_BITS) of the true cross products
+    // after truncation and rounding, so a margin four times larger leaves only bounds which overlap
+    constexpr double MARGIN = 1 + 1.0 / static_cast<double>(uint64_t(1) << (ESTIMATE_BITS - 5));
+    const double scale = a.exponent == b.exponent ? 1.0 : a.exponent > b.exponent ? 2.0 : 0.5;
+    const double a_cross = a.num * b.den * scale;
+    const double b_cross = b.num * a.den;
+    if(a_cross > b_cross * MARGIN || b_cross > a_cross * MARGIN){
+        *result = a_cross > b_cross ? 1 : -1;
+        if(counters) counters->by_estimate++;
+        return true;
+    }
+
+    return false;
+}
+
+int fmpq_cmp_filtered(const fmpq_t a, const fmpq_t b, FilteredCmpCounters* counters) noexcept {
+    const int a_sign = fmpz_sgn(fmpq_numref(a));
+    const int b_sign = fmpz_sgn(fmpq_numref(b));
+    if(a_sign != b_sign || a_sign == 0){
+        if(counters) counters->by_bit_length++;
+        return a_sign - b_sign;
+    }
+
+    size_t a_num_word, a_den_word, b_num_word, b_den_word;
+    size_t a_num_size, a_den_size, b_num_size, b_den_size;
+    const size_t* a_num = fmpz_abs_words(fmpq_numref(a), &a_num_word, &a_num_size);
+    const size_t* a_den = fmpz_abs_words(fmpq_denref(a), &a_den_word, &a_den_size);
+    const size_t* b_num = fmpz_abs_words(fmpq_numref(b), &b_num_word, &b_num_size);
+    const size_t* b_den = fmpz_abs_words(fmpq_denref(b), &b_den_word, &b_den_size);
+
+    int result;
+    if(estimates_separate(&result, estimate_magnitude(a_num, a_num_size, a_den, a_den_size),
+                          estimate_magnitude(b_num, b_num_size, b_den, b_den_size), counters))
+        return a_sign * result;
+
+    if(counters) counters->exact++;
+    return fmpq_cmp(a, b);
+}
+
+int fmpq_cmp_filtered(const fmpq_t a, NativeRational b, FilteredCmpCounters* counters) noexcept {
+    const int a_sign = fmpz_sgn(fmpq_numref(a));
+    const int b_sign = b.num != 0;
+    if(a_sign != b_sign || a_sign == 0){
+        if(counters) counters->by_bit_length++;
+        return a_sign - b_sign;
+    }
+
+    size_t a_num_word, a_den_word, a_num_size, a_den_size;
+    const size_t* a_num = fmpz_abs_words(fmpq_numref(a), &a_num_word, &a_num_size);
+    const size_t* a_den = fmpz_abs_words(fmpq_denref(a), &a_den_word, &a_den_size);
+
+    // The exact comparison makes a single pass over the words of a, which is cheaper than estimating for short values
+    constexpr size_t MIN_FILTERED_WORDS = 16;
+    int result;
+    if(a_num_size + a_den_size >= MIN_FILTERED_WORDS
+       && estimates_separate(&result, estimate_magnitude(a_num, a_num_size, a_den, a_den_size),
+                             estimate_magnitude(&b.num, 1, &b.den, 1), counters))
+        return result;
+
+    if(counters) counters->exact++;
+    return cmp_scaled_words(a_num, a_num_size, b.den, a_den, a_den_size, b.num);
+}
+
+int fmpq_cmp_filtered(const fmpq_t a, size_t b, FilteredCmpCounters* counters) noexcept {
+    return fmpq_cmp_filtered(a, NativeRational(b, 1), counters);
+}
+
+/// Hash of the magnitude as hash_words, whether the value is inline or an mpz
+static size_t fmpz_abs_hash(const fmpz_t val) noexcept {
+    size_t word, num_words;
+    const size_t* words = fmpz_abs_words(val, &word, &num_words);
+    return hash_words(words, num_words);
+}
+
+size_t canonical_hash(const fmpq_t val) noexcept {
+    return hash_rational(fmpz_abs_hash(fmpq_numref(val)), fmpz_abs_hash(fmpq_denref(val)), fmpz_sgn(fmpq_numref(val)) < 0);
+}
+
+size_t fmpz_heap_bytes(const fmpz_t val) noexcept {
+    if(!COEFF_IS_MPZ(*val)) return 0;
+    return sizeof(__mpz_struct) + static_cast<size_t>(COEFF_TO_PTR(*val)->_mp_alloc) * sizeof(mp_limb_t);
+}
+
+size_t fmpq_heap_bytes(const fmpq_t val) noexcept {
+    return fmpz_heap_bytes(fmpq_numref(val)) + fmpz_heap_bytes(fmpq_denref(val));
+}
+
+BigScaledDecimal bigdec_from_scaled(ScaledDecimal val) {
+    BigScaledDecimal ans {0, val.exponent};
+    fmpz_init_set_ui(&ans.mantissa, val.mantissa);
+
+    return ans;
+}
+
+void bigdec_clear(BigScaledDecimal* val) noexcept {
+    fmpz_clear(&val->mantissa);
+}
+
+/// Set result to the mantissas of a and b aligned to the smaller exponent, combined by op
+template<void (*op)(fmpz_t, const fmpz_t, const fmpz_t)>
+static void bigdec_aligned(BigScaledDecimal* result, const BigScaledDecimal& a, const BigScaledDecimal& b) {
+    if(a.exponent == b.exponent){
+        op(&result->mantissa, &a.mantissa, &b.mantissa);
+        return;
+    }
+
+    fmpz_t scaled;
+    fmpz_init(scaled);
+    const slong exponent = std::min(a.exponent, b.exponent);
+    if(a.exponent > b.exponent){
+        fmpz_10_pow_ui(scaled, static_cast<ulong>(a.exponent - b.exponent));
+        fmpz_mul(scaled, scaled, &a.mantissa);
+        op(&result->mantissa, scaled, &b.mantissa);
+    }else{
+        fmpz_10_pow_ui(scaled, static_cast<ulong>(b.exponent - a.exponent));
+        fmpz_mul(scaled, scaled, &b.mantissa);
+        op(&result->mantissa, &a.mantissa, scaled);
+    }
+    result->exponent = exponent;
+    fmpz_clear(scaled);
+}
+
+void bigdec_add(BigScaledDecimal* result, const BigScaledDecimal& a, const BigScaledDecimal& b) {
+    bigdec_aligned<fmpz_add>(result, a, b);
+}
+
+void bigdec_sub(BigScaledDecimal* result, const BigScaledDecimal& a, const BigScaledDecimal& b) {
+    bigdec_aligned<fmpz_sub>(result, a, b);
+}
+
+void bigdec_mul(BigScaledDecimal* result, const BigScaledDecimal& a, const BigScaledDecimal& b) {
+    fmpz_mul(&result->mantissa, &a.mantissa, &b.mantissa);
+    result->exponent = a.exponent + b.exponent;
+}
+
+int bigdec_cmp(const BigScaledDecimal& a, const BigScaledDecimal& b) {
+    BigScaledDecimal difference {0, 0};
+    bigdec_sub(&difference, a, b);
+    const int sign = fmpz_sgn(&difference.mantissa);
+    bigdec_clear(&difference);
+
+    return sign;
+}
+
+bool ckd_bigdec2scaled(ScaledDecimal* result, const BigScaledDecimal& val) noexcept {
+    if(fmpz_sgn(&val.mantissa) == -1 || !fmpz_abs_fits_ui(&val.mantissa)
+       || val.exponent < std::numeric_limits<int16_t>::min() || val.exponent > std::numeric_limits<int16_t>::max())
+        return true;
+
+    *result = ScaledDecimal(fmpz_get_ui(&val.mantissa), static_cast<int16_t>(val.exponent));
+    return false;
+}
+
+/// Upper bound on the chars write_big_scaled_decimal may use, including the slot for the decimal point
+static size_t big_scaled_decimal_str_upperbound(const BigScaledDecimal& val) noexcept {
+    // Sign, decimal point and slot, leading zero, exponent marker, sign and digits, with some to spare
+    static constexpr size_t OVERHEAD = 16 + std::numeric_limits<size_t>::digits10 + 1;
+    const size_t abs_exponent = val.exponent < 0 ? -static_cast<size_t>(val.exponent) : static_cast<size_t>(val.exponent);
+    return fmpz_abs_str_upperbound(&val.mantissa) + abs_exponent + OVERHEAD;
+}
+
+static char* write_big_scaled_decimal(char* dest, const BigScaledDecimal& val, FloatNotation notation) noexcept {
+    if(fmpz_sgn(&val.mantissa) == -1) *dest++ = '-';
+
+    // Digits are written one past the destination, leaving a slot for the decimal point
+    const char* digits_end = fmpz_get_abs_str(dest+1, &val.mantissa);
+    const size_t num_digits = static_cast<size_t>(digits_end - (dest+1));
+    return layout_scaled_decimal(dest, num_digits, val.exponent, notation);
+}
+
+void write_big_scaled_decimal(std::string& str, const BigScaledDecimal& val, FloatNotation notation) {
+    const size_t start_index = str.size();
+    str.resize(start_index + big_scaled_decimal_str_upperbound(val));
+    const char* end = write_big_scaled_decimal(str.data() + start_index, val, notation);
+    str.resize(end - str.data());
+}
+
+void write_big_scaled_decimal(OutputBuilder& out, const BigScaledDecimal& val, FloatNotation notation) {
+    char* buffer = out.reserve(big_scaled_decimal_str_upperbound(val));
+    const char* end = write_big_scaled_decimal(buffer, val, notation);
+    out.commit(end - buffer);
+}
+
 fmpq fmpq_from_decimal_str(std::string_view str) {
     const auto decimal_index = str.find('.');
     if(decimal_index == std::string::npos) return {fmpz_from_strview(str), *FMPZ_ONE};
@@ -0,0 +1,42 @@
+#ifndef KI_CAS_CANONICAL_HASH_H
+#define KI_CAS_CANONICAL_HASH_H
+
+#include "ki_cas_wide_integer.h"
+#include <limits>
+#include <stddef.h>
+
+namespace KiCAS2 {
+
+// Canonical hashes are built from the words of the reduced numerator magnitude and denominator,
+// so native and big representations of the same value hash alike without formatting either.
+
+/// Mix a word into a hash by a full-width multiply, folding the high word back into the low
+inline size_t hash_mix(size_t hash, size_t word) noexcept {
+    constexpr bool IS_64_BIT = std::numeric_limits<size_t>::digits == 64;
+    constexpr size_t SECRET_A = IS_64_BIT ? static_cast<size_t>(0xA0761D6478BD642Full) : size_t(0x9E3779B9u);
+    constexpr size_t SECRET_B = IS_64_BIT ? static_cast<size_t>(0xE7037ED1A0B428DBull) : size_t(0x85EBCA6Bu);
+    size_t high;
+    const size_t low = mul_wide(hash ^ SECRET_A, word ^ SECRET_B, &high);
+    return low ^ high;
+}
+
+/// Hash of a nonnegative integer from its words, least significant first, with no zero leading word
+inline size_t hash_words(const size_t* words, size_t num_words) noexcept {
+    size_t hash = num_words;
+    for(size_t i = 0; i < num_words; i++) hash = hash_mix(hash, words[i]);
+    return hash;
+}
+
+/// Hash of a nonnegative integer which fits in a word, as hash_words without branching on zero
+inline size_t hash_word(size_t word) noexcept {
+    return word != 0 ? hash_mix(1, word) : 0;
+}
+
+/// Combine the hashes of a reduced numerator magnitude and denominator with the sign of the value
+inline size_t hash_rational(size_t num_hash, size_t den_hash, bool is_negative) noexcept {
+    return hash_mix(num_hash ^ (size_t(0) - is_negative), den_hash);
+}
+
+}  // namespace KiCAS2
+
+#endif // KI_CAS_CANONICAL_HASH_H
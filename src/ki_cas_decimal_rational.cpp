@@ -0,0 +1,259 @@
+#include "ki_cas_decimal_rational.h"
+
+#include "ki_cas_digit_writing.h"
+#include "ki_cas_native_integer.h"
+#include "ki_cas_wide_integer.h"
+#include <algorithm>
+#include <cassert>
+#include <limits>
+
+namespace KiCAS2 {
+
+/// The inverse of 5 modulo the word size, so multiplying a multiple of 5 by it divides exactly
+static constexpr size_t INVERSE_OF_FIVE = std::numeric_limits<size_t>::max() / 5 * 4 + 1;
+static_assert(INVERSE_OF_FIVE * 5 == 1);
+
+/// Divide a nonzero val by 5 while it is a multiple, at most max_fives times, returning the number of divisions
+static size_t remove_fives(size_t* val, size_t max_fives) noexcept {
+    assert(*val != 0);
+
+    // Multiplying by the inverse lands at or below MAX/5 exactly when val is a multiple of 5
+    size_t fives = 0;
+    while(fives < max_fives){
+        const size_t quotient = *val * INVERSE_OF_FIVE;
+        if(quotient > std::numeric_limits<size_t>::max() / 5) break;
+        *val = quotient;
+        fives++;
+    }
+
+    return fives;
+}
+
+/// Shift a nonzero val right past its trailing zeros, at most max_twos places, returning the shift
+static size_t remove_twos(size_t* val, size_t max_twos) noexcept {
+    assert(*val != 0);
+    const size_t twos = std::min(count_trailing_zeros(*val), max_twos);
+    *val >>= twos;
+    return twos;
+}
+
+bool ckd_decimal_den(size_t* result, size_t twos, size_t fives) noexcept {
+    if(fives >= NUM_POWERS_OF_FIVE || twos >= std::numeric_limits<size_t>::digits) return true;
+
+    const size_t power_of_five = powers_of_five[fives];
+    if(power_of_five > (std::numeric_limits<size_t>::max() >> twos)) return true;
+
+    *result = power_of_five << twos;
+    return false;
+}
+
+DecimalRational::DecimalRational(size_t mantissa, uint8_t twos, uint8_t fives) noexcept
+    : mantissa(mantissa), twos(twos), fives(fives) {
+    assert(mantissa != 0 || (twos == 0 && fives == 0));
+    assert(twos == 0 || mantissa % 2 == 1);
+    assert(fives == 0 || mantissa % 5 != 0);
+    #ifndef NDEBUG
+    size_t den;
+    assert(ckd_decimal_den(&den, twos, fives) == false);
+    #endif
+}
+
+size_t DecimalRational::den() const noexcept {
+    return powers_of_five[fives] << twos;
+}
+
+DecimalRational::operator NativeRational() const noexcept {
+    return NativeRational(mantissa, den());
+}
+
+bool operator==(DecimalRational a, DecimalRational b) noexcept {
+    return a.mantissa == b.mantissa && a.twos == b.twos && a.fives == b.fives;
+}
+
+bool operator!=(DecimalRational a, DecimalRational b) noexcept {
+    return !(a == b);
+}
+
+bool operator>(DecimalRational a, DecimalRational b) noexcept {
+    return b < a;
+}
+
+bool operator>=(DecimalRational a, DecimalRational b) noexcept {
+    return !(a < b);
+}
+
+bool operator<(DecimalRational a, DecimalRational b) noexcept {
+    if(a.twos == b.twos && a.fives == b.fives) return a.mantissa < b.mantissa;
+    return NativeRational(a) < NativeRational(b);
+}
+
+bool operator<=(DecimalRational a, DecimalRational b) noexcept {
+    return !(b < a);
+}
+
+/// Set result to mantissa / (2^twos * 5^fives) after cancelling common factors.
+/// Returns true if the reduced denominator does not fit.
+static bool ckd_canonicalise(DecimalRational* result, size_t mantissa, size_t twos, size_t fives) noexcept {
+    if(mantissa == 0){
+        *result = DecimalRational(0, 0, 0);
+        return false;
+    }
+
+    twos -= remove_twos(&mantissa, twos);
+    fives -= remove_fives(&mantissa, fives);
+
+    size_t den;
+    if(ckd_decimal_den(&den, twos, fives)) return true;
+    *result = DecimalRational(mantissa, static_cast<uint8_t>(twos), static_cast<uint8_t>(fives));
+    return false;
+}
+
+/// Set result to the three-word mantissa, most significant first, over 2^twos * 5^fives after cancelling.
+/// Returns true if the reduced mantissa or denominator does not fit.
+static bool ckd_canonicalise_wide(DecimalRational* result, size_t mantissa[3], size_t twos, size_t fives) noexcept {
+    if((mantissa[0] | mantissa[1]) == 0) return ckd_canonicalise(result, mantissa[2], twos, fives);
+
+    // The denominator fits in a word, so fewer than a word of trailing zeros may cancel
+    const size_t shift = (mantissa[2] == 0) ? twos : std::min(count_trailing_zeros(mantissa[2]), twos);
+    if(shift != 0){
+        constexpr size_t WORD_BITS = std::numeric_limits<size_t>::digits;
+        mantissa[2] = (mantissa[2] >> shift) | (mantissa[1] << (WORD_BITS - shift));
+        mantissa[1] = (mantissa[1] >> shift) | (mantissa[0] << (WORD_BITS - shift));
+        mantissa[0] >>= shift;
+        twos -= shift;
+    }
+
+    while((mantissa[0] | mantissa[1]) != 0 && fives != 0 && mod_words(mantissa, 3, 5) == 0){
+        divexact_words(mantissa, 3, 5);
+        fives--;
+    }
+
+    return (mantissa[0] | mantissa[1]) != 0 || ckd_canonicalise(result, mantissa[2], twos, fives);
+}
+
+bool ckd_mul(DecimalRational* result, DecimalRational a, DecimalRational b) noexcept {
+    if(a.mantissa == 0 || b.mantissa == 0){
+        *result = DecimalRational(0, 0, 0);
+        return false;
+    }
+
+    // Canonical operands only cancel across each other
+    size_t a_mantissa = a.mantissa;
+    size_t b_mantissa = b.mantissa;
+    const size_t b_twos = b.twos - remove_twos(&a_mantissa, b.twos);
+    const size_t a_twos = a.twos - remove_twos(&b_mantissa, a.twos);
+    const size_t b_fives = b.fives - remove_fives(&a_mantissa, b.fives);
+    const size_t a_fives = a.fives - remove_fives(&b_mantissa, a.fives);
+
+    size_t mantissa;
+    size_t den;
+    if(ckd_mul(&mantissa, a_mantissa, b_mantissa) || ckd_decimal_den(&den, a_twos + b_twos, a_fives + b_fives))
+        return true;
+
+    *result = DecimalRational(mantissa, static_cast<uint8_t>(a_twos + b_twos), static_cast<uint8_t>(a_fives + b_fives));
+    return false;
+}
+
+/// Set result to a mantissa aligned to the common denominator of a and b after cancelling common factors.
+/// For a sum or difference, a prime can only cancel when its exponents are equal in both operands.
+/// Returns true if the reduced denominator does not fit.
+static bool ckd_canonicalise_aligned(DecimalRational* result, size_t mantissa, DecimalRational a, DecimalRational b) noexcept {
+    if(mantissa == 0){
+        *result = DecimalRational(0, 0, 0);
+        return false;
+    }
+
+    size_t twos = std::max(a.twos, b.twos);
+    size_t fives = std::max(a.fives, b.fives);
+    if(a.twos == b.twos) twos -= remove_twos(&mantissa, twos);
+    if(a.fives == b.fives) fives -= remove_fives(&mantissa, fives);
+
+    size_t den;
+    if(ckd_decimal_den(&den, twos, fives)) return true;
+    *result = DecimalRational(mantissa, static_cast<uint8_t>(twos), static_cast<uint8_t>(fives));
+    return false;
+}
+
+bool ckd_add(DecimalRational* result, DecimalRational a, DecimalRational b) noexcept {
+    // Align to the common denominator 2^max(twos) * 5^max(fives),
+    // where each scale divides the other denominator so fits in a word
+    const size_t twos = std::max(a.twos, b.twos);
+    const size_t fives = std::max(a.fives, b.fives);
+    size_t a_high;
+    size_t b_high;
+    const size_t a_low = mul_wide(a.mantissa, powers_of_five[fives - a.fives] << (twos - a.twos), &a_high);
+    const size_t b_low = mul_wide(b.mantissa, powers_of_five[fives - b.fives] << (twos - b.twos), &b_high);
+    size_t sum[3];
+    add_wide(sum, a_high, a_low, b_high, b_low);
+
+    if((sum[0] | sum[1]) == 0) return ckd_canonicalise_aligned(result, sum[2], a, b);
+    return ckd_canonicalise_wide(result, sum, twos, fives);
+}
+
+bool ckd_sub(DecimalRational* result, DecimalRational a, DecimalRational b) noexcept {
+    assert(a >= b);
+
+    const size_t twos = std::max(a.twos, b.twos);
+    const size_t fives = std::max(a.fives, b.fives);
+    size_t a_high;
+    size_t b_high;
+    const size_t a_low = mul_wide(a.mantissa, powers_of_five[fives - a.fives] << (twos - a.twos), &a_high);
+    const size_t b_low = mul_wide(b.mantissa, powers_of_five[fives - b.fives] << (twos - b.twos), &b_high);
+    size_t difference[3];
+    sub_wide(difference, a_high, a_low, b_high, b_low);
+
+    if(difference[1] == 0) return ckd_canonicalise_aligned(result, difference[2], a, b);
+    return ckd_canonicalise_wide(result, difference, twos, fives);
+}
+
+bool ckd_rat2dec(DecimalRational* result, NativeRational val) noexcept {
+    val.reduceInPlace();
+
+    size_t den = val.den;
+    const size_t twos = remove_twos(&den, std::numeric_limits<size_t>::digits);
+    const size_t fives = remove_fives(&den, NUM_POWERS_OF_FIVE);
+    if(den != 1) return true;
+
+    *result = DecimalRational(val.num, static_cast<uint8_t>(twos), static_cast<uint8_t>(fives));
+    return false;
+}
+
+bool ckd_strdecimal2dec(DecimalRational* result, std::string_view str) noexcept {
+    const size_t decimal_index = std::min(str.find('.'), str.size());
+    #ifndef NDEBUG
+    for(size_t i = 0; i < str.size(); i++) assert((str[i] >= '0' && str[i] <= '9') || (i == decimal_index));
+    #endif
+
+    // Leading zeros do not contribute, and trailing fractional zeros only scale the denominator by 10
+    size_t integer_start = 0;
+    while(integer_start < decimal_index && str[integer_start] == '0') integer_start++;
+    size_t fraction_end = str.size();
+    while(fraction_end > decimal_index+1 && str[fraction_end-1] == '0') fraction_end--;
+    const size_t num_fraction_digits = (fraction_end > decimal_index) ? fraction_end - (decimal_index+1) : 0;
+
+    const std::string_view integer_digits = str.substr(integer_start, decimal_index - integer_start);
+    const std::string_view fraction_digits = str.substr(std::min(decimal_index+1, str.size()), num_fraction_digits);
+    const size_t num_digits = integer_digits.size() + num_fraction_digits;
+    if(num_digits == 0){
+        *result = DecimalRational(0, 0, 0);
+        return false;
+    }else if(num_digits > std::numeric_limits<size_t>::digits10+1){
+        return true;
+    }
+
+    size_t mantissa = 0;
+    if(num_digits <= std::numeric_limits<size_t>::digits10){
+        // Too few digits to overflow
+        for(const char ch : integer_digits) mantissa = 10*mantissa + (ch - '0');
+        for(const char ch : fraction_digits) mantissa = 10*mantissa + (ch - '0');
+    }else{
+        char buffer[std::numeric_limits<size_t>::digits10+1];
+        std::copy(integer_digits.begin(), integer_digits.end(), buffer);
+        std::copy(fraction_digits.begin(), fraction_digits.end(), buffer + integer_digits.size());
+        if(ckd_str2int(&mantissa, std::string_view(buffer, num_digits))) return true;
+    }
+
+    return ckd_canonicalise(result, mantissa, num_fraction_digits, num_fraction_digits);
+}
+
+}  // namespace KiCAS2
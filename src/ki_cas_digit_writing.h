@@ -0,0 +1,199 @@
+#ifndef KI_CAS_DIGIT_WRITING_H
+#define KI_CAS_DIGIT_WRITING_H
+
+#include "ki_cas_native_float.h"
+#include <algorithm>
+#include <cassert>
+#include <charconv>
+#include <cstring>
+#include <limits>
+#include <stddef.h>
+#include <string_view>
+
+namespace KiCAS2 {
+
+/// Every power of ten which fits in a word
+inline constexpr size_t powers_of_ten[] = {
+    1,
+    10,
+    100,
+    1000,
+    10000,
+    100000,
+    1000000,
+    10000000,
+    100000000,
+    1000000000uLL,
+#if defined(__x86_64__) || defined(__aarch64__) || defined( _WIN64 )  // 64-bit
+    10000000000,
+    100000000000,
+    1000000000000,
+    10000000000000,
+    100000000000000,
+    1000000000000000,
+    10000000000000000,
+    100000000000000000,
+    1000000000000000000,
+    10000000000000000000uLL,
+#endif
+};
+inline constexpr size_t NUM_POWERS_OF_TEN = sizeof(powers_of_ten) / sizeof(size_t);
+
+// Check this rather than specify it to make sure the macro worked
+static_assert(NUM_POWERS_OF_TEN == std::numeric_limits<size_t>::digits10+1);
+
+/// Every power of five which fits in a word
+inline constexpr size_t powers_of_five[] = {
+    1,
+    5,
+    25,
+    125,
+    625,
+    3125,
+    15625,
+    78125,
+    390625,
+    1953125,
+    9765625,
+    48828125,
+    244140625,
+    1220703125uLL,
+#if defined(__x86_64__) || defined(__aarch64__) || defined( _WIN64 )  // 64-bit
+    6103515625,
+    30517578125,
+    152587890625,
+    762939453125,
+    3814697265625,
+    19073486328125,
+    95367431640625,
+    476837158203125,
+    2384185791015625,
+    11920928955078125,
+    59604644775390625,
+    298023223876953125,
+    1490116119384765625,
+    7450580596923828125uLL,
+#endif
+};
+inline constexpr size_t NUM_POWERS_OF_FIVE = sizeof(powers_of_five) / sizeof(size_t);
+
+// Check this rather than specify it to make sure the macro worked
+static_assert(powers_of_five[NUM_POWERS_OF_FIVE-1] > std::numeric_limits<size_t>::max() / 5);
+
+/// Return the number of base10 digits required to express the integer
+inline size_t count_base10_digits(size_t val) noexcept {
+    // Branch-free so that loops over values vectorise where 64-bit lane comparisons are available
+    size_t digits = 1;
+    size_t power = 10;
+    for(size_t i = 1; i <= std::numeric_limits<size_t>::digits10; i++){
+        digits += (val >= power);
+        power *= 10;
+    }
+    return digits;
+}
+
+/// Write an integer with a known number of digits, returning the end of the written digits
+inline char* write_base10_digits(char* dest, size_t val, size_t num_digits) noexcept {
+    const std::to_chars_result result = std::to_chars(dest, dest + num_digits, val);
+    assert(result.ec == std::errc());
+    assert(result.ptr == dest + num_digits);
+    return result.ptr;
+}
+
+/// Write an integer left-padded with zeros to a known number of digits, returning the end of the written digits
+inline char* write_zero_padded_digits(char* dest, size_t val, size_t num_digits) noexcept {
+    const size_t val_digits = count_base10_digits(val);
+    assert(val_digits <= num_digits);
+    memset(dest, '0', num_digits - val_digits);
+    return write_base10_digits(dest + (num_digits - val_digits), val, val_digits);
+}
+
+/// Written in place of the remaining digits of a decimal expansion which is cut off
+inline constexpr std::string_view DECIMAL_CUTOFF_MARKER = "...";
+
+/// Copy a marker, returning the end of the written marker
+inline char* write_marker(char* dest, std::string_view marker) noexcept {
+    memcpy(dest, marker.data(), marker.size());
+    return dest + marker.size();
+}
+
+/// Write a run of zeros, returning the end of the written zeros
+inline char* write_zeros(char* dest, size_t count) noexcept {
+    memset(dest, '0', count);
+    return dest + count;
+}
+
+/// Lay out the digits of 0.d1d2...dn × 10^k, which are at dest+1, in fixed notation
+inline char* layout_fixed(char* dest, size_t n, ptrdiff_t k, size_t fraction_digits) noexcept {
+    if(k > 0){
+        const size_t integer_digits = static_cast<size_t>(k);
+        if(n <= integer_digits){
+            memmove(dest, dest+1, n);
+            dest = write_zeros(dest + n, integer_digits - n);
+            if(fraction_digits == 0) return dest;
+            *dest++ = '.';
+            return write_zeros(dest, fraction_digits);
+        }
+
+        memmove(dest, dest+1, integer_digits);
+        dest[integer_digits] = '.';
+        return write_zeros(dest + n + 1, fraction_digits - (n - integer_digits));
+    }
+
+    const size_t leading_zeros = std::min(static_cast<size_t>(-k), fraction_digits);
+    memmove(dest + 2 + leading_zeros, dest+1, n);
+    dest[0] = '0';
+    if(fraction_digits == 0) return dest + 1;
+    dest[1] = '.';
+    write_zeros(dest + 2, leading_zeros);
+    return write_zeros(dest + 2 + leading_zeros + n, fraction_digits - leading_zeros - n);
+}
+
+/// Lay out the digits of 0.d1d2...dn × 10^k, which are at dest+1, in scientific notation
+inline char* layout_scientific(char* dest, size_t n, ptrdiff_t k, size_t fraction_digits) noexcept {
+    dest[0] = dest[1];
+    if(fraction_digits == 0){
+        dest++;
+    }else{
+        dest[1] = '.';
+        dest = write_zeros(dest + 1 + n, fraction_digits - (n-1));
+    }
+
+    // At least two exponent digits, as printf writes
+    const ptrdiff_t exponent = k-1;
+    *dest++ = 'e';
+    *dest++ = exponent < 0 ? '-' : '+';
+    const size_t abs_exponent = exponent < 0 ? static_cast<size_t>(-exponent) : static_cast<size_t>(exponent);
+    if(abs_exponent < 10) *dest++ = '0';
+    return std::to_chars(dest, dest + std::numeric_limits<size_t>::digits10 + 1, abs_exponent).ptr;
+}
+
+/// Decimal exponent range of printf's %g fixed notation, when not given a precision
+inline constexpr ptrdiff_t GENERAL_MIN_FIXED_EXPONENT = -4;
+inline constexpr ptrdiff_t GENERAL_DEFAULT_PRECISION = 6;
+
+/// Lay out the digits of 0.d1d2...dn × 10^k, which are at dest+1 without trailing zeros, as printf's %g does
+inline char* layout_general(char* dest, size_t n, ptrdiff_t k, ptrdiff_t fixed_exponent_limit) noexcept {
+    if(k-1 >= GENERAL_MIN_FIXED_EXPONENT && k-1 < fixed_exponent_limit)
+        return layout_fixed(dest, n, k, static_cast<size_t>(std::max<ptrdiff_t>(static_cast<ptrdiff_t>(n) - k, 0)));
+    return layout_scientific(dest, n, k, n-1);
+}
+
+/// Lay out the digits of the integer d1d2...dn × 10^exponent, which are at dest+1, in the notations of write_float.
+/// Fixed notation keeps the decimal places given by the exponent, while the others drop trailing zeros.
+inline char* layout_scaled_decimal(char* dest, size_t n, ptrdiff_t exponent, FloatNotation notation) noexcept {
+    const bool is_zero = (n == 1 && dest[1] == '0');
+    if(notation == FloatNotation::Fixed){
+        const ptrdiff_t k = is_zero ? std::min<ptrdiff_t>(exponent, 0) + 1 : static_cast<ptrdiff_t>(n) + exponent;
+        return layout_fixed(dest, n, k, exponent < 0 ? static_cast<size_t>(-exponent) : 0);
+    }
+
+    const ptrdiff_t k = is_zero ? 1 : static_cast<ptrdiff_t>(n) + exponent;
+    while(n > 1 && dest[n] == '0') n--;
+    if(notation == FloatNotation::General) return layout_general(dest, n, k, GENERAL_DEFAULT_PRECISION);
+    return layout_scientific(dest, n, k, n-1);
+}
+
+}  // namespace KiCAS2
+
+#endif // KI_CAS_DIGIT_WRITING_H
@@ -1,21 +1,711 @@
 #include "ki_cas_native_float.h"
 
+#include "ki_cas_digit_writing.h"
+#include <algorithm>
 #include <cassert>
 #include <charconv>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <iterator>
+#include <limits>
+#include <vector>
 
 namespace KiCAS2 {
 
-void write_float(std::string& str, FloatingPoint val) {
+namespace {
+
+/// Limits of each formatted type, of which FloatingPoint is the widest
+template<typename Float> constexpr int PRECISION = std::numeric_limits<Float>::digits;
+template<typename Float> constexpr int MIN_EXPONENT = std::numeric_limits<Float>::min_exponent;
+template<typename Float> constexpr int MAX_EXPONENT = std::numeric_limits<Float>::max_exponent;
+
+/// Precision argument requesting the fewest digits which read back as the same value
+constexpr size_t SHORTEST = std::numeric_limits<size_t>::max();
+
+/// Unsigned integer with a fixed capacity, sufficient for the exact decimal conversion of any FloatingPoint
+class FixedBigInt {
+public:
+    // Scaled values never exceed the binary exponent range plus the precision,
+    // with a few limbs spare for the factors of 2 and 10 applied while generating digits
+    static constexpr size_t CAPACITY = (std::max(MAX_EXPONENT<FloatingPoint>, PRECISION<FloatingPoint> - MIN_EXPONENT<FloatingPoint>)
+                                        + PRECISION<FloatingPoint>) / 32 + 4;
+
+    void set(uint64_t val) noexcept {
+        size = 0;
+        for(; val != 0; val >>= 32) limbs[size++] = static_cast<uint32_t>(val);
+    }
+
+    void assign(const FixedBigInt& other) noexcept {
+        std::copy_n(other.limbs, other.size, limbs);
+        size = other.size;
+    }
+
+    bool isZero() const noexcept {
+        return size == 0;
+    }
+
+    bool isEven() const noexcept {
+        return size == 0 || (limbs[0] & 1) == 0;
+    }
+
+    size_t bitLength() const noexcept {
+        if(size == 0) return 0;
+        size_t top_bits = 0;
+        for(uint32_t top = limbs[size-1]; top != 0; top >>= 1) top_bits++;
+        return 32*(size-1) + top_bits;
+    }
+
+    void addSmall(uint32_t summand) noexcept {
+        uint64_t carry = summand;
+        for(size_t i = 0; carry != 0 && i < size; i++){
+            const uint64_t sum = limbs[i] + carry;
+            limbs[i] = static_cast<uint32_t>(sum);
+            carry = sum >> 32;
+        }
+        if(carry != 0) push(static_cast<uint32_t>(carry));
+    }
+
+    void mulSmall(uint32_t factor) noexcept {
+        uint64_t carry = 0;
+        for(size_t i = 0; i < size; i++){
+            const uint64_t product = static_cast<uint64_t>(limbs[i]) * factor + carry;
+            limbs[i] = static_cast<uint32_t>(product);
+            carry = product >> 32;
+        }
+        if(carry != 0) push(static_cast<uint32_t>(carry));
+    }
+
+    void mul(const FixedBigInt& factor) noexcept {
+        mul(factor.limbs, factor.size);
+    }
+
+    void mul(const uint32_t* factor, size_t factor_size) noexcept {
+        const size_t n = size;
+        assert(n + factor_size <= CAPACITY);
+        std::fill_n(limbs + n, factor_size, 0);
+
+        // From the most significant limb down, so each limb is read before the partial products reach it
+        for(size_t i = n; i-- > 0;){
+            const uint64_t limb = limbs[i];
+            limbs[i] = 0;
+            uint64_t carry = 0;
+            for(size_t j = 0; j < factor_size; j++){
+                const uint64_t product = limb * factor[j] + limbs[i+j] + carry;
+                limbs[i+j] = static_cast<uint32_t>(product);
+                carry = product >> 32;
+            }
+            for(size_t j = i + factor_size; carry != 0; j++){
+                const uint64_t sum = limbs[j] + carry;
+                limbs[j] = static_cast<uint32_t>(sum);
+                carry = sum >> 32;
+            }
+        }
+
+        size = n + factor_size;
+        trim();
+    }
+
+    void add(const FixedBigInt& summand) noexcept {
+        const size_t n = std::max(size, summand.size);
+        uint64_t carry = 0;
+        for(size_t i = 0; i < n; i++){
+            const uint64_t sum = static_cast<uint64_t>(limb(i)) + summand.limb(i) + carry;
+            limbs[i] = static_cast<uint32_t>(sum);
+            carry = sum >> 32;
+        }
+        size = n;
+        if(carry != 0) push(static_cast<uint32_t>(carry));
+    }
+
+    /// Set to the minuend minus this, which must not be negative
+    void subtractFrom(const FixedBigInt& minuend) noexcept {
+        assert(compare(minuend, *this) >= 0);
+        uint64_t borrow = 0;
+        for(size_t i = 0; i < minuend.size; i++){
+            const uint64_t subtrahend = limb(i) + borrow;
+            borrow = (minuend.limbs[i] < subtrahend);
+            limbs[i] = static_cast<uint32_t>(minuend.limbs[i] - subtrahend);
+        }
+        size = minuend.size;
+        trim();
+    }
+
+    void shiftLeft(size_t bits) noexcept {
+        if(size == 0) return;
+
+        const size_t limb_shift = bits / 32;
+        const unsigned bit_shift = bits % 32;
+        assert(size + limb_shift < CAPACITY);
+
+        if(bit_shift == 0){
+            for(size_t i = size; i-- > 0;) limbs[i + limb_shift] = limbs[i];
+        }else{
+            limbs[size + limb_shift] = limbs[size-1] >> (32 - bit_shift);
+            for(size_t i = size-1; i > 0; i--)
+                limbs[i + limb_shift] = (limbs[i] << bit_shift) | (limbs[i-1] >> (32 - bit_shift));
+            limbs[limb_shift] = limbs[0] << bit_shift;
+            size++;
+        }
+        std::fill_n(limbs, limb_shift, 0);
+        size += limb_shift;
+        trim();
+    }
+
+    void mulSmallPow5(size_t exponent) noexcept;
+    void mulPow5(size_t exponent) noexcept;
+
+    void mulPow10(size_t exponent) noexcept {
+        mulPow5(exponent);
+        shiftLeft(exponent);
+    }
+
+    const uint32_t* data() const noexcept {
+        return limbs;
+    }
+
+    size_t numLimbs() const noexcept {
+        return size;
+    }
+
+    /// Bits to shift by so the most significant limb has its top bit set
+    size_t normalisingShift() const noexcept {
+        return 32*size - bitLength();
+    }
+
+    /// Set to the remainder of division by a normalised divisor, returning the quotient, which must fit a limb
+    uint32_t divRem(const FixedBigInt& divisor) noexcept {
+        const size_t n = divisor.size;
+        if(size < n) return 0;
+        assert(size <= n+1);
+
+        // Underestimate from the leading limbs, which is off by at most a few for a normalised divisor
+        uint64_t leading = limbs[n-1];
+        if(size > n) leading |= static_cast<uint64_t>(limbs[n]) << 32;
+        uint32_t quotient = static_cast<uint32_t>(leading / (static_cast<uint64_t>(divisor.limbs[n-1]) + 1));
+        if(quotient != 0) subMul(divisor, quotient);
+
+        while(compare(*this, divisor) >= 0){
+            subMul(divisor, 1);
+            quotient++;
+        }
+
+        return quotient;
+    }
+
+    /// Return the sign of a - b
+    static int compare(const FixedBigInt& a, const FixedBigInt& b) noexcept {
+        if(a.size != b.size) return a.size < b.size ? -1 : 1;
+        for(size_t i = a.size; i-- > 0;)
+            if(a.limbs[i] != b.limbs[i]) return a.limbs[i] < b.limbs[i] ? -1 : 1;
+        return 0;
+    }
+
+    /// Return the sign of a + b - c
+    static int compareSum(const FixedBigInt& a, const FixedBigInt& b, const FixedBigInt& c) noexcept {
+        const size_t n = std::max(a.size, b.size);
+        if(n + 1 < c.size) return -1;
+        if(n > c.size) return 1;
+
+        // Compare from the most significant limb, carrying the difference down while it stays small
+        uint64_t difference = 0;
+        for(size_t i = c.size; i-- > 0;){
+            const uint64_t sum = static_cast<uint64_t>(a.limb(i)) + b.limb(i);
+            const uint64_t target = c.limbs[i] + difference;
+            if(sum > target) return 1;
+            difference = target - sum;
+            if(difference > 1) return -1;
+            difference <<= 32;
+        }
+
+        return difference == 0 ? 0 : -1;
+    }
+
+private:
+    uint32_t limbs[CAPACITY];
+    size_t size = 0;
+
+    uint32_t limb(size_t i) const noexcept {
+        return i < size ? limbs[i] : 0;
+    }
+
+    void push(uint32_t limb) noexcept {
+        assert(size < CAPACITY);
+        limbs[size++] = limb;
+    }
+
+    void trim() noexcept {
+        while(size != 0 && limbs[size-1] == 0) size--;
+    }
+
+    void subMul(const FixedBigInt& subtrahend, uint32_t factor) noexcept {
+        uint64_t borrow = 0;
+        for(size_t i = 0; i < subtrahend.size; i++){
+            const uint64_t product = static_cast<uint64_t>(subtrahend.limbs[i]) * factor + borrow;
+            const uint32_t low = static_cast<uint32_t>(product);
+            borrow = (product >> 32) + (limbs[i] < low);
+            limbs[i] -= low;
+        }
+        for(size_t i = subtrahend.size; borrow != 0; i++){
+            assert(i < size);
+            const uint32_t low = static_cast<uint32_t>(borrow);
+            borrow = (limbs[i] < low);
+            limbs[i] -= low;
+        }
+        trim();
+    }
+};
+
+/// Decimal exponents of FloatingPoint, with enough to spare for the digits beyond the smallest subnormal
+constexpr size_t MAX_DECIMAL_EXPONENT = std::max<size_t>(std::numeric_limits<FloatingPoint>::max_exponent10,
+    std::numeric_limits<FloatingPoint>::max_digits10 - std::numeric_limits<FloatingPoint>::min_exponent10 + 2);
+
+/// Powers of five which fit a limb are applied directly, and larger powers by binary powering
+constexpr uint32_t small_powers_of_five[] =
+    {1, 5, 25, 125, 625, 3125, 15625, 78125, 390625, 1953125, 9765625, 48828125, 244140625, 1220703125};
+constexpr size_t MAX_SMALL_POWER = std::size(small_powers_of_five) - 1;
+constexpr size_t FIRST_TABLE_BIT = 4;
+
+/// Limbs of 5^(2^i) for each bit i of an exponent from FIRST_TABLE_BIT up
+struct PowersOfFive {
+    static constexpr size_t NUM_ENTRIES = [](){
+        size_t bits = 0;
+        while((MAX_DECIMAL_EXPONENT >> bits) != 0) bits++;
+        return bits;
+    }();
+
+    std::vector<uint32_t> limbs;
+    size_t offsets[NUM_ENTRIES + 1];
+
+    PowersOfFive() {
+        FixedBigInt power, square;
+        power.set(1);
+        power.mulSmallPow5(size_t(1) << FIRST_TABLE_BIT);
+        for(size_t i = 0; i < NUM_ENTRIES; i++){
+            offsets[i] = limbs.size();
+            if(i < FIRST_TABLE_BIT) continue;
+            limbs.insert(limbs.end(), power.data(), power.data() + power.numLimbs());
+            if(i+1 == NUM_ENTRIES) break;
+            square.assign(power);
+            square.mul(power);
+            power.assign(square);
+        }
+        offsets[NUM_ENTRIES] = limbs.size();
+    }
+};
+
+void FixedBigInt::mulSmallPow5(size_t exponent) noexcept {
+    for(size_t remaining = exponent; remaining != 0;){
+        const size_t power = std::min(remaining, MAX_SMALL_POWER);
+        mulSmall(small_powers_of_five[power]);
+        remaining -= power;
+    }
+}
+
+void FixedBigInt::mulPow5(size_t exponent) noexcept {
+    mulSmallPow5(exponent & ((size_t(1) << FIRST_TABLE_BIT) - 1));
+
+    static const PowersOfFive table;
+    assert(exponent <= MAX_DECIMAL_EXPONENT);
+    for(size_t i = FIRST_TABLE_BIT; (exponent >> i) != 0; i++){
+        if(((exponent >> i) & 1) == 0) continue;
+        mul(table.limbs.data() + table.offsets[i], table.offsets[i+1] - table.offsets[i]);
+    }
+}
+
+/// Set mantissa × 2^exponent to the finite, positive value, where the mantissa has at most the precision of Float.
+/// Returns true if the value is a power of two whose lower neighbour is half as far as its upper neighbour.
+template<typename Float>
+bool decompose(FixedBigInt& mantissa, int* exponent, Float val) noexcept {
+    int e;
+    const Float fraction = std::frexp(val, &e);
+    *exponent = std::max(e, MIN_EXPONENT<Float>) - PRECISION<Float>;
+    Float integer = std::ldexp(fraction, e - *exponent);
+
+    if constexpr(PRECISION<Float> <= 64){
+        mantissa.set(static_cast<uint64_t>(integer));
+    }else{
+        // E.g. quadruple precision long double, split exactly into 32-bit pieces
+        static constexpr size_t NUM_PIECES = (PRECISION<Float> + 31) / 32;
+        const Float radix = std::ldexp(Float(1), 32);
+        uint32_t pieces[NUM_PIECES];
+        for(size_t i = 0; i < NUM_PIECES; i++){
+            const Float piece = std::fmod(integer, radix);
+            pieces[i] = static_cast<uint32_t>(piece);
+            integer = (integer - piece) / radix;
+        }
+        mantissa.set(0);
+        for(size_t i = NUM_PIECES; i-- > 0;){
+            mantissa.shiftLeft(32);
+            mantissa.addSmall(pieces[i]);
+        }
+    }
+
+    return fraction == Float(0.5) && e > MIN_EXPONENT<Float>;
+}
+
+/// Estimate k such that 10^(k-1) <= val < 10^k, which may be one too low
+int estimate_decimal_exponent(const FixedBigInt& mantissa, int exponent) noexcept {
+    static constexpr double LOG10_2 = 0.30102999566398114;
+    const int binary_exponent = exponent + static_cast<int>(mantissa.bitLength()) - 1;
+    return static_cast<int>(std::ceil(binary_exponent * LOG10_2 - 1e-10));
+}
+
+/// Digits produced by each pass over the exact values
+constexpr size_t DIGITS_PER_BLOCK = 9;
+constexpr uint32_t block_powers_of_ten[DIGITS_PER_BLOCK+1] =
+    {1, 10, 100, 1000, 10000, 100000, 1000000, 10000000, 100000000, 1000000000};
+
+/// Write a block of decimal digits, with leading zeros
+void write_block(char* dest, uint32_t block, size_t num_digits) noexcept {
+    for(size_t i = num_digits; i-- > 0;){
+        dest[i] = static_cast<char>('0' + block % 10);
+        block /= 10;
+    }
+}
+
+/// Number of trailing zero digits of a block, which is all of them for zero
+size_t block_trailing_zeros(uint32_t block) noexcept {
+    if(block == 0) return DIGITS_PER_BLOCK;
+    size_t zeros = 0;
+    for(; block % 10 == 0; block /= 10) zeros++;
+    return zeros;
+}
+
+/// Set r/s to the value divided by 10^k, scaled up by 2^extra_shift, where 10^(k-1) <= value < 10^k,
+/// unless the estimate of k is one too low. Returns the estimate of k.
+/// The unit is set to the scaled 2^max(exponent, 0), which is a unit in the last place for extra_shift = 1.
+int scale(FixedBigInt& r, FixedBigInt& s, FixedBigInt& unit, const FixedBigInt& mantissa, int exponent, size_t extra_shift) noexcept {
+    const int k = estimate_decimal_exponent(mantissa, exponent);
+    unit.set(1);
+    if(k >= 0){
+        unit.shiftLeft(static_cast<size_t>(std::max(exponent, 0)));
+        r.assign(mantissa);
+        r.shiftLeft(static_cast<size_t>(std::max(exponent, 0)) + extra_shift);
+        s.set(1);
+        s.shiftLeft(static_cast<size_t>(std::max(-exponent, 0)) + extra_shift);
+        s.mulPow10(static_cast<size_t>(k));
+    }else{
+        // Only values below one have a negative decimal exponent, so the binary exponent is negative too
+        unit.mulPow10(static_cast<size_t>(-k));
+        r.assign(unit);
+        r.mul(mantissa);
+        r.shiftLeft(extra_shift);
+        s.set(1);
+        s.shiftLeft(static_cast<size_t>(-exponent) + extra_shift);
+    }
+    return k;
+}
+
+/// Write the fewest digits d1d2...dn such that 0.d1d2...dn × 10^k reads back as the value,
+/// choosing the closest such digits with ties to even. Returns k.
+/// The digits are the shortest in the rounding interval, as in Steele & White's free-format algorithm,
+/// but the interval bounds are expanded a block of digits at a time with exact arithmetic.
+template<typename Float>
+int shortest_digits(char* dest, size_t* num_digits, Float val) noexcept {
+    FixedBigInt r, s, low, high;
+    int exponent;
+    const bool is_narrow_below = decompose(high, &exponent, val);
+    const bool include_bounds = high.isEven();
+
+    // r/s is the value, scaled by 2 (or 4 below a power of two) so half the gaps to the neighbours are integers
+    int k = scale(r, s, low, high, exponent, 1 + is_narrow_below);
+    high.assign(low);
+    high.shiftLeft(is_narrow_below);
+    high.add(r);
+    low.subtractFrom(r);
+
+    // The estimate may be one too low
+    const int high_comparison = FixedBigInt::compare(high, s);
+    if(high_comparison > 0 || (high_comparison == 0 && include_bounds)){
+        s.mulSmall(10);
+        k++;
+    }
+
+    // An excluded upper bound of exactly one has the expansion 0.999...
+    const bool is_high_one = (FixedBigInt::compare(high, s) == 0);
+
+    // A normalised divisor makes the quotient estimate of each block nearly exact
+    const size_t shift = s.normalisingShift();
+    r.shiftLeft(shift);
+    s.shiftLeft(shift);
+    low.shiftLeft(shift);
+    high.shiftLeft(shift);
+
+    // The low digits are written to dest, while the differences of the high and value digits from them are
+    // tracked as integers over the digits so far. Both stay at most one until the interval holds a candidate.
+    int high_minus_low = 0;
+    int val_minus_low = 0;
+    for(size_t n0 = 0;; n0 += DIGITS_PER_BLOCK){
+        low.mulSmall(block_powers_of_ten[DIGITS_PER_BLOCK]);
+        const uint32_t low_block = low.divRem(s);
+        r.mulSmall(block_powers_of_ten[DIGITS_PER_BLOCK]);
+        const uint32_t val_block = r.divRem(s);
+        uint32_t high_block = block_powers_of_ten[DIGITS_PER_BLOCK] - 1;
+        if(!is_high_one){
+            high.mulSmall(block_powers_of_ten[DIGITS_PER_BLOCK]);
+            high_block = high.divRem(s);
+        }
+
+        char high_digits[DIGITS_PER_BLOCK];
+        char val_digits[DIGITS_PER_BLOCK];
+        write_block(dest + n0, low_block, DIGITS_PER_BLOCK);
+        write_block(high_digits, high_block, DIGITS_PER_BLOCK);
+        write_block(val_digits, val_block, DIGITS_PER_BLOCK);
+        // Digits from which each expansion is exact, or past the block if it continues
+        const size_t low_exact_from =
+            low.isZero() ? DIGITS_PER_BLOCK - block_trailing_zeros(low_block) : DIGITS_PER_BLOCK + 1;
+        const size_t high_exact_from = (!is_high_one && high.isZero())
+                                       ? DIGITS_PER_BLOCK - block_trailing_zeros(high_block) : DIGITS_PER_BLOCK + 1;
+
+        for(size_t j = 1; j <= DIGITS_PER_BLOCK; j++){
+            const int low_digit = dest[n0+j-1] - '0';
+            high_minus_low = 10*high_minus_low + (high_digits[j-1] - '0') - low_digit;
+            val_minus_low = 10*val_minus_low + (val_digits[j-1] - '0') - low_digit;
+
+            // Candidates are the integers c with low < c × s / 10^n < high, including bounds where allowed
+            const int min_offset = !(include_bounds && j >= low_exact_from);
+            const int max_offset = high_minus_low - (!include_bounds && j >= high_exact_from);
+            if(min_offset > max_offset) continue;
+
+            // Round the value to n digits, with ties to even
+            int round_comparison;
+            if(j == DIGITS_PER_BLOCK){
+                round_comparison = FixedBigInt::compareSum(r, r, s);
+            }else{
+                const int next_digit = val_digits[j] - '0';
+                const bool is_rest_zero = r.isZero()
+                                          && std::all_of(val_digits + j + 1, val_digits + DIGITS_PER_BLOCK,
+                                                         [](char digit){ return digit == '0'; });
+                round_comparison = (next_digit != 5) ? (next_digit - 5) : !is_rest_zero;
+            }
+            const bool is_rounded_down_odd = (low_digit + val_minus_low) & 1;
+            int offset = val_minus_low + (round_comparison > 0 || (round_comparison == 0 && is_rounded_down_odd));
+            offset = std::clamp(offset, min_offset, max_offset);
+
+            // Add the offset to the low digits
+            size_t i = n0 + j;
+            for(int carry = offset; carry != 0;){
+                assert(i > 0);
+                const int digit = dest[--i] - '0' + carry;
+                dest[i] = static_cast<char>('0' + digit % 10);
+                carry = digit / 10;
+            }
+
+            *num_digits = n0 + j;
+            return k;
+        }
+    }
+}
+
+/// Number of digits to generate for 0.d1d2... × 10^k at a printf precision
+ptrdiff_t precise_num_digits(FloatNotation notation, size_t precision, int k) noexcept {
+    switch(notation){
+        case FloatNotation::Fixed: return static_cast<ptrdiff_t>(precision) + k;
+        case FloatNotation::Scientific: return static_cast<ptrdiff_t>(precision) + 1;
+        default: return static_cast<ptrdiff_t>(std::max<size_t>(precision, 1));
+    }
+}
+
+/// Write the digits d1d2...dn of 0.d1d2...dn × 10^k, correctly rounded with ties to even,
+/// with as many digits as the printf precision requires. Returns k.
+template<typename Float>
+int precise_digits(char* dest, size_t* num_digits, Float val, FloatNotation notation, size_t precision) noexcept {
+    FixedBigInt r, s, mantissa, unit;
+    int exponent;
+    decompose(mantissa, &exponent, val);
+    int k = scale(r, s, unit, mantissa, exponent, 0);
+
+    if(FixedBigInt::compare(r, s) >= 0){
+        s.mulSmall(10);
+        k++;
+    }
+
+    const size_t shift = s.normalisingShift();
+    r.shiftLeft(shift);
+    s.shiftLeft(shift);
+
+    const ptrdiff_t n = precise_num_digits(notation, precision, k);
+    for(ptrdiff_t i = 0; i < n; i += DIGITS_PER_BLOCK){
+        const size_t block_size = std::min<size_t>(DIGITS_PER_BLOCK, static_cast<size_t>(n - i));
+        r.mulSmall(block_powers_of_ten[block_size]);
+        write_block(dest + i, r.divRem(s), block_size);
+    }
+
+    // Digits beyond a negative count are all zero, so the value rounds down to zero
+    if(n < 0){
+        *num_digits = 0;
+        return k;
+    }
+
+    const int half_comparison = FixedBigInt::compareSum(r, r, s);
+    const bool is_last_digit_odd = (n != 0) && ((dest[n-1] - '0') & 1);
+    *num_digits = static_cast<size_t>(n);
+    if(half_comparison < 0 || (half_comparison == 0 && !is_last_digit_odd)) return k;
+
+    ptrdiff_t i = n;
+    while(i > 0 && dest[i-1] == '9') dest[--i] = '0';
+    if(i > 0){
+        dest[i-1]++;
+        return k;
+    }
+
+    // Every digit carried, so the value rounds up to a power of ten,
+    // and fixed notation gains a digit, which is the only digit when none were generated
+    if(notation == FloatNotation::Fixed){
+        if(n != 0) dest[n] = '0';
+        *num_digits = static_cast<size_t>(n) + 1;
+    }
+    dest[0] = '1';
+    return k + 1;
+}
+
+template<typename Float>
+char* write_finite_float(char* dest, Float val, FloatNotation notation, size_t precision) noexcept {
+    // Digits are written one past the destination, leaving a slot for the decimal point
+    size_t n;
+    int k;
+    if(val == 0){
+        dest[1] = '0';
+        n = 1;
+        k = 1;
+        if(precision != SHORTEST && notation == FloatNotation::Scientific){
+            write_zeros(dest + 2, precision);
+            n += precision;
+        }
+    }else if(precision == SHORTEST
+              && val == std::floor(val)
+              && val < std::ldexp(Float(1), std::min(PRECISION<Float>, 64))){
+        // Integers below 2^PRECISION are exact, so no shorter decimal reads back as the same value
+        n = static_cast<size_t>(std::to_chars(dest+1, dest+32, static_cast<uint64_t>(val)).ptr - (dest+1));
+        k = static_cast<int>(n);
+        if(notation != FloatNotation::Fixed) while(n > 1 && dest[n] == '0') n--;
+    }else if(precision == SHORTEST){
+        k = shortest_digits(dest+1, &n, val);
+    }else{
+        k = precise_digits(dest+1, &n, val, notation, precision);
+    }
+
+    if(notation == FloatNotation::General){
+        // Trailing zeros are only generated for a precision, and %g removes them
+        while(n > 1 && dest[n] == '0') n--;
+        const ptrdiff_t fixed_exponent_limit =
+            (precision == SHORTEST) ? GENERAL_DEFAULT_PRECISION : static_cast<ptrdiff_t>(std::max<size_t>(precision, 1));
+        return layout_general(dest, n, k, fixed_exponent_limit);
+    }
+
+    if(precision == SHORTEST){
+        if(notation == FloatNotation::Fixed){
+            // Units are significant in fixed notation, so the closest representation of that length is the integer itself
+            if(k > static_cast<int>(n)) k = precise_digits(dest+1, &n, val, notation, 0);
+            return layout_fixed(dest, n, k, static_cast<size_t>(std::max<ptrdiff_t>(ptrdiff_t(n) - k, 0)));
+        }
+        return layout_scientific(dest, n, k, n-1);
+    }
+
+    if(notation == FloatNotation::Fixed) return layout_fixed(dest, n, k, precision);
+    return layout_scientific(dest, n, k, precision);
+}
+
+template<typename Float>
+char* write_float(char* dest, [[maybe_unused]] char* end, Float val, FloatNotation notation, size_t precision) noexcept {
 #if !defined(__GNUC__) || __GNUC__ > 8
-    constexpr size_t max_digits = 64;
-    char buffer[max_digits];
-    const std::to_chars_result result = std::to_chars(buffer, buffer+max_digits, val, std::chars_format::general);
-    assert(result.ec == std::errc());
-    str.append(buffer, result.ptr - buffer);
-#else
-    // Older GCC versions don't implement std::to_chars for floats
-    str += std::to_string(val);
+    // The library's shortest formatting is table driven, and much faster than the exact bignum digits
+    if(precision == SHORTEST){
+        const std::chars_format format = (notation == FloatNotation::Fixed) ? std::chars_format::fixed :
+                                         (notation == FloatNotation::Scientific) ? std::chars_format::scientific :
+                                         std::chars_format::general;
+        const std::to_chars_result result = std::to_chars(dest, end, val, format);
+        assert(result.ec == std::errc());
+        return result.ptr;
+    }
 #endif
+
+    if(std::signbit(val)) *dest++ = '-';
+    if(std::isnan(val)) return std::copy_n("nan", 3, dest);
+    if(std::isinf(val)) return std::copy_n("inf", 3, dest);
+    return write_finite_float(dest, std::abs(val), notation, precision);
+}
+
+/// Upper bound on the chars write_float may use, including the slot for the decimal point
+template<typename Float>
+size_t float_str_upperbound(Float val, FloatNotation notation, size_t precision) noexcept {
+    static constexpr size_t PLUS_ONE_FOR_SIGN = 1;
+    static constexpr size_t PLUS_ONE_FOR_POINT_SLOT = 1;
+    static constexpr size_t PLUS_TWO_FOR_LEADING_ZERO_AND_POINT = 2;
+    static constexpr size_t PLUS_ONE_FOR_CARRY = 1;
+    static constexpr size_t FIXED_OVERHEAD =
+        PLUS_ONE_FOR_SIGN + PLUS_ONE_FOR_POINT_SLOT + PLUS_TWO_FOR_LEADING_ZERO_AND_POINT + PLUS_ONE_FOR_CARRY;
+
+    // Shortest digits are generated a whole block at a time, before trimming
+    static constexpr size_t SHORTEST_DIGITS =
+        (std::numeric_limits<Float>::max_digits10 + DIGITS_PER_BLOCK - 1) / DIGITS_PER_BLOCK * DIGITS_PER_BLOCK;
+
+    if(notation != FloatNotation::Fixed){
+        // Sign, decimal point and slot, exponent marker and sign, with some to spare
+        static constexpr size_t OVERHEAD = 16;
+        static constexpr size_t MAX_EXPONENT_DIGITS = std::numeric_limits<int>::digits10 + 1;
+        const size_t significant_digits = (precision == SHORTEST) ? SHORTEST_DIGITS : precision + 1;
+        return significant_digits + MAX_EXPONENT_DIGITS + OVERHEAD;
+    }
+
+    // For 2^(e-1) <= |val| < 2^e, the decimal exponent is at most |e| × log10(2) + 1 in magnitude,
+    // which bounds both the integer digits and the leading zeros of the fraction
+    int binary_exponent = 0;
+    if(std::isfinite(val)) std::frexp(val, &binary_exponent);
+    const size_t max_abs_decimal_exponent = static_cast<size_t>(std::abs(binary_exponent)) * 30103 / 100000 + 1;
+    if(precision == SHORTEST) return SHORTEST_DIGITS + max_abs_decimal_exponent + FIXED_OVERHEAD;
+    return precision + max_abs_decimal_exponent + FIXED_OVERHEAD;
+}
+
+template<typename Float>
+void append_float(std::string& str, Float val, FloatNotation notation, size_t precision) {
+    const size_t start_index = str.size();
+    str.resize(start_index + float_str_upperbound(val, notation, precision));
+    const char* end = write_float(str.data() + start_index, str.data() + str.size(), val, notation, precision);
+    str.resize(end - str.data());
+}
+
+template<typename Float>
+void append_float(OutputBuilder& out, Float val, FloatNotation notation, size_t precision) {
+    const size_t size = float_str_upperbound(val, notation, precision);
+    char* buffer = out.reserve(size);
+    const char* end = write_float(buffer, buffer + size, val, notation, precision);
+    out.commit(end - buffer);
+}
+
+}  // namespace
+
+void write_float(std::string& str, FloatingPoint val, FloatNotation notation) {
+    append_float(str, val, notation, SHORTEST);
+}
+
+void write_float(OutputBuilder& out, FloatingPoint val, FloatNotation notation) {
+    append_float(out, val, notation, SHORTEST);
+}
+
+void write_float(std::string& str, FloatingPoint val, FloatNotation notation, size_t precision) {
+    append_float(str, val, notation, precision);
+}
+
+void write_float(OutputBuilder& out, FloatingPoint val, FloatNotation notation, size_t precision) {
+    append_float(out, val, notation, precision);
+}
+
+void write_float(std::string& str, double val, FloatNotation notation) {
+    append_float(str, val, notation, SHORTEST);
+}
+
+void write_float(OutputBuilder& out, double val, FloatNotation notation) {
+    append_float(out, val, notation, SHORTEST);
+}
+
+void write_float(std::string& str, double val, FloatNotation notation, size_t precision) {
+    append_float(str, val, notation, precision);
+}
+
+void write_float(OutputBuilder& out, double val, FloatNotation notation, size_t precision) {
+    append_float(out, val, notation, precision);
 }
 
 FloatingPoint strdecimal2floatingpoint(std::string_view str) noexcept {
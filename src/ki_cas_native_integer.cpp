@@ -1,9 +1,11 @@
 #include "ki_cas_native_integer.h"
 
+#include "ki_cas_wide_integer.h"
+#include <array>
 #include <cassert>
 #include <charconv>
-#include <cmath>
-#include <flint/ulong_extras.h>
+#include <cstdint>
+#include <limits>
 
 #if __cplusplus >= 202302L
 #include <stdckdint.h>
@@ -43,67 +45,371 @@ size_t knownfit_sub(size_t a, size_t b) noexcept {
     return a - b;
 }
 
+static constexpr size_t WORD_BITS = std::numeric_limits<size_t>::digits;
+
+/// Whether base^power <= bound, by multiplications which stop before exceeding the bound
+static constexpr bool pow_at_most(uint64_t base, size_t power, uint64_t bound) noexcept {
+    uint64_t result = 1;
+    for(size_t i = 0; i < power; i++){
+        if(base != 0 && result > bound / base) return false;
+        result *= base;
+    }
+    return true;
+}
+
+/// The largest base whose power fits in a word for each power below WORD_BITS, found by bisection at compile time
+static constexpr std::array<size_t, WORD_BITS> max_pow_bases() noexcept {
+    std::array<size_t, WORD_BITS> bases = {};
+    bases[0] = bases[1] = std::numeric_limits<size_t>::max();
+    for(size_t power = 2; power < WORD_BITS; power++){
+        size_t low = 1;  // Fits
+        size_t high = size_t(1) << (WORD_BITS / power + 1);  // Does not fit
+        while(high - low > 1){
+            const size_t mid = low + (high - low) / 2;
+            if(pow_at_most(mid, power, std::numeric_limits<size_t>::max())) low = mid;
+            else high = mid;
+        }
+        bases[power] = low;
+    }
+    return bases;
+}
+
+static constexpr std::array<size_t, WORD_BITS> MAX_POW_BASES = max_pow_bases();
+static_assert(MAX_POW_BASES[2] == std::numeric_limits<size_t>::max() >> (WORD_BITS / 2));
+static_assert(MAX_POW_BASES[WORD_BITS - 1] == 2);
+
+/// Binary powering without overflow checks, for a power known to fit.
+/// Squaring stops at the top set bit of the power, so no intermediate value wraps.
+static size_t pow_unchecked(size_t base, size_t power) noexcept {
+    size_t result = (power & 1) ? base : 1;
+    while(power >>= 1){
+        base *= base;
+        result *= (power & 1) ? base : 1;
+    }
+    return result;
+}
+
+/// Floor of the root of a 64-bit word by bisection, for building tables at compile time
+static constexpr uint64_t floor_root_bisect(uint64_t arg, size_t power) noexcept {
+    uint64_t low = 0;  // low^power <= arg
+    uint64_t high = uint64_t(1) << (64 / power + 1);  // high^power > arg
+    while(high - low > 1){
+        const uint64_t mid = low + (high - low) / 2;
+        if(pow_at_most(mid, power, arg)) low = mid;
+        else high = mid;
+    }
+    return low;
+}
+
+// The square and cube roots are found on a 64-bit word normalised by a left shift which is a multiple of the power,
+// so that its leading bits index a table of reciprocal roots. Newton's iteration for the reciprocal root
+// needs no division, and the root follows by multiplying back by the argument. The fixed point
+// arithmetic truncates, so a final correction in both directions makes the floor exact whatever the rounding was.
+static constexpr uint64_t MAX_SQRT_64 = floor_root_bisect(std::numeric_limits<uint64_t>::max(), 2);
+static constexpr uint64_t MAX_CBRT_64 = floor_root_bisect(std::numeric_limits<uint64_t>::max(), 3);
+
+/// 1/sqrt(t) with 30 fractional bits, at the midpoint t of each bucket [i/1024, (i+1)/1024) for t in [1/4, 1)
+static constexpr std::array<uint32_t, 768> rsqrt_seeds() noexcept {
+    std::array<uint32_t, 768> seeds = {};
+    for(uint64_t i = 256; i < 1024; i++)  // 2^30 * sqrt(2048 / (2i+1)) = 2^4 * sqrt(2^63 / (2i+1))
+        seeds[i - 256] = static_cast<uint32_t>(floor_root_bisect((uint64_t(1) << 63) / (2*i + 1), 2) << 4);
+    return seeds;
+}
+
+/// 1/cbrt(t) with 30 fractional bits, at the midpoint t of each bucket [i/128, (i+1)/128) for t in [1/4, 2)
+static constexpr std::array<uint32_t, 224> rcbrt_seeds() noexcept {
+    std::array<uint32_t, 224> seeds = {};
+    for(uint64_t i = 32; i < 256; i++)  // 2^30 * cbrt(256 / (2i+1)) = 2^12 * cbrt(2^62 / (2i+1))
+        seeds[i - 32] = static_cast<uint32_t>(floor_root_bisect((uint64_t(1) << 62) / (2*i + 1), 3) << 12);
+    return seeds;
+}
+
+static constexpr std::array<uint32_t, 768> RSQRT_SEEDS = rsqrt_seeds();
+static constexpr std::array<uint32_t, 224> RCBRT_SEEDS = rcbrt_seeds();
+
+/// Number of leading zeros of a nonzero word once widened to 64 bits
+static size_t leading_zeros_64(size_t arg) noexcept {
+    return count_leading_zeros(arg) + (64 - WORD_BITS);
+}
+
+static size_t floor_sqrt(size_t arg) noexcept {
+    if(arg == 0) return 0;
+
+    // Normalised to [2^62, 2^64), so t = top / 2^32 is in [1/4, 1)
+    const size_t shift = leading_zeros_64(arg) & ~size_t(1);
+    const uint64_t normalised = static_cast<uint64_t>(arg) << shift;
+    const uint64_t top = normalised >> 32;
+
+    // y <- y(3 - t*y^2)/2 once takes the reciprocal root from 10 bits to about 19 bits
+    uint64_t recip = RSQRT_SEEDS[(normalised >> 54) - 256];
+    const uint64_t error = (uint64_t(3) << 60) - top * ((recip * recip) >> 32);
+    recip = (recip * (error >> 30)) >> 31;
+
+    // sqrt(normalised) = 2^32 * t * y, to within about 2^13, and a Newton step on the signed remainder d
+    // by d/(2*root) = d*y/2^63 brings it within 1
+    uint64_t root = (top * recip) >> 30;
+    if(root > MAX_SQRT_64) root = MAX_SQRT_64;
+    const int64_t remainder = static_cast<int64_t>(normalised - root * root);
+    root += static_cast<uint64_t>((remainder * static_cast<int64_t>(recip >> 16)) >> 47);
+
+    if(root > MAX_SQRT_64) root = MAX_SQRT_64;
+    while(root * root > normalised) root--;
+    while(root < MAX_SQRT_64 && (root + 1) * (root + 1) <= normalised) root++;
+
+    return static_cast<size_t>(root >> (shift / 2));
+}
+
+static size_t floor_cbrt(size_t arg) noexcept {
+    if(arg == 0) return 0;
+
+    // Normalised to [2^61, 2^64), so t = top / 2^31 is in [1/4, 2)
+    const size_t shift = leading_zeros_64(arg) / 3 * 3;
+    const uint64_t normalised = static_cast<uint64_t>(arg) << shift;
+    const uint64_t top = normalised >> 32;
+
+    // y <- y(4/3 - (t/3)*y^3) twice takes the reciprocal root from 8 bits to about 27 bits.
+    // Multiplying y^2 by (t/3)*y, which are independent, keeps two multiplications off each step's critical path.
+    const uint64_t third = (top * 0x55555556) >> 32;
+    uint64_t recip = RCBRT_SEEDS[(normalised >> 56) - 32];
+    for(size_t i = 0; i < 2; i++){
+        const uint64_t scaled_cube = ((recip * recip) >> 32) * ((third * recip) >> 31);
+        const uint64_t error = ((uint64_t(1) << 60) / 3) - scaled_cube;
+        recip = (recip * (error >> 28)) >> 30;
+    }
+
+    // cbrt(normalised) = 2^21 * t * y^2, which is now within about 2^-6 before truncation
+    uint64_t root = (top * ((recip * recip) >> 32)) >> 38;
+
+    if(root > MAX_CBRT_64) root = MAX_CBRT_64;
+    while(root * root * root > normalised) root--;
+    while(root < MAX_CBRT_64 && (root + 1) * (root + 1) * (root + 1) <= normalised) root++;
+
+    return static_cast<size_t>(root >> (shift / 3));
+}
+
+// A power of at least 4 leaves a root of at most WORD_BITS/4 bits, so it is estimated as 2^(log2(arg)/power) from
+// interpolated tables of log2 and exp2 with 24 fractional bits, which is within about 2^-18 of the real root.
+// Every step of the estimate is monotonic in the argument, so if the rounded estimate is r or r+1 at both ends of
+// [r^power, (r+1)^power), it is r or r+1 throughout, and one comparison of its power with the argument gives the floor.
+// The tests confirm those ends exhaustively, since there are only MAX_POW_BASES[power] of them for each power.
+
+/// log2(1 + m/256) with 24 fractional bits by the bitwise logarithm: squaring a mantissa in [1, 2)
+/// doubles its logarithm, so whether each square reaches 2 gives the next bit
+static constexpr std::array<uint32_t, 257> log2_table() noexcept {
+    std::array<uint32_t, 257> table = {};
+    for(uint64_t m = 0; m < 256; m++){
+        uint64_t mantissa = (256 + m) << 23;  // 31 fractional bits
+        uint32_t log = 0;
+        for(size_t bit = 0; bit < 24; bit++){
+            mantissa = (mantissa * mantissa) >> 31;
+            log <<= 1;
+            if(mantissa >= (uint64_t(1) << 32)){
+                log |= 1;
+                mantissa >>= 1;
+            }
+        }
+        table[m] = log;
+    }
+    table[256] = uint32_t(1) << 24;
+    return table;
+}
+
+/// 2^(m/256) with 30 fractional bits, as products of the repeated square roots 2^(1/2), 2^(1/4), ..., 2^(1/256)
+static constexpr std::array<uint32_t, 257> exp2_table() noexcept {
+    uint64_t roots[8] = {};
+    uint64_t root = uint64_t(2) << 30;
+    for(size_t k = 0; k < 8; k++) roots[k] = root = floor_root_bisect(root << 30, 2);
+
+    std::array<uint32_t, 257> table = {};
+    for(size_t m = 0; m < 256; m++){
+        uint64_t val = uint64_t(1) << 30;
+        for(size_t k = 0; k < 8; k++) if(m & (128 >> k)) val = (val * roots[k]) >> 30;
+        table[m] = static_cast<uint32_t>(val);
+    }
+    table[256] = uint32_t(1) << 31;
+    return table;
+}
+
+/// ceil(2^32 / power), so that dividing a logarithm by the power is a multiplication
+static constexpr std::array<uint64_t, WORD_BITS> reciprocal_table() noexcept {
+    std::array<uint64_t, WORD_BITS> table = {};
+    for(uint64_t power = 1; power < WORD_BITS; power++) table[power] = ((uint64_t(1) << 32) + power - 1) / power;
+    return table;
+}
+
+static constexpr std::array<uint32_t, 257> LOG2_TABLE = log2_table();
+static constexpr std::array<uint32_t, 257> EXP2_TABLE = exp2_table();
+static constexpr std::array<uint64_t, WORD_BITS> RECIPROCALS = reciprocal_table();
+
+/// The rounded root for a power of at least 4 and below WORD_BITS, which is the floor or one above it.
+/// It does not exceed MAX_POW_BASES, so it may be raised to the power without overflow.
+static size_t nrt_estimate(size_t arg, size_t power) noexcept {
+    assert(arg >= 2 && power >= 4 && power < WORD_BITS);
+
+    // log2(arg) with 24 fractional bits, interpolating on the 24 bits after the leading bit
+    const size_t leading_zeros = count_leading_zeros(arg);
+    const uint64_t mantissa = static_cast<uint64_t>((arg << leading_zeros) >> (WORD_BITS - 25)) & 0xFFFFFF;
+    const uint64_t log_low = LOG2_TABLE[mantissa >> 16];
+    const uint64_t log_frac = log_low + (((LOG2_TABLE[(mantissa >> 16) + 1] - log_low) * (mantissa & 0xFFFF)) >> 16);
+    const uint64_t log_arg = (static_cast<uint64_t>(WORD_BITS - 1 - leading_zeros) << 24) + log_frac;
+
+    // 2^(log2(arg)/power), rounded from 30 fractional bits
+    const uint64_t log_root = (log_arg * RECIPROCALS[power]) >> 32;
+    const uint64_t exp_index = (log_root >> 16) & 0xFF;
+    const uint64_t exp_low = EXP2_TABLE[exp_index];
+    const uint64_t exp_frac = exp_low + (((EXP2_TABLE[exp_index + 1] - exp_low) * (log_root & 0xFFFF)) >> 16);
+    const size_t root = static_cast<size_t>(((exp_frac << (log_root >> 24)) + (uint64_t(1) << 29)) >> 30);
+
+    return root < MAX_POW_BASES[power] ? root : MAX_POW_BASES[power];
+}
+
 bool ckd_sqrt(size_t* result, size_t arg) noexcept {
-    // Adequate precision confirmed for 64-bit numbers, see tests
-    *result = static_cast<size_t>(std::sqrt(static_cast<double>(arg)));
+    *result = floor_sqrt(arg);
     return (*result) * (*result) != arg;
 }
 
 bool ckd_cbrt(size_t* result, size_t arg) noexcept {
-    // Adequate precision confirmed for 64-bit numbers, see tests
-    *result = n_cbrt(arg);
+    *result = floor_cbrt(arg);
     return (*result) * (*result) * (*result) != arg;
 }
 
 bool ckd_nrt(size_t* result, size_t arg, size_t power) noexcept {
     assert(power >= 4);
+    if(arg < 2 || power >= WORD_BITS){
+        *result = (arg != 0);
+        return arg > 1;
+    }
 
-    const auto fp_result = std::pow(arg, 1.0/static_cast<double>(power));
-    *result = static_cast<size_t>(fp_result + 0.5);
+    const size_t root = nrt_estimate(arg, power);
+    const size_t raised = pow_unchecked(root, power);
+    *result = root - (raised > arg);
+    assert(knownfit_pow(*result, power) <= arg);
+    assert(*result == MAX_POW_BASES[power] || knownfit_pow(*result + 1, power) > arg);
+    return raised != arg;
+}
 
-    constexpr double tol = 1e-11;
-    const auto error = fp_result - *result;
-    if(error > tol || error < -tol) return true;
+bool ckd_pow(size_t* result, size_t base, size_t power) noexcept {
+    assert(base != 0 || power != 0);  // 0^0 is not generally defined
+    if(power >= WORD_BITS){
+        *result = base;
+        return base > 1;
+    }
+    if(base > MAX_POW_BASES[power]) return true;
 
-    // EVENTUALLY: it would be nice if we could rely on the tolerance only,
-    //             but the search space to confirm no impure roots is enormous.
-    return knownfit_pow(*result, power) != arg;
+    *result = pow_unchecked(base, power);
+    return false;
 }
 
-static size_t ckd_pow_helper(bool& overflowed, size_t base, size_t power) noexcept {
-    if (power == 0) return 1;
-    if (power == 1) return base;
+size_t knownfit_pow(size_t base, size_t power) noexcept {
+    assert(base != 0 || power != 0);  // 0^0 is not generally defined
+    if(power >= WORD_BITS){
+        assert(base <= 1);
+        return base;
+    }
+    assert(base <= MAX_POW_BASES[power]);
+
+    return pow_unchecked(base, power);
+}
 
-    const size_t tmp = ckd_pow_helper(overflowed, base, power/2);
-    if(overflowed) return 0;
+// A perfect power is found by taking roots for each prime exponent in turn, so that the exponents multiply to the largest.
+// Squares, cubes, and 5th and 7th powers are first screened by their residues modulo a few small numbers,
+// and by whether their trailing zeros are a multiple of the prime, which between them pass about 1 in 50 of other values.
+// A larger prime leaves a root of at most 56, so every such power fits in a small table which is probed once.
 
-    size_t result;
-    if(power%2 == 0){
-        overflowed = ckd_mul(&result, tmp, tmp);
-    }else{
-        overflowed = ckd_mul(&result, tmp, tmp);
-        if(!overflowed) overflowed = ckd_mul(&result, base, result);
+/// Bit r is set if r is a prime'th power residue modulo the modulus
+template<size_t prime, size_t modulus>
+static constexpr uint64_t RESIDUE_MASK = [](){
+    static_assert(modulus <= 64);
+    uint64_t mask = 0;
+    for(uint64_t x = 0; x < modulus; x++){
+        uint64_t residue = 1;
+        for(size_t i = 0; i < prime; i++) residue = residue * x % modulus;
+        mask |= uint64_t(1) << residue;
     }
+    return mask;
+}();
 
-    return result;
+/// Whether arg may be a perfect power of the prime, by its trailing zeros and residues. False positives are possible.
+template<size_t prime, size_t... moduli>
+static bool may_be_prime_power(size_t arg) noexcept {
+    return count_trailing_zeros(arg) % prime == 0 && (((RESIDUE_MASK<prime, moduli> >> (arg % moduli)) & 1) && ...);
 }
 
-bool ckd_pow(size_t* result, size_t base, size_t power) noexcept {
-    assert(base != 0 || power != 0);  // 0^0 is not generally defined
-    bool overflowed = false;
-    *result = ckd_pow_helper(overflowed, base, power);
-    return overflowed;
+/// Take the root if arg is a perfect power of a prime from 2 to 7, and return true, or leave arg and return false
+static bool take_small_prime_root(size_t* arg, size_t prime) noexcept {
+    size_t root;
+    switch(prime){
+        case 2: if(!may_be_prime_power<2, 64, 63, 55>(*arg) || ckd_sqrt(&root, *arg)) return false; break;
+        case 3: if(!may_be_prime_power<3, 63, 37, 19>(*arg) || ckd_cbrt(&root, *arg)) return false; break;
+        case 5: if(!may_be_prime_power<5, 25, 41, 31>(*arg) || ckd_nrt(&root, *arg, 5)) return false; break;
+        case 7: if(!may_be_prime_power<7, 49, 43, 29>(*arg) || ckd_nrt(&root, *arg, 7)) return false; break;
+        default: assert(false); return false;
+    }
+
+    *arg = root;
+    return true;
 }
 
-size_t knownfit_pow(size_t base, size_t power) noexcept {
-    #ifndef NDEBUG
-    size_t result;
-    const bool overflow = ckd_pow(&result, base, power);
-    assert(overflow == false);
-    return result;
-    #else
-    return n_pow(base, power);
-    #endif
+struct LargePrimePower {
+    size_t value;  // Zero for an empty slot
+    uint8_t base;
+    uint8_t prime;
+};
+
+static constexpr size_t LARGE_PRIME_POWER_SLOTS = 256;
+
+static constexpr size_t large_prime_power_slot(size_t value) noexcept {
+    return static_cast<size_t>(static_cast<uint64_t>(value) * 0x9E3779B97F4A7C15uLL >> 56);
+}
+
+/// Every base^prime which fits in a word for a prime of at least 11, open addressed by value
+static constexpr std::array<LargePrimePower, LARGE_PRIME_POWER_SLOTS> large_prime_powers() noexcept {
+    std::array<LargePrimePower, LARGE_PRIME_POWER_SLOTS> table = {};
+    for(size_t prime = 11; prime < WORD_BITS; prime += 2){
+        bool is_prime = true;
+        for(size_t factor = 3; factor * factor <= prime; factor += 2) is_prime &= (prime % factor != 0);
+        if(!is_prime) continue;
+
+        for(size_t base = 2; base <= MAX_POW_BASES[prime]; base++){
+            size_t value = 1;
+            for(size_t i = 0; i < prime; i++) value *= base;
+
+            size_t slot = large_prime_power_slot(value);
+            while(table[slot].value != 0) slot = (slot + 1) % LARGE_PRIME_POWER_SLOTS;
+            table[slot] = {value, static_cast<uint8_t>(base), static_cast<uint8_t>(prime)};
+        }
+    }
+    return table;
+}
+
+static constexpr std::array<LargePrimePower, LARGE_PRIME_POWER_SLOTS> LARGE_PRIME_POWERS = large_prime_powers();
+
+size_t is_perfect_power(size_t* base, size_t arg) noexcept {
+    *base = arg;
+    if(arg < 4) return 1;
+
+    // A power of 2 is decided by its trailing zeros alone
+    const size_t zeros = count_trailing_zeros(arg);
+    if((arg >> zeros) == 1){
+        *base = 2;
+        return zeros;
+    }
+
+    // Exhausting each prime in turn leaves a base which is no power of it, and taking later roots cannot make it one
+    size_t exponent = 1;
+    for(const size_t prime : {2, 3, 5, 7}){
+        while(*base >= (size_t(1) << prime) && take_small_prime_root(base, prime)) exponent *= prime;
+    }
+
+    // What remains is no square, cube, or 5th or 7th power, so its base from the table is not a perfect power either
+    for(size_t slot = large_prime_power_slot(*base);; slot = (slot + 1) % LARGE_PRIME_POWER_SLOTS){
+        const LargePrimePower& entry = LARGE_PRIME_POWERS[slot];
+        if(entry.value == *base){
+            *base = entry.base;
+            return exponent * entry.prime;
+        }
+        if(entry.value == 0) return exponent;
+    }
 }
 
 void write_native_int(std::string& str, size_t val) {
@@ -114,6 +420,14 @@ void write_native_int(std::string& str, size_t val) {
     str.append(buffer, result.ptr - buffer);
 }
 
+void write_native_int(OutputBuilder& out, size_t val) {
+    constexpr size_t max_digits = std::numeric_limits<size_t>::digits10 + 1;
+    char* buffer = out.reserve(max_digits);
+    const std::to_chars_result result = std::to_chars(buffer, buffer + max_digits, val);
+    assert(result.ec == std::errc());
+    out.commit(result.ptr - buffer);
+}
+
 bool ckd_str2int(size_t* result, std::string_view str) noexcept {
     assert(!str.empty());
     #ifndef NDEBUG
@@ -1,35 +1,13 @@
 #include "ki_cas_native_rational.h"
 
+#include "ki_cas_canonical_hash.h"
+#include "ki_cas_digit_writing.h"
 #include "ki_cas_native_integer.h"
+#include "ki_cas_wide_integer.h"
+#include <algorithm>
 #include <cassert>
+#include <cstring>
 #include <limits>
-#include <numeric>
-
-#if !defined(__x86_64__) && !defined(__aarch64__) && !defined(_WIN64)  // 32-bit
-static_assert(sizeof(size_t)*8 == 32);
-#include <cstdint>
-#endif
-
-#if defined(_MSC_VER) && defined(_M_ARM64)  // 64-bit ARM MSVC
-// MSVC on arm64 does not have any way to multiply 128-bit numbers using intrinsics.
-// We would rather create this function than include boost_multiprecision.
-inline uint64_t _umul128(uint64_t a, uint64_t b, uint64_t* result_high) {
-    uint64_t a_lo = static_cast<uint32_t>(a);
-    uint64_t a_hi = a >> 32;
-    uint64_t b_lo = static_cast<uint32_t>(b);
-    uint64_t b_hi = b >> 32;
-
-    uint64_t p0 = a_lo * b_lo;
-    uint64_t p1 = a_lo * b_hi;
-    uint64_t p2 = a_hi * b_lo;
-    uint64_t p3 = a_hi * b_hi;
-
-    uint64_t mid = (p0 >> 32) + static_cast<uint32_t>(p1) + static_cast<uint32_t>(p2);
-
-    *result_high = p3 + (p1 >> 32) + (p2 >> 32) + (mid >> 32);
-    return (p0 & 0xffffffffull) | (mid << 32);
-}
-#endif
 
 namespace KiCAS2 {
 
@@ -194,7 +172,7 @@ bool operator<=(NativeRational a, NativeRational b) noexcept {
 
 void NativeRational::reduceInPlace() noexcept {
     assert(den != 0);
-    const size_t gcd = std::gcd(num, den);
+    const size_t gcd = binary_gcd(num, den);
     assert(gcd != 0);
     if(gcd != 1){
         num /= gcd;
@@ -207,93 +185,72 @@ NativeRational NativeRational::reciprocal() const noexcept {
     return NativeRational(den, num);
 }
 
-bool ckd_mul(NativeRational* result, NativeRational a, size_t b) noexcept {
-    result->den = a.den;
-    if(ckd_mul(&result->num, a.num, b) == false) return false;
+/// Set result to (a_num*b_num) / (a_den*b_den), reducing only as far as required to fit.
+/// Returns true if the fully reduced product overflows.
+static bool ckd_mul_reduced(NativeRational* result, size_t a_num, size_t a_den, size_t b_num, size_t b_den) noexcept {
+    size_t num_high;
+    size_t den_high;
+    result->num = mul_wide(a_num, b_num, &num_high);
+    result->den = mul_wide(a_den, b_den, &den_high);
+    if((num_high | den_high) == 0) return false;
 
-    // Resist expanding if possible
-    const size_t gcd_a_den_b = std::gcd(a.den, b);
-    if(gcd_a_den_b != 1){
-        b /= gcd_a_den_b;
-        result->den /= gcd_a_den_b;
-        if(ckd_mul(&result->num, a.num, b) == false) return false;
-    }
-
-    const size_t gcd_a = std::gcd(a.num, a.den);
-    if(gcd_a != 1){
-        a.num /= gcd_a;
-        result->den /= gcd_a;
-        return ckd_mul(&result->num, a.num, b);
+    if((result->num | num_high) == 0){
+        result->den = 1;
+        return false;
     }
 
-    return true;
-}
+    // Reduction divides both products by a common factor no larger than either,
+    // so a ratio of at least 2^digits between the products overflows regardless
+    if((den_high == 0 && num_high >= result->den) || (num_high == 0 && den_high >= result->num)) return true;
+
+    // Resist expanding by cancelling across the operands, which fully reduces canonical operands.
+    // The reduced factors are multiplied again, which is cheaper than dividing the wide products.
+    const size_t gcd_a_num_b_den = binary_gcd(a_num, b_den);
+    const size_t gcd_b_num_a_den = binary_gcd(b_num, a_den);
+    if(gcd_a_num_b_den != 1 || gcd_b_num_a_den != 1){
+        if(gcd_a_num_b_den != 1){
+            a_num /= gcd_a_num_b_den;
+            b_den /= gcd_a_num_b_den;
+        }
+        if(gcd_b_num_a_den != 1){
+            b_num /= gcd_b_num_a_den;
+            a_den /= gcd_b_num_a_den;
+        }
 
-bool ckd_mul(NativeRational* result, NativeRational a, NativeRational b) noexcept {
-    if(ckd_mul(&result->num, a.num, b.num) == false && ckd_mul(&result->den, a.den, b.den) == false)
-        return false;
+        result->num = mul_wide(a_num, b_num, &num_high);
+        result->den = mul_wide(a_den, b_den, &den_high);
+        if((num_high | den_high) == 0) return false;
+    }
 
-    const size_t gcd_a = std::gcd(a.num, a.den);
+    // Cancel within each operand, after which the product is canonical
+    const size_t gcd_a = binary_gcd(a_num, a_den);
+    const size_t gcd_b = binary_gcd(b_num, b_den);
+    if(gcd_a == 1 && gcd_b == 1) return true;
     if(gcd_a != 1){
-        a.num /= gcd_a;
-        a.den /= gcd_a;
-
-        if(ckd_mul(&result->num, a.num, b.num) == false && ckd_mul(&result->den, a.den, b.den) == false)
-            return false;
+        a_num /= gcd_a;
+        a_den /= gcd_a;
     }
-
-    const size_t gcd_b = std::gcd(b.num, b.den);
     if(gcd_b != 1){
-        b.num /= gcd_b;
-        b.den /= gcd_b;
-
-        if(ckd_mul(&result->num, a.num, b.num) == false && ckd_mul(&result->den, a.den, b.den) == false)
-            return false;
-    }
-
-    const size_t gcd_a_num_b_den = std::gcd(a.num, b.den);
-    if(gcd_a_num_b_den != 1){
-        a.num /= gcd_a_num_b_den;
-        b.den /= gcd_a_num_b_den;
-
-        if(ckd_mul(&result->num, a.num, b.num) == false && ckd_mul(&result->den, a.den, b.den) == false)
-            return false;
+        b_num /= gcd_b;
+        b_den /= gcd_b;
     }
 
-    const size_t gcd_b_num_a_den = std::gcd(b.num, a.den);
-    if(gcd_b_num_a_den != 1){
-        b.num /= gcd_b_num_a_den;
-        a.den /= gcd_b_num_a_den;
+    result->num = mul_wide(a_num, b_num, &num_high);
+    result->den = mul_wide(a_den, b_den, &den_high);
+    return (num_high | den_high) != 0;
+}
 
-        if(ckd_mul(&result->num, a.num, b.num) == false && ckd_mul(&result->den, a.den, b.den) == false)
-            return false;
-    }
+bool ckd_mul(NativeRational* result, NativeRational a, size_t b) noexcept {
+    return ckd_mul_reduced(result, a.num, a.den, b, 1);
+}
 
-    return true;
+bool ckd_mul(NativeRational* result, NativeRational a, NativeRational b) noexcept {
+    return ckd_mul_reduced(result, a.num, a.den, b.num, b.den);
 }
 
 bool ckd_div(NativeRational* result, NativeRational a, size_t b) noexcept {
     assert(b != 0);
-
-    result->num = a.num;
-    if(ckd_mul(&result->den, a.den, b) == false) return false;
-
-    // Resist expanding if possible
-    const size_t gcd_a_num_b = std::gcd(a.num, b);
-    if(gcd_a_num_b != 1){
-        b /= gcd_a_num_b;
-        result->num /= gcd_a_num_b;
-        if(ckd_mul(&result->den, a.den, b) == false) return false;
-    }
-
-    const size_t gcd_a = std::gcd(a.num, a.den);
-    if(gcd_a != 1){
-        a.den /= gcd_a;
-        result->num /= gcd_a;
-        return ckd_mul(&result->den, a.den, b);
-    }
-
-    return true;
+    return ckd_mul_reduced(result, a.num, a.den, 1, b);
 }
 
 bool ckd_div(NativeRational* result, NativeRational a, NativeRational b) noexcept {
@@ -305,7 +262,7 @@ bool ckd_add(NativeRational* result, NativeRational a, size_t b) noexcept {
 
     size_t b_times_a_den;
     if(ckd_mul(&b_times_a_den, b, a.den)){
-        const size_t gcd_a = std::gcd(a.num, a.den);
+        const size_t gcd_a = binary_gcd(a.num, a.den);
         if(gcd_a == 1) return true;
         a.den /= gcd_a;
         if(ckd_mul(&b_times_a_den, b, a.den)) return true;
@@ -316,33 +273,55 @@ bool ckd_add(NativeRational* result, NativeRational a, size_t b) noexcept {
     return ckd_add(&result->num, a.num, b_times_a_den);
 }
 
+/// Set result to the three-word numerator, most significant word first, over den_a*den_b,
+/// reducing by the gcd of the numerator against each word of the denominator.
+/// Returns true if the fully reduced fraction overflows.
+static bool ckd_reduce_wide(NativeRational* result, size_t num[3], size_t den_a, size_t den_b) noexcept {
+    if((num[0] | num[1] | num[2]) == 0){
+        *result = NativeRational(0, 1);
+        return false;
+    }
+
+    // Reduction divides both by a common factor no larger than either,
+    // so a ratio of at least 2^digits between them overflows regardless
+    size_t den_high;
+    const size_t den_low = mul_wide(den_a, den_b, &den_high);
+    if(num[0] > den_high || (num[0] == den_high && num[1] >= den_low)) return true;
+    if((num[0] | num[1]) == 0 && den_high >= num[2]) return true;
+
+    // Once the gcd with den_a is cancelled the numerator is coprime to the rest of den_a,
+    // so cancelling the gcd with den_b leaves the fraction fully reduced
+    const size_t gcd_a = binary_gcd(num, 3, den_a);
+    if(gcd_a != 1){
+        divexact_words(num, 3, gcd_a);
+        den_a /= gcd_a;
+    }
+    const size_t gcd_b = binary_gcd(num, 3, den_b);
+    if(gcd_b != 1){
+        divexact_words(num, 3, gcd_b);
+        den_b /= gcd_b;
+    }
+
+    result->num = num[2];
+    return (num[0] | num[1]) != 0 || ckd_mul(&result->den, den_a, den_b);
+}
+
 bool ckd_add(NativeRational* result, NativeRational a, NativeRational b) noexcept {
     // a/b + c/d = (a*d + b*c) / (b*d)
-    size_t a_num_times_b_den;
-    size_t b_num_times_a_den;
+    size_t a_num_times_b_den_high;
+    size_t b_num_times_a_den_high;
+    size_t den_high;
+    const size_t a_num_times_b_den = mul_wide(a.num, b.den, &a_num_times_b_den_high);
+    const size_t b_num_times_a_den = mul_wide(b.num, a.den, &b_num_times_a_den_high);
+    result->den = mul_wide(a.den, b.den, &den_high);
 
-    if(ckd_mul(&result->den, a.den, b.den) == false
-       && ckd_mul(&a_num_times_b_den, a.num, b.den) == false
-       && ckd_mul(&b_num_times_a_den, b.num, a.den) == false
+    if((a_num_times_b_den_high | b_num_times_a_den_high | den_high) == 0
        && ckd_add(&result->num, a_num_times_b_den, b_num_times_a_den) == false)
         return false;
 
-    const size_t gcd_a_den_b_den = std::gcd(a.den, b.den);
-    const size_t gcd_a = std::gcd(a.num, a.den);
-    const size_t gcd_b = std::gcd(b.num, b.den);
-
-    const size_t a_den_divisor = knownfit_mul(gcd_a, gcd_a_den_b_den);
-    const size_t b_den_divior = knownfit_mul(gcd_b, gcd_a_den_b_den);
-
-    if(a_den_divisor != 1) a.den /= a_den_divisor;
-    if(b_den_divior != 1) b.den /= b_den_divior;
-    if(gcd_a != 1) a.num /= gcd_a;
-    if(gcd_b != 1) b.num /= gcd_b;
-
-    return ckd_mul(&result->den, a.den, b.den*gcd_a_den_b_den)
-       || ckd_mul(&a_num_times_b_den, a.num, b.den)
-       || ckd_mul(&b_num_times_a_den, b.num, a.den)
-       || ckd_add(&result->num, a_num_times_b_den, b_num_times_a_den);
+    size_t num[3];
+    add_wide(num, a_num_times_b_den_high, a_num_times_b_den, b_num_times_a_den_high, b_num_times_a_den);
+    return ckd_reduce_wide(result, num, a.den, b.den);
 }
 
 NativeRational sub(NativeRational a, size_t b) noexcept {
@@ -359,7 +338,7 @@ bool ckd_sub(NativeRational* result, size_t a, NativeRational b) noexcept {
 
     size_t a_times_b_den;
     if(ckd_mul(&a_times_b_den, a, b.den)){
-        const size_t gcd_b = std::gcd(b.num, b.den);
+        const size_t gcd_b = binary_gcd(b.num, b.den);
         if(gcd_b == 1) return true;
         b.den /= gcd_b;
         if(ckd_mul(&a_times_b_den, a, b.den)) return true;
@@ -376,104 +355,495 @@ bool ckd_sub(NativeRational* result, NativeRational a, NativeRational b) noexcep
     assert(a >= b);
 
     // a/b - c/d = (a*d - b*c) / (b*d)
-    size_t a_num_times_b_den;
-    size_t b_num_times_a_den;
+    size_t a_num_times_b_den_high;
+    size_t b_num_times_a_den_high;
+    size_t den_high;
+    const size_t a_num_times_b_den = mul_wide(a.num, b.den, &a_num_times_b_den_high);
+    const size_t b_num_times_a_den = mul_wide(b.num, a.den, &b_num_times_a_den_high);
+    result->den = mul_wide(a.den, b.den, &den_high);
 
-    if(ckd_mul(&result->den, a.den, b.den) == false
-        && ckd_mul(&a_num_times_b_den, a.num, b.den) == false
-        && ckd_mul(&b_num_times_a_den, b.num, a.den) == false){
+    if((a_num_times_b_den_high | b_num_times_a_den_high | den_high) == 0){
         result->num = knownfit_sub(a_num_times_b_den, b_num_times_a_den);
         return false;
     }
 
-    const size_t gcd_a_den_b_den = std::gcd(a.den, b.den);
-    const size_t gcd_a = std::gcd(a.num, a.den);
-    const size_t gcd_b = std::gcd(b.num, b.den);
+    size_t num[3];
+    sub_wide(num, a_num_times_b_den_high, a_num_times_b_den, b_num_times_a_den_high, b_num_times_a_den);
+    return ckd_reduce_wide(result, num, a.den, b.den);
+}
+
+size_t is_perfect_power(NativeRational* base, NativeRational arg) noexcept {
+    assert(arg.den != 0);
+
+    // Common factors can hide the exponent, e.g. 8/32 == (1/2)^2
+    arg.reduceInPlace();
+    *base = arg;
+    if(arg.num == 0) return 1;
 
-    const size_t a_den_divisor = knownfit_mul(gcd_a, gcd_a_den_b_den);
-    const size_t b_den_divior = knownfit_mul(gcd_b, gcd_a_den_b_den);
+    // A part of 1 is every power of 1, leaving the other part to decide
+    if(arg.den == 1) return is_perfect_power(&base->num, arg.num);
+    if(arg.num == 1) return is_perfect_power(&base->den, arg.den);
 
-    if(a_den_divisor != 1) a.den /= a_den_divisor;
-    if(b_den_divior != 1) b.den /= b_den_divior;
-    if(gcd_a != 1) a.num /= gcd_a;
-    if(gcd_b != 1) b.num /= gcd_b;
+    // The exponents which fit a part are the divisors of its largest, so the common largest is their gcd.
+    // The denominator is only examined if the numerator is a perfect power.
+    size_t num_base;
+    const size_t num_exponent = is_perfect_power(&num_base, arg.num);
+    if(num_exponent == 1) return 1;
+
+    size_t den_base;
+    const size_t den_exponent = is_perfect_power(&den_base, arg.den);
+    const size_t exponent = binary_gcd(num_exponent, den_exponent);
+    base->num = knownfit_pow(num_base, num_exponent / exponent);
+    base->den = knownfit_pow(den_base, den_exponent / exponent);
+
+    return exponent;
+}
+
+CanonicalRational::CanonicalRational(NativeRational val) noexcept
+    : val(val) {
+    this->val.reduceInPlace();
+}
+
+CanonicalRational CanonicalRational::fromReduced(NativeRational val) noexcept {
+    assert(binary_gcd(val.num, val.den) == 1);
+    CanonicalRational result;
+    result.val = val;
+    return result;
+}
 
-    if(ckd_mul(&result->den, a.den, b.den * gcd_a_den_b_den) == false
-        && ckd_mul(&a_num_times_b_den, a.num, b.den) == false
-        && ckd_mul(&b_num_times_a_den, b.num, a.den) == false){
+CanonicalRational CanonicalRational::reciprocal() const noexcept {
+    return fromReduced(val.reciprocal());
+}
+
+bool ckd_mul(CanonicalRational* result, CanonicalRational a, size_t b) noexcept {
+    // Only the denominator may share factors with b
+    size_t a_den = a.den();
+    const size_t gcd = binary_gcd(b, a_den);
+    if(gcd != 1){
+        b /= gcd;
+        a_den /= gcd;
+    }
+
+    size_t num;
+    if(ckd_mul(&num, a.num(), b)) return true;
+    *result = CanonicalRational::fromReduced(NativeRational(num, a_den));
+    return false;
+}
+
+bool ckd_mul(CanonicalRational* result, CanonicalRational a, CanonicalRational b) noexcept {
+    // When the product fits, a single gcd of the product is cheaper than two across the operands
+    NativeRational product;
+    if(ckd_mul(&product.num, a.num(), b.num()) == false && ckd_mul(&product.den, a.den(), b.den()) == false){
+        product.reduceInPlace();
+        *result = CanonicalRational::fromReduced(product);
+        return false;
+    }
+
+    // Canonical operands only share factors across each other
+    size_t a_num = a.num();
+    size_t a_den = a.den();
+    size_t b_num = b.num();
+    size_t b_den = b.den();
+
+    const size_t gcd_a_num_b_den = binary_gcd(a_num, b_den);
+    if(gcd_a_num_b_den != 1){
+        a_num /= gcd_a_num_b_den;
+        b_den /= gcd_a_num_b_den;
+    }
+    const size_t gcd_b_num_a_den = binary_gcd(b_num, a_den);
+    if(gcd_b_num_a_den != 1){
+        b_num /= gcd_b_num_a_den;
+        a_den /= gcd_b_num_a_den;
+    }
+
+    if(ckd_mul(&product.num, a_num, b_num) || ckd_mul(&product.den, a_den, b_den)) return true;
+    *result = CanonicalRational::fromReduced(product);
+    return false;
+}
+
+bool ckd_div(CanonicalRational* result, CanonicalRational a, size_t b) noexcept {
+    assert(b != 0);
+
+    // Only the numerator may share factors with b
+    size_t a_num = a.num();
+    const size_t gcd = binary_gcd(a_num, b);
+    if(gcd != 1){
+        a_num /= gcd;
+        b /= gcd;
+    }
+
+    size_t den;
+    if(ckd_mul(&den, a.den(), b)) return true;
+    *result = CanonicalRational::fromReduced(NativeRational(a_num, den));
+    return false;
+}
+
+bool ckd_div(CanonicalRational* result, CanonicalRational a, CanonicalRational b) noexcept {
+    return ckd_mul(result, a, b.reciprocal());
+}
+
+bool ckd_add(CanonicalRational* result, CanonicalRational a, size_t b) noexcept {
+    // n/d + b = (n + b*d) / d, where gcd(n + b*d, d) = gcd(n, d) = 1
+    size_t num;
+    if(ckd_mul(&num, b, a.den()) || ckd_add(&num, num, a.num())) return true;
+    *result = CanonicalRational::fromReduced(NativeRational(num, a.den()));
+    return false;
+}
+
+/// Set result to the three-word numerator over a_den_part*b_den from the Henrici sum or difference,
+/// where only gcd_dens, the gcd of the operand denominators, may share factors with the numerator.
+/// Returns true if the canonical result overflows.
+static bool ckd_henrici_reduce(CanonicalRational* result,
+                               size_t num[3],
+                               size_t a_den_part,
+                               size_t b_den,
+                               size_t gcd_dens) noexcept {
+    if(gcd_dens != 1){
+        const size_t gcd_num = binary_gcd(num, 3, gcd_dens);
+        if(gcd_num != 1){
+            divexact_words(num, 3, gcd_num);
+            b_den /= gcd_num;
+        }
+    }
+
+    NativeRational val;
+    if((num[0] | num[1]) != 0 || ckd_mul(&val.den, a_den_part, b_den)) return true;
+    val.num = num[2];
+    *result = CanonicalRational::fromReduced(val);
+    return false;
+}
+
+bool ckd_add(CanonicalRational* result, CanonicalRational a, CanonicalRational b) noexcept {
+    // When the unreduced sum fits, a single gcd of the sum is cheaper than reducing by parts
+    NativeRational sum;
+    size_t a_num_times_b_den;
+    size_t b_num_times_a_den;
+    if(ckd_mul(&sum.den, a.den(), b.den()) == false
+       && ckd_mul(&a_num_times_b_den, a.num(), b.den()) == false
+       && ckd_mul(&b_num_times_a_den, b.num(), a.den()) == false
+       && ckd_add(&sum.num, a_num_times_b_den, b_num_times_a_den) == false){
+        sum.reduceInPlace();
+        *result = CanonicalRational::fromReduced(sum);
+        return false;
+    }
+
+    // With g = gcd(b, d), a/b + c/d = (a*(d/g) + c*(b/g)) / ((b/g)*d),
+    // and only g may share factors with the numerator of canonical operands (Henrici)
+    const size_t gcd_dens = binary_gcd(a.den(), b.den());
+    const size_t a_den_part = (gcd_dens == 1) ? a.den() : a.den() / gcd_dens;
+    const size_t b_den_part = (gcd_dens == 1) ? b.den() : b.den() / gcd_dens;
+
+    size_t a_high;
+    size_t b_high;
+    const size_t a_low = mul_wide(a.num(), b_den_part, &a_high);
+    const size_t b_low = mul_wide(b.num(), a_den_part, &b_high);
+    size_t num[3];
+    add_wide(num, a_high, a_low, b_high, b_low);
+
+    return ckd_henrici_reduce(result, num, a_den_part, b.den(), gcd_dens);
+}
+
+bool ckd_sub(CanonicalRational* result, CanonicalRational a, CanonicalRational b) noexcept {
+    assert(NativeRational(a) >= NativeRational(b));
+
+    // With g = gcd(b, d), a/b - c/d = (a*(d/g) - c*(b/g)) / ((b/g)*d),
+    // and only g may share factors with the numerator of canonical operands (Henrici)
+    const size_t gcd_dens = binary_gcd(a.den(), b.den());
+    const size_t a_den_part = (gcd_dens == 1) ? a.den() : a.den() / gcd_dens;
+    const size_t b_den_part = (gcd_dens == 1) ? b.den() : b.den() / gcd_dens;
+
+    size_t a_high;
+    size_t b_high;
+    const size_t a_low = mul_wide(a.num(), b_den_part, &a_high);
+    const size_t b_low = mul_wide(b.num(), a_den_part, &b_high);
+    size_t num[3];
+    sub_wide(num, a_high, a_low, b_high, b_low);
+
+    return ckd_henrici_reduce(result, num, a_den_part, b.den(), gcd_dens);
+}
+
+SignedNativeRational::SignedNativeRational(NativeRational magnitude, bool is_negative) noexcept
+    : val(magnitude), is_negative(is_negative && magnitude.num != 0) {}
+
+SignedNativeRational::operator long double() const noexcept {
+    const long double magnitude = static_cast<long double>(val);
+    return is_negative ? -magnitude : magnitude;
+}
+
+SignedNativeRational::operator double() const noexcept {
+    const double magnitude = static_cast<double>(val);
+    return is_negative ? -magnitude : magnitude;
+}
+
+bool operator==(SignedNativeRational a, SignedNativeRational b) noexcept {
+    return a.is_negative == b.is_negative && a.val == b.val;
+}
+
+bool operator!=(SignedNativeRational a, SignedNativeRational b) noexcept {
+    return !(a == b);
+}
+
+bool operator>(SignedNativeRational a, SignedNativeRational b) noexcept {
+    if(a.is_negative != b.is_negative) return b.is_negative;
+    return a.is_negative ? b.val > a.val : a.val > b.val;
+}
+
+bool operator>=(SignedNativeRational a, SignedNativeRational b) noexcept {
+    if(a.is_negative != b.is_negative) return b.is_negative;
+    return a.is_negative ? b.val >= a.val : a.val >= b.val;
+}
+
+bool operator<(SignedNativeRational a, SignedNativeRational b) noexcept {
+    return b > a;
+}
+
+bool operator<=(SignedNativeRational a, SignedNativeRational b) noexcept {
+    return b >= a;
+}
+
+SignedNativeRational SignedNativeRational::negated() const noexcept {
+    return SignedNativeRational(val, !is_negative);
+}
+
+SignedNativeRational SignedNativeRational::reciprocal() const noexcept {
+    return SignedNativeRational(val.reciprocal(), is_negative);
+}
+
+bool ckd_mul(SignedNativeRational* result, SignedNativeRational a, SignedNativeRational b) noexcept {
+    NativeRational magnitude;
+    if(ckd_mul(&magnitude, a.magnitude(), b.magnitude())) return true;
+    *result = SignedNativeRational(magnitude, a.isNegative() != b.isNegative());
+    return false;
+}
+
+bool ckd_div(SignedNativeRational* result, SignedNativeRational a, SignedNativeRational b) noexcept {
+    return ckd_mul(result, a, b.reciprocal());
+}
+
+/// Set result to |a - b|, and b_is_larger to whether b > a.
+/// Returns true if the calculation overflows.
+static bool ckd_abs_sub(NativeRational* result, bool* b_is_larger, NativeRational a, NativeRational b) noexcept {
+    // The magnitudes are ordered by the same cross products which form the difference
+    size_t a_num_times_b_den_high;
+    size_t b_num_times_a_den_high;
+    size_t den_high;
+    size_t a_num_times_b_den = mul_wide(a.num, b.den, &a_num_times_b_den_high);
+    size_t b_num_times_a_den = mul_wide(b.num, a.den, &b_num_times_a_den_high);
+    *b_is_larger = b_num_times_a_den_high > a_num_times_b_den_high
+                   || (b_num_times_a_den_high == a_num_times_b_den_high && b_num_times_a_den > a_num_times_b_den);
+    if(*b_is_larger){
+        std::swap(a_num_times_b_den_high, b_num_times_a_den_high);
+        std::swap(a_num_times_b_den, b_num_times_a_den);
+    }
+    result->den = mul_wide(a.den, b.den, &den_high);
+
+    if((a_num_times_b_den_high | b_num_times_a_den_high | den_high) == 0){
         result->num = knownfit_sub(a_num_times_b_den, b_num_times_a_den);
         return false;
     }
 
-    return true;
+    size_t num[3];
+    sub_wide(num, a_num_times_b_den_high, a_num_times_b_den, b_num_times_a_den_high, b_num_times_a_den);
+    return ckd_reduce_wide(result, num, a.den, b.den);
+}
+
+bool ckd_add(SignedNativeRational* result, SignedNativeRational a, SignedNativeRational b) noexcept {
+    NativeRational magnitude;
+    if(a.isNegative() == b.isNegative()){
+        if(ckd_add(&magnitude, a.magnitude(), b.magnitude())) return true;
+        *result = SignedNativeRational(magnitude, a.isNegative());
+        return false;
+    }
+
+    bool b_is_larger;
+    if(ckd_abs_sub(&magnitude, &b_is_larger, a.magnitude(), b.magnitude())) return true;
+    *result = SignedNativeRational(magnitude, b_is_larger ? b.isNegative() : a.isNegative());
+    return false;
+}
+
+bool ckd_sub(SignedNativeRational* result, SignedNativeRational a, SignedNativeRational b) noexcept {
+    return ckd_add(result, a, b.negated());
 }
 
-template<bool typeset_fraction>
+size_t canonical_hash(NativeRational val) noexcept {
+    val.reduceInPlace();
+    return hash_rational(hash_word(val.num), hash_word(val.den), false);
+}
+
+size_t canonical_hash(CanonicalRational val) noexcept {
+    return hash_rational(hash_word(val.num()), hash_word(val.den()), false);
+}
+
+size_t canonical_hash(SignedNativeRational val) noexcept {
+    NativeRational magnitude = val.magnitude();
+    magnitude.reduceInPlace();
+    return hash_rational(hash_word(magnitude.num), hash_word(magnitude.den), val.isNegative());
+}
+
+template<typename Style>
+static size_t write_native_rational_size(NativeRational val, size_t num_digits, size_t den_digits) noexcept {
+    if(Style::omit_unit_denominator && val.den == 1) return INTEGER_MARKERS_SIZE<Style> + num_digits;
+    return FRACTION_MARKERS_SIZE<Style> + num_digits + den_digits;
+}
+
+template<typename Style>
+static char* write_native_rational(char* dest, NativeRational val, size_t num_digits, size_t den_digits) noexcept {
+    if(Style::omit_unit_denominator && val.den == 1){
+        dest = write_marker(dest, Style::integer_open);
+        dest = write_base10_digits(dest, val.num, num_digits);
+        return write_marker(dest, Style::integer_close);
+    }
+
+    dest = write_marker(dest, Style::fraction_open);
+    dest = write_base10_digits(dest, val.num, num_digits);
+    dest = write_marker(dest, Style::fraction_middle);
+    dest = write_base10_digits(dest, val.den, den_digits);
+    return write_marker(dest, Style::fraction_close);
+}
+
+template<typename Style>
 void write_native_rational(std::string& str, NativeRational val) {
-    if(typeset_fraction) str += "⁜f⏴";
-    write_native_int(str, val.num);
-    if(typeset_fraction) str += "⏵⏴";
-    else str += '/';
-    write_native_int(str, val.den);
-    if(typeset_fraction) str += "⏵";
-}
-template void write_native_rational<false>(std::string&, NativeRational);
-template void write_native_rational<true>(std::string&, NativeRational);
-
-constexpr size_t powers_of_ten[] = {
-    1,
-    10,
-    100,
-    1000,
-    10000,
-    100000,
-    1000000,
-    10000000,
-    100000000,
-    1000000000uLL,
-#if defined(__x86_64__) || defined(__aarch64__) || defined( _WIN64 )  // 64-bit
-    10000000000,
-    100000000000,
-    1000000000000,
-    10000000000000,
-    100000000000000,
-    1000000000000000,
-    10000000000000000,
-    100000000000000000,
-    1000000000000000000,
-    10000000000000000000uLL,
-#endif
-};
-
-// Check this rather than specify it to make sure the macro worked
-static_assert(sizeof(powers_of_ten)/sizeof(size_t) == std::numeric_limits<size_t>::digits10+1);
-
-constexpr size_t powers_of_five[] = {
-    1,
-    5,
-    25,
-    125,
-    625,
-    3125,
-    15625,
-    78125,
-    390625,
-    1953125,
-    9765625uLL,
-#if defined(__x86_64__) || defined(__aarch64__) || defined( _WIN64 )  // 64-bit
-    48828125,
-    244140625,
-    1220703125,
-    6103515625,
-    30517578125,
-    152587890625,
-    762939453125,
-    3814697265625,
-    19073486328125,
-    95367431640625uLL,
-#endif
-};
-static_assert(sizeof(powers_of_five)/sizeof(size_t) == std::numeric_limits<size_t>::digits10+2);
+    const size_t num_digits = count_base10_digits(val.num);
+    const size_t den_digits = count_base10_digits(val.den);
+    const size_t start_index = str.size();
+    str.resize(start_index + write_native_rational_size<Style>(val, num_digits, den_digits));
+
+    write_native_rational<Style>(str.data() + start_index, val, num_digits, den_digits);
+}
+template void write_native_rational<PlaintextStyle>(std::string&, NativeRational);
+template void write_native_rational<TypesetStyle>(std::string&, NativeRational);
+template void write_native_rational<LatexStyle>(std::string&, NativeRational);
+template void write_native_rational<MathMLStyle>(std::string&, NativeRational);
+
+template<typename Style>
+void write_native_rational(OutputBuilder& out, NativeRational val) {
+    const size_t num_digits = count_base10_digits(val.num);
+    const size_t den_digits = count_base10_digits(val.den);
+    const size_t size = write_native_rational_size<Style>(val, num_digits, den_digits);
+
+    write_native_rational<Style>(out.reserve(size), val, num_digits, den_digits);
+    out.commit(size);
+}
+template void write_native_rational<PlaintextStyle>(OutputBuilder&, NativeRational);
+template void write_native_rational<TypesetStyle>(OutputBuilder&, NativeRational);
+template void write_native_rational<LatexStyle>(OutputBuilder&, NativeRational);
+template void write_native_rational<MathMLStyle>(OutputBuilder&, NativeRational);
+
+template<typename Style>
+void write_native_rational(std::string& str, SignedNativeRational val) {
+    if(val.isNegative()) str += Style::negative;
+    write_native_rational<Style>(str, val.magnitude());
+}
+template void write_native_rational<PlaintextStyle>(std::string&, SignedNativeRational);
+template void write_native_rational<TypesetStyle>(std::string&, SignedNativeRational);
+template void write_native_rational<LatexStyle>(std::string&, SignedNativeRational);
+template void write_native_rational<MathMLStyle>(std::string&, SignedNativeRational);
+
+template<typename Style>
+void write_native_rational(OutputBuilder& out, SignedNativeRational val) {
+    if(val.isNegative()) out.append(Style::negative);
+    write_native_rational<Style>(out, val.magnitude());
+}
+template void write_native_rational<PlaintextStyle>(OutputBuilder&, SignedNativeRational);
+template void write_native_rational<TypesetStyle>(OutputBuilder&, SignedNativeRational);
+template void write_native_rational<LatexStyle>(OutputBuilder&, SignedNativeRational);
+template void write_native_rational<MathMLStyle>(OutputBuilder&, SignedNativeRational);
+
+/// Return the next digit of the long division of rem by den, updating the remainder
+static char next_decimal_digit(size_t* rem, size_t den) noexcept {
+    if(den <= std::numeric_limits<size_t>::max() / 10){
+        const size_t scaled = *rem * 10;
+        const size_t digit = scaled / den;
+        *rem = scaled - digit * den;
+        return static_cast<char>('0' + digit);
+    }
+
+    // 10*rem may overflow, so accumulate rem ten times while reducing modulo den
+    char digit = '0';
+    size_t scaled = 0;
+    for(size_t i = 0; i < 10; i++){
+        if(scaled >= den - *rem){
+            scaled -= den - *rem;
+            digit++;
+        }else{
+            scaled += *rem;
+        }
+    }
+    *rem = scaled;
+    return digit;
+}
+
+static size_t rational_as_decimal_upperbound(size_t max_fraction_digits) noexcept {
+    static constexpr size_t PLUS_ONE_FOR_DECIMAL_POINT = 1;
+    static constexpr size_t INTEGER_DIGITS = std::numeric_limits<size_t>::digits10 + 1;
+    return INTEGER_DIGITS + PLUS_ONE_FOR_DECIMAL_POINT + max_fraction_digits + DECIMAL_CUTOFF_MARKER.size();
+}
+
+static char* write_rational_as_decimal(char* dest, NativeRational val, size_t max_fraction_digits) noexcept {
+    val.reduceInPlace();
+    const size_t integer_part = val.num / val.den;
+    dest = write_base10_digits(dest, integer_part, count_base10_digits(integer_part));
+    size_t rem = val.num % val.den;
+    if(rem == 0) return dest;
+    if(max_fraction_digits == 0) return write_marker(dest, DECIMAL_CUTOFF_MARKER);
+    *dest++ = '.';
+
+    // Digits before any repetend are given by the valuations of the denominator in 2 and 5
+    const size_t twos = count_trailing_zeros(val.den);
+    size_t cofactor = val.den >> twos;
+    size_t fives = 0;
+    for(; cofactor % 5 == 0; fives++) cofactor /= 5;
+    const size_t preperiod = std::max(twos, fives);
+
+    // A terminating expansion is the remainder scaled to an integer over 10^preperiod, when that fits
+    if(cofactor == 1 && preperiod <= std::min<size_t>(max_fraction_digits, std::numeric_limits<size_t>::digits10))
+        return write_zero_padded_digits(dest, rem * (powers_of_ten[preperiod] / val.den), preperiod);
+
+    const size_t num_preperiod_digits = std::min(preperiod, max_fraction_digits);
+    for(size_t i = 0; i < num_preperiod_digits; i++) *dest++ = next_decimal_digit(&rem, val.den);
+    if(rem == 0) return dest;
+    if(num_preperiod_digits == max_fraction_digits) return write_marker(dest, DECIMAL_CUTOFF_MARKER);
+
+    // The remainder after the preperiod recurs exactly at the end of the repetend
+    char* const repetend_open = dest++;
+    const size_t repetend_rem = rem;
+    for(size_t i = preperiod; i < max_fraction_digits; i++){
+        *dest++ = next_decimal_digit(&rem, val.den);
+        if(rem == repetend_rem){
+            *repetend_open = '(';
+            *dest++ = ')';
+            return dest;
+        }
+    }
+
+    // The repetend does not end within the limit, so close the gap left for its parenthesis
+    memmove(repetend_open, repetend_open + 1, dest - (repetend_open + 1));
+    return write_marker(dest - 1, DECIMAL_CUTOFF_MARKER);
+}
+
+void write_rational_as_decimal(std::string& str, NativeRational val, size_t max_fraction_digits) {
+    // Resize once for the largest possible output, then trim where the bound exceeded the need
+    const size_t start_index = str.size();
+    str.resize(start_index + rational_as_decimal_upperbound(max_fraction_digits));
+    const char* end = write_rational_as_decimal(str.data() + start_index, val, max_fraction_digits);
+    str.resize(end - str.data());
+}
+
+void write_rational_as_decimal(OutputBuilder& out, NativeRational val, size_t max_fraction_digits) {
+    char* buffer = out.reserve(rational_as_decimal_upperbound(max_fraction_digits));
+    const char* end = write_rational_as_decimal(buffer, val, max_fraction_digits);
+    out.commit(end - buffer);
+}
+
+void write_rational_as_decimal(std::string& str, SignedNativeRational val, size_t max_fraction_digits) {
+    if(val.isNegative()) str += '-';
+    write_rational_as_decimal(str, val.magnitude(), max_fraction_digits);
+}
+
+void write_rational_as_decimal(OutputBuilder& out, SignedNativeRational val, size_t max_fraction_digits) {
+    if(val.isNegative()) out.append('-');
+    write_rational_as_decimal(out, val.magnitude(), max_fraction_digits);
+}
 
 bool ckd_strdecimaltail2rat(NativeRational* result, std::string_view str) noexcept {
     assert(str.at(0) == '.');
@@ -593,7 +963,7 @@ bool ckd_strdecimal2rat_times10toPos(NativeRational* result, std::string_view st
     const size_t decimal_index = str.find('.');
     if(decimal_index == std::string::npos){
         result->den = 1;
-        return power >= (sizeof(powers_of_ten) / sizeof(size_t))
+        return power >= NUM_POWERS_OF_TEN
                || ckd_str2int(&result->num, str)
                || ckd_mul(&result->num, result->num, powers_of_ten[power]);
     }
@@ -619,7 +989,7 @@ bool ckd_strdecimal2rat_times10toPos(NativeRational* result, std::string_view st
 
         power -= num_trailing_digits;
         result->den = 1;
-        return power >= (sizeof(powers_of_ten) / sizeof(size_t))
+        return power >= NUM_POWERS_OF_TEN
                || ckd_str2int(&result->num, std::string_view(buffer, num_digits))
                || ckd_mul(&result->num, result->num, powers_of_ten[power]);
     }else{
@@ -670,7 +1040,7 @@ static bool ckd_strinteger2rat_times10toNeg(NativeRational* result, std::string_
         power -= num_digits;
         result->den = 1;
 
-        return power >= (sizeof(powers_of_ten) / sizeof(size_t))
+        return power >= NUM_POWERS_OF_TEN
                || ckd_strdecimaltail2rat(result, std::string_view(buffer, num_digits+1))
                || ckd_mul(&result->den, result->den, powers_of_ten[power]);
     }else{
@@ -723,7 +1093,7 @@ bool ckd_strdecimal2rat_times10toNeg(NativeRational* result, std::string_view st
         power -= num_leading_digits;
         result->den = 1;
 
-        return power >= (sizeof(powers_of_ten) / sizeof(size_t))
+        return power >= NUM_POWERS_OF_TEN
                || ckd_strdecimaltail2rat(result, std::string_view(buffer, num_digits+1))
                || ckd_mul(&result->den, result->den, powers_of_ten[power]);
     }else{
@@ -0,0 +1,303 @@
+#include "ki_cas_native_rational_array.h"
+
+#include "ki_cas_canonical_hash.h"
+#include "ki_cas_parallel.h"
+#include "ki_cas_wide_integer.h"
+#include <cassert>
+
+namespace KiCAS2 {
+
+NativeRationalArray::NativeRationalArray(size_t size)
+    : num(size, 0), den(size, 1) {}
+
+void NativeRationalArray::set(size_t index, NativeRational val) noexcept {
+    num[index] = val.num;
+    den[index] = val.den;
+}
+
+void NativeRationalArray::push_back(NativeRational val) {
+    num.push_back(val.num);
+    den.push_back(val.den);
+}
+
+/// Lane states of the branch-free pass
+static constexpr uint8_t LANE_FITS = 0;
+static constexpr uint8_t LANE_FAILS = 1;  // Not representable however far it reduces, e.g. negative differences
+static constexpr uint8_t LANE_RETRY = 2;  // The products do not fit, but the result may after reduction
+
+/// Run the lane kernel over every element without branching on the values
+template<bool result_aliases_operand, typename LaneKernel>
+static uint8_t lane_pass(size_t* out_num, size_t* out_den, uint8_t* mask,
+                         const size_t* a_num, const size_t* a_den, const size_t* b_num, const size_t* b_den,
+                         size_t n, LaneKernel lane) noexcept {
+    uint8_t any_flagged = LANE_FITS;
+    for(size_t i = 0; i < n; i++){
+        size_t num;
+        size_t den;
+        const uint8_t state = lane(&num, &den, a_num[i], a_den[i], b_num[i], b_den[i]);
+        if constexpr (result_aliases_operand){
+            // Flagged lanes keep their old output, so the aliased operands survive for the scalar pass
+            const size_t keep = size_t(0) - (state != LANE_FITS);
+            out_num[i] = (out_num[i] & keep) | (num & ~keep);
+            out_den[i] = (out_den[i] & keep) | (den & ~keep);
+        }else{
+            out_num[i] = num;
+            out_den[i] = den;
+        }
+        mask[i] = state;
+        any_flagged |= state;
+    }
+
+    return any_flagged;
+}
+
+/// Run the lane kernel over every element, then rerun each lane flagged for retry with the scalar function
+template<typename LaneKernel, typename ScalarFallback>
+static bool two_pass(NativeRationalArray* result, const NativeRationalArray& a, const NativeRationalArray& b,
+                     std::vector<uint8_t>* overflow, LaneKernel lane, ScalarFallback scalar) {
+    assert(a.size() == b.size());
+    const size_t n = a.size();
+    const bool result_aliases_operand = (result == &a) || (result == &b);
+    result->num.resize(n);
+    result->den.resize(n);
+    overflow->resize(n);
+
+    const size_t* a_num = a.num.data();
+    const size_t* a_den = a.den.data();
+    const size_t* b_num = b.num.data();
+    const size_t* b_den = b.den.data();
+    size_t* out_num = result->num.data();
+    size_t* out_den = result->den.data();
+    uint8_t* mask = overflow->data();
+
+    const uint8_t any_flagged = result_aliases_operand
+        ? lane_pass<true>(out_num, out_den, mask, a_num, a_den, b_num, b_den, n, lane)
+        : lane_pass<false>(out_num, out_den, mask, a_num, a_den, b_num, b_den, n, lane);
+    if(any_flagged == LANE_FITS) return false;
+    if(!(any_flagged & LANE_RETRY)) return true;
+
+    bool any_overflow = false;
+    for(size_t i = 0; i < n; i++){
+        if(mask[i] != LANE_RETRY){
+            any_overflow |= (mask[i] != LANE_FITS);
+            continue;
+        }
+        NativeRational val;
+        const bool lane_overflow = scalar(&val, NativeRational(a_num[i], a_den[i]), NativeRational(b_num[i], b_den[i]));
+        mask[i] = lane_overflow;
+        any_overflow |= lane_overflow;
+        if(!lane_overflow){
+            out_num[i] = val.num;
+            out_den[i] = val.den;
+        }
+    }
+
+    return any_overflow;
+}
+
+bool ckd_add(NativeRationalArray* result, const NativeRationalArray& a, const NativeRationalArray& b,
+             std::vector<uint8_t>* overflow) {
+    // a/b + c/d = (a*d + c*b) / (b*d)
+    const auto lane = [](size_t* num, size_t* den, size_t a, size_t b, size_t c, size_t d){
+        size_t ad_high, cb_high, bd_high;
+        const size_t ad = mul_wide(a, d, &ad_high);
+        const size_t cb = mul_wide(c, b, &cb_high);
+        *den = mul_wide(b, d, &bd_high);
+        *num = ad + cb;
+        return static_cast<uint8_t>(((ad_high | cb_high | bd_high) != 0 || *num < ad) * LANE_RETRY);
+    };
+    const auto scalar = [](NativeRational* val, NativeRational a, NativeRational b){ return ckd_add(val, a, b); };
+
+    return two_pass(result, a, b, overflow, lane, scalar);
+}
+
+bool ckd_sub(NativeRationalArray* result, const NativeRationalArray& a, const NativeRationalArray& b,
+             std::vector<uint8_t>* overflow) {
+    // a/b - c/d = (a*d - c*b) / (b*d)
+    const auto lane = [](size_t* num, size_t* den, size_t a, size_t b, size_t c, size_t d){
+        size_t ad_high, cb_high, bd_high;
+        const size_t ad = mul_wide(a, d, &ad_high);
+        const size_t cb = mul_wide(c, b, &cb_high);
+        *den = mul_wide(b, d, &bd_high);
+        *num = ad - cb;
+        const bool retry = (ad_high | cb_high | bd_high) != 0;
+        return static_cast<uint8_t>(retry ? LANE_RETRY : (ad < cb) * LANE_FAILS);
+    };
+    const auto scalar = [](NativeRational* val, NativeRational a, NativeRational b){
+        return a < b || ckd_sub(val, a, b);
+    };
+
+    return two_pass(result, a, b, overflow, lane, scalar);
+}
+
+bool ckd_mul(NativeRationalArray* result, const NativeRationalArray& a, const NativeRationalArray& b,
+             std::vector<uint8_t>* overflow) {
+    const auto lane = [](size_t* num, size_t* den, size_t a, size_t b, size_t c, size_t d){
+        size_t num_high, den_high;
+        *num = mul_wide(a, c, &num_high);
+        *den = mul_wide(b, d, &den_high);
+        return static_cast<uint8_t>(((num_high | den_high) != 0) * LANE_RETRY);
+    };
+    const auto scalar = [](NativeRational* val, NativeRational a, NativeRational b){ return ckd_mul(val, a, b); };
+
+    return two_pass(result, a, b, overflow, lane, scalar);
+}
+
+bool ckd_div(NativeRationalArray* result, const NativeRationalArray& a, const NativeRationalArray& b,
+             std::vector<uint8_t>* overflow) {
+    const auto lane = [](size_t* num, size_t* den, size_t a, size_t b, size_t c, size_t d){
+        assert(c != 0);
+        size_t num_high, den_high;
+        *num = mul_wide(a, d, &num_high);
+        *den = mul_wide(b, c, &den_high);
+        return static_cast<uint8_t>(((num_high | den_high) != 0) * LANE_RETRY);
+    };
+    const auto scalar = [](NativeRational* val, NativeRational a, NativeRational b){ return ckd_div(val, a, b); };
+
+    return two_pass(result, a, b, overflow, lane, scalar);
+}
+
+/// Elements whose gcds are found together. Enough independent chains to cover the latency of a Stein step.
+static constexpr size_t GCD_LANES = 8;
+
+/// Cancel each numerator and nonzero denominator by their gcd, with 0/d cancelling to 0/1.
+/// Every lane steps until the last has finished, so the loop never branches on the values of one lane.
+static void cancel_lanes(size_t nums[GCD_LANES], size_t dens[GCD_LANES]) noexcept {
+    size_t a[GCD_LANES];
+    size_t b[GCD_LANES];
+    size_t shift[GCD_LANES];
+    for(size_t i = 0; i < GCD_LANES; i++){
+        // gcd(num, den) = gcd(num % den, den), where the remainder brings the lane down to the size of the denominator
+        // so that lanes with large numerators do not hold the block up. A zero remainder leaves the gcd as den.
+        assert(dens[i] != 0);
+        const size_t remainder = nums[i] % dens[i];
+        const size_t num = remainder != 0 ? remainder : dens[i];
+        const size_t num_zeros = count_trailing_zeros(num);
+        const size_t den_zeros = count_trailing_zeros(dens[i]);
+        shift[i] = num_zeros < den_zeros ? num_zeros : den_zeros;
+        a[i] = num >> num_zeros;
+        b[i] = dens[i] >> den_zeros;
+    }
+
+    // The step of binary_gcd needs no mask for finished lanes: once a == b it steps to (0, g) and then
+    // settles on (g, 0), so every lane has finished once each has a zero word. Both words are odd until then.
+    constexpr size_t TOP_BIT = ~(~size_t(0) >> 1);
+    size_t active;
+    do{
+        active = 0;
+        for(size_t i = 0; i < GCD_LANES; i++){
+            const size_t diff = a[i] - b[i];
+            const bool a_is_less = a[i] < b[i];
+            const size_t magnitude = a_is_less ? b[i] - a[i] : diff;
+            b[i] = a_is_less ? a[i] : b[i];
+            a[i] = magnitude >> count_trailing_zeros(diff | TOP_BIT);
+            active |= a[i] & b[i];
+        }
+    }while(active != 0);
+
+    // The gcd is (a[i] | b[i]) << shift[i], which divides exactly as a multiplication by the inverse of its odd part
+    for(size_t i = 0; i < GCD_LANES; i++){
+        const size_t inverse = inverse_mod_word(a[i] | b[i]);
+        nums[i] = (nums[i] >> shift[i]) * inverse;
+        dens[i] = (dens[i] >> shift[i]) * inverse;
+    }
+}
+
+/// Cancel the values in [begin, end) of separate numerator and denominator sequences
+template<typename Nums, typename Dens>
+static void canonicalise_range(Nums num, Dens den, size_t begin, size_t end) noexcept {
+    size_t i = begin;
+    for(; i + GCD_LANES <= end; i += GCD_LANES){
+        size_t nums[GCD_LANES];
+        size_t dens[GCD_LANES];
+        for(size_t j = 0; j < GCD_LANES; j++){
+            nums[j] = num(i + j);
+            dens[j] = den(i + j);
+        }
+        cancel_lanes(nums, dens);
+        for(size_t j = 0; j < GCD_LANES; j++){
+            num(i + j) = nums[j];
+            den(i + j) = dens[j];
+        }
+    }
+
+    for(; i < end; i++){
+        const size_t gcd = binary_gcd(num(i), den(i));
+        num(i) /= gcd;
+        den(i) /= gcd;
+    }
+}
+
+void canonicalise(NativeRationalArray* vals, size_t num_threads) {
+    assert(vals->num.size() == vals->den.size());
+    size_t* num = vals->num.data();
+    size_t* den = vals->den.data();
+    parallel_for(vals->size(), num_threads, [num, den](size_t begin, size_t end){
+        canonicalise_range([num](size_t i) -> size_t& { return num[i]; },
+                           [den](size_t i) -> size_t& { return den[i]; },
+                           begin, end);
+    });
+}
+
+void canonicalise(NativeRational* vals, size_t num_vals, size_t num_threads) {
+    parallel_for(num_vals, num_threads, [vals](size_t begin, size_t end){
+        canonicalise_range([vals](size_t i) -> size_t& { return vals[i].num; },
+                           [vals](size_t i) -> size_t& { return vals[i].den; },
+                           begin, end);
+    });
+}
+
+/// Hash the values of separate numerator and denominator sequences
+template<typename Nums, typename Dens>
+static void canonical_hashes_range(size_t* hashes, Nums num, Dens den, size_t num_vals) noexcept {
+    size_t i = 0;
+    for(; i + GCD_LANES <= num_vals; i += GCD_LANES){
+        size_t nums[GCD_LANES];
+        size_t dens[GCD_LANES];
+        for(size_t j = 0; j < GCD_LANES; j++){
+            nums[j] = num(i + j);
+            dens[j] = den(i + j);
+        }
+        cancel_lanes(nums, dens);
+        for(size_t j = 0; j < GCD_LANES; j++) hashes[i + j] = hash_rational(hash_word(nums[j]), hash_word(dens[j]), false);
+    }
+
+    for(; i < num_vals; i++) hashes[i] = canonical_hash(NativeRational(num(i), den(i)));
+}
+
+void canonical_hashes(size_t* hashes, const NativeRationalArray& vals) noexcept {
+    const size_t* num = vals.num.data();
+    const size_t* den = vals.den.data();
+    canonical_hashes_range(hashes, [num](size_t i){ return num[i]; }, [den](size_t i){ return den[i]; }, vals.size());
+}
+
+void canonical_hashes(size_t* hashes, const NativeRational* vals, size_t num_vals) noexcept {
+    canonical_hashes_range(hashes,
+                           [vals](size_t i){ return vals[i].num; },
+                           [vals](size_t i){ return vals[i].den; },
+                           num_vals);
+}
+
+void cmp(std::vector<int8_t>* result, const NativeRationalArray& a, const NativeRationalArray& b) {
+    assert(a.size() == b.size());
+    const size_t n = a.size();
+    result->resize(n);
+
+    const size_t* a_num = a.num.data();
+    const size_t* a_den = a.den.data();
+    const size_t* b_num = b.num.data();
+    const size_t* b_den = b.den.data();
+    int8_t* out = result->data();
+
+    // a/b <=> c/d  ⇔  a*d <=> c*b, compared as double words so overflow is never an issue
+    for(size_t i = 0; i < n; i++){
+        size_t ad_high, cb_high;
+        const size_t ad = mul_wide(a_num[i], b_den[i], &ad_high);
+        const size_t cb = mul_wide(b_num[i], a_den[i], &cb_high);
+        const int greater = (ad_high > cb_high) | ((ad_high == cb_high) & (ad > cb));
+        const int less = (ad_high < cb_high) | ((ad_high == cb_high) & (ad < cb));
+        out[i] = static_cast<int8_t>(greater - less);
+    }
+}
+
+}  // namespace KiCAS2
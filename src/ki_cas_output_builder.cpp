@@ -0,0 +1,133 @@
+#include "ki_cas_output_builder.h"
+
+#include <algorithm>
+#include <cassert>
+#include <cstring>
+
+#ifdef _WIN32
+#include <io.h>
+#include <climits>
+#else
+#include <cerrno>
+#include <climits>
+#include <sys/uio.h>
+#include <unistd.h>
+#endif
+
+#if !defined(_WIN32) && !defined(IOV_MAX)
+#define IOV_MAX 1024
+#endif
+
+namespace KiCAS2 {
+
+OutputBuilder::OutputBuilder(size_t chunk_size)
+    : chunk_size(chunk_size) {
+    assert(chunk_size != 0);
+}
+
+char* OutputBuilder::reserve(size_t n) {
+    if(!chunks.empty()){
+        Chunk& chunk = chunks[active];
+        if(chunk.capacity - chunk.size >= n) return chunk.data.get() + chunk.size;
+
+        // Leave the unused tail of a partially written chunk, but an empty chunk is simply too small
+        if(chunk.size != 0) active++;
+    }
+
+    // Chunks beyond the active one are empty chunks retained by clear()
+    if(active < chunks.size() && chunks[active].capacity >= n) return chunks[active].data.get();
+
+    const size_t capacity = std::max(chunk_size, n);
+    chunks.insert(chunks.begin() + active, Chunk{std::unique_ptr<char[]>(new char[capacity]), capacity, 0});
+
+    return chunks[active].data.get();
+}
+
+void OutputBuilder::commit(size_t n) noexcept {
+    assert(!chunks.empty());
+    assert(chunks[active].capacity - chunks[active].size >= n);
+    chunks[active].size += n;
+    total_size += n;
+}
+
+void OutputBuilder::append(std::string_view str) {
+    memcpy(reserve(str.size()), str.data(), str.size());
+    commit(str.size());
+}
+
+void OutputBuilder::append(char ch) {
+    *reserve(1) = ch;
+    commit(1);
+}
+
+size_t OutputBuilder::size() const noexcept {
+    return total_size;
+}
+
+void OutputBuilder::clear() noexcept {
+    for(Chunk& chunk : chunks) chunk.size = 0;
+    active = 0;
+    total_size = 0;
+}
+
+void OutputBuilder::appendTo(std::string& str) const {
+    str.reserve(str.size() + total_size);
+    for(const Chunk& chunk : chunks){
+        if(chunk.size == 0) break;
+        str.append(chunk.data.get(), chunk.size);
+    }
+}
+
+std::string OutputBuilder::str() const {
+    std::string str;
+    appendTo(str);
+    return str;
+}
+
+bool OutputBuilder::writeTo(int fd) const {
+#ifndef _WIN32
+    std::vector<iovec> buffers;
+    buffers.reserve(active + 1);
+    for(const Chunk& chunk : chunks){
+        if(chunk.size == 0) break;
+        buffers.push_back(iovec{chunk.data.get(), chunk.size});
+    }
+
+    size_t index = 0;
+    while(index < buffers.size()){
+        const int count = static_cast<int>(std::min<size_t>(buffers.size() - index, IOV_MAX));
+        const ssize_t written = ::writev(fd, buffers.data() + index, count);
+        if(written < 0){
+            if(errno == EINTR) continue;
+            return true;
+        }
+
+        // Skip past whatever was written, which may end partway through a buffer
+        size_t remaining = static_cast<size_t>(written);
+        while(index < buffers.size() && remaining >= buffers[index].iov_len)
+            remaining -= buffers[index++].iov_len;
+        if(remaining != 0){
+            buffers[index].iov_base = static_cast<char*>(buffers[index].iov_base) + remaining;
+            buffers[index].iov_len -= remaining;
+        }
+    }
+#else
+    for(const Chunk& chunk : chunks){
+        if(chunk.size == 0) break;
+
+        const char* data = chunk.data.get();
+        size_t remaining = chunk.size;
+        while(remaining != 0){
+            const unsigned count = static_cast<unsigned>(std::min<size_t>(remaining, INT_MAX));
+            const int written = ::_write(fd, data, count);
+            if(written < 0) return true;
+            data += written;
+            remaining -= static_cast<size_t>(written);
+        }
+    }
+#endif
+
+    return false;
+}
+
+}  // namespace KiCAS2
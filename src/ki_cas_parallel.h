@@ -0,0 +1,39 @@
+#ifndef KI_CAS_PARALLEL_H
+#define KI_CAS_PARALLEL_H
+
+#include <algorithm>
+#include <stddef.h>
+#include <thread>
+#include <vector>
+
+namespace KiCAS2 {
+
+/// Values per thread below which spawning another thread costs more than it saves
+inline constexpr size_t MIN_VALUES_PER_THREAD = 4096;
+
+/// Size of the blocks which parallel_for splits [0, n) into, the last of which may be shorter
+inline size_t parallel_block_size(size_t n, size_t num_threads) noexcept {
+    num_threads = std::max<size_t>(1, std::min(num_threads, n / MIN_VALUES_PER_THREAD));
+    return num_threads == 1 ? n : (n + num_threads - 1) / num_threads;
+}
+
+/// Call f(begin, end) over disjoint blocks covering [0, n), one block per thread
+template<typename Function>
+void parallel_for(size_t n, size_t num_threads, Function f) {
+    const size_t block_size = parallel_block_size(n, num_threads);
+    if(block_size == n){
+        f(size_t(0), n);
+        return;
+    }
+
+    std::vector<std::thread> threads;
+    threads.reserve((n - 1) / block_size);
+    for(size_t begin = block_size; begin < n; begin += block_size)
+        threads.emplace_back(f, begin, std::min(n, begin + block_size));
+    f(size_t(0), block_size);
+    for(std::thread& thread : threads) thread.join();
+}
+
+}  // namespace KiCAS2
+
+#endif // KI_CAS_PARALLEL_H
@@ -0,0 +1,223 @@
+#include "ki_cas_rational_accumulator.h"
+
+#include "ki_cas_native_integer.h"
+#include "ki_cas_wide_integer.h"
+#include <algorithm>
+#include <cassert>
+
+namespace KiCAS2 {
+
+/// Add the double-word product a*b to a three-word integer, most significant word first
+static void add_product(size_t words[3], size_t a, size_t b) noexcept {
+    size_t high;
+    const size_t low = mul_wide(a, b, &high);
+    words[2] += low;
+    const size_t carry = words[2] < low;
+    words[1] += high;
+    words[0] += words[1] < high;
+    words[1] += carry;
+    words[0] += words[1] < carry;
+}
+
+/// Multiply a three-word integer, most significant word first, by a word where the product fits
+static void mul_words(size_t words[3], size_t factor) noexcept {
+    size_t high_of_low;
+    size_t high_of_middle;
+    words[2] = mul_wide(words[2], factor, &high_of_low);
+    words[1] = mul_wide(words[1], factor, &high_of_middle);
+    words[0] = words[0] * factor + high_of_middle;
+    words[1] += high_of_low;
+    words[0] += words[1] < high_of_low;
+}
+
+/// Set the four words of product, most significant first, to a three-word integer times a word
+static void mul_words_wide(size_t product[4], const size_t words[3], size_t factor) noexcept {
+    size_t carry = 0;
+    for(size_t i = 3; i-- > 0;){
+        size_t high;
+        product[i+1] = mul_wide(words[i], factor, &high) + carry;
+        carry = high + (product[i+1] < carry);  // The high word of a product is at most one below the maximum
+    }
+    product[0] = carry;
+}
+
+/// Add the double-word product a*b to a four-word integer, most significant word first, where the sum fits
+static void add_product_wide(size_t words[4], size_t a, size_t b) noexcept {
+    size_t high;
+    const size_t low = mul_wide(a, b, &high);
+    words[3] += low;
+    size_t carry = high + (words[3] < low);
+    for(size_t i = 3; carry != 0;){
+        assert(i > 0);
+        words[--i] += carry;
+        carry = words[i] < carry;
+    }
+}
+
+RationalSumAccumulator::RationalSumAccumulator() noexcept
+    : num{0, 0, 0}, den(1) {}
+
+bool RationalSumAccumulator::reduceInPlace() noexcept {
+    if((num[0] | num[1] | num[2]) == 0){
+        const bool changed = (den != 1);
+        den = 1;
+        return changed;
+    }
+
+    const size_t gcd = binary_gcd(num, 3, den);
+    if(gcd == 1) return false;
+    divexact_words(num, 3, gcd);
+    den /= gcd;
+    return true;
+}
+
+bool RationalSumAccumulator::ckd_add(NativeRational val) noexcept {
+    if(val.num == 0) return false;
+
+    // Once the running denominator is a common multiple, as for terms from a small set of denominators,
+    // terms are scaled up to it without a gcd
+    if(den % val.den == 0){
+        add_product(num, val.num, den / val.den);
+        return false;
+    }
+
+    // a/b + c/d = (a*(d/g) + c*(b/g)) / (b*(d/g)) where g = gcd(b, d)
+    const size_t gcd = binary_gcd(den, val.den);
+    size_t lcm;
+    if(ckd_mul(&lcm, den, val.den / gcd)) return ckd_add_reduced(val);
+
+    mul_words(num, val.den / gcd);
+    add_product(num, val.num, den / gcd);
+    den = lcm;
+
+    return false;
+}
+
+bool RationalSumAccumulator::ckd_add_reduced(NativeRational val) noexcept {
+    reduceInPlace();
+    val.reduceInPlace();
+
+    // For reduced operands, every factor the sum shares with the double-word lcm divides g = gcd(b, d)
+    const size_t gcd = binary_gcd(den, val.den);
+    size_t wide_num[4];  // Most significant word first
+    mul_words_wide(wide_num, num, val.den / gcd);
+    add_product_wide(wide_num, val.num, den / gcd);
+
+    const size_t common = binary_gcd(wide_num, 4, gcd);
+    size_t reduced_den;
+    if(ckd_mul(&reduced_den, den / gcd, val.den / common)) return true;
+    if(common != 1) divexact_words(wide_num, 4, common);
+    assert(wide_num[0] == 0);  // Bounded as the numerator over a word-sized denominator
+
+    std::copy_n(wide_num + 1, 3, num);
+    den = reduced_den;
+
+    return false;
+}
+
+bool RationalSumAccumulator::ckd_add_product(NativeRational a, NativeRational b) noexcept {
+    NativeRational product;
+    return ckd_mul(&product, a, b) || ckd_add(product);
+}
+
+bool RationalSumAccumulator::ckd_result(NativeRational* result) const noexcept {
+    if((num[0] | num[1] | num[2]) == 0){
+        *result = NativeRational(0, 1);
+        return false;
+    }
+
+    size_t reduced[3] = {num[0], num[1], num[2]};
+    const size_t gcd = binary_gcd(reduced, 3, den);
+    if(gcd != 1) divexact_words(reduced, 3, gcd);
+    if((reduced[0] | reduced[1]) != 0) return true;
+
+    *result = NativeRational(reduced[2], den / gcd);
+    return false;
+}
+
+RationalProductAccumulator::RationalProductAccumulator() noexcept
+    : val(1, 1) {}
+
+void RationalProductAccumulator::mul(NativeRational factor) {
+    NativeRational product;
+    if(ckd_mul(&product, val, factor) == false){
+        val = product;
+        return;
+    }
+
+    if(val.num != 1) num_factors.push_back(val.num);
+    if(val.den != 1) den_factors.push_back(val.den);
+    val = factor;
+}
+
+void RationalProductAccumulator::div(NativeRational factor) {
+    mul(factor.reciprocal());
+}
+
+void RationalProductAccumulator::cancel() {
+    // A zero running value absorbs every later factor, and so every parked factor
+    if(val.num == 0){
+        num_factors.clear();
+        den_factors.clear();
+    }
+
+    if(num_factors.empty() && den_factors.empty()){
+        val.reduceInPlace();
+        return;
+    }
+
+    if(val.num != 1) num_factors.push_back(val.num);
+    if(val.den != 1) den_factors.push_back(val.den);
+    val = NativeRational(1, 1);
+
+    for(size_t& num_factor : num_factors){
+        for(size_t& den_factor : den_factors){
+            if(num_factor == 1) break;
+            const size_t gcd = binary_gcd(num_factor, den_factor);
+            if(gcd != 1){
+                num_factor /= gcd;
+                den_factor /= gcd;
+            }
+        }
+    }
+
+    const auto is_one = [](size_t factor){ return factor == 1; };
+    num_factors.erase(std::remove_if(num_factors.begin(), num_factors.end(), is_one), num_factors.end());
+    den_factors.erase(std::remove_if(den_factors.begin(), den_factors.end(), is_one), den_factors.end());
+}
+
+bool RationalProductAccumulator::ckd_result(NativeRational* result) {
+    cancel();
+    if(num_factors.empty() && den_factors.empty()){
+        *result = val;
+        return false;
+    }
+
+    size_t num = 1;
+    size_t den = 1;
+    for(const size_t factor : num_factors) if(ckd_mul(&num, num, factor)) return true;
+    for(const size_t factor : den_factors) if(ckd_mul(&den, den, factor)) return true;
+
+    // The canonical product fits, so the chain continues natively from it
+    num_factors.clear();
+    den_factors.clear();
+    val = NativeRational(num, den);
+    *result = val;
+    return false;
+}
+
+bool ckd_sum(NativeRational* result, const NativeRational* vals, size_t num_vals) noexcept {
+    RationalSumAccumulator sum;
+    for(size_t i = 0; i < num_vals; i++) if(sum.ckd_add(vals[i])) return true;
+
+    return sum.ckd_result(result);
+}
+
+bool ckd_dot(NativeRational* result, const NativeRational* a, const NativeRational* b, size_t num_vals) noexcept {
+    RationalSumAccumulator sum;
+    for(size_t i = 0; i < num_vals; i++) if(sum.ckd_add_product(a[i], b[i])) return true;
+
+    return sum.ckd_result(result);
+}
+
+}  // namespace KiCAS2
@@ -0,0 +1,177 @@
+#include "ki_cas_rational_sort.h"
+
+#include "ki_cas_parallel.h"
+#include "ki_cas_wide_integer.h"
+#include <algorithm>
+#include <cassert>
+#include <limits>
+#include <thread>
+#include <vector>
+
+namespace KiCAS2 {
+
+static constexpr size_t WORD_BITS = std::numeric_limits<size_t>::digits;
+
+/// Enough bits for the binary exponents of NativeRationals, which lie in [-WORD_BITS, WORD_BITS)
+static constexpr size_t KEY_EXPONENT_BITS = (WORD_BITS == 64) ? 7 : 6;
+static constexpr size_t KEY_FRACTION_BITS = WORD_BITS - KEY_EXPONENT_BITS;
+
+/// The top bits of the key which are radix sorted, leaving runs which agree in them for comparison sorting
+static constexpr size_t RADIX_DIGIT_BITS = 11;
+static constexpr size_t RADIX_NUM_DIGITS = 3;
+static constexpr size_t RADIX_SHIFT = WORD_BITS > RADIX_DIGIT_BITS*RADIX_NUM_DIGITS ? WORD_BITS - RADIX_DIGIT_BITS*RADIX_NUM_DIGITS : 0;
+
+size_t rational_sort_key(NativeRational val) noexcept {
+    assert(val.den != 0);
+    if(val.num == 0) return 0;
+
+    // 2^exponent <= num/den < 2^(exponent+1), where the shifted side of each comparison fits in a word
+    const ptrdiff_t num_log = WORD_BITS - 1 - count_leading_zeros(val.num);
+    const ptrdiff_t den_log = WORD_BITS - 1 - count_leading_zeros(val.den);
+    ptrdiff_t exponent = num_log - den_log;
+    exponent -= exponent >= 0 ? (val.num >> exponent) < val.den : (val.num << -exponent) < val.den;
+
+    // floor(num/den * 2^shift), with a leading one followed by KEY_FRACTION_BITS bits
+    const ptrdiff_t shift = static_cast<ptrdiff_t>(KEY_FRACTION_BITS) - exponent;
+    size_t mantissa;
+    if(shift < 0){
+        mantissa = (val.num / val.den) >> -shift;
+    }else{
+        size_t high = 0;
+        size_t low = val.num;
+        if(shift >= static_cast<ptrdiff_t>(WORD_BITS)){
+            high = val.num << (shift - WORD_BITS);
+            low = 0;
+        }else if(shift != 0){
+            high = val.num >> (WORD_BITS - shift);
+            low = val.num << shift;
+        }
+        size_t remainder;
+        mantissa = div_wide(high, low, val.den, &remainder);
+    }
+    assert(mantissa >> KEY_FRACTION_BITS == 1);
+
+    const size_t biased_exponent = static_cast<size_t>(exponent + static_cast<ptrdiff_t>(WORD_BITS));
+    return (biased_exponent << KEY_FRACTION_BITS) | (mantissa ^ (size_t(1) << KEY_FRACTION_BITS));
+}
+
+namespace {
+
+struct SortEntry {
+    size_t key;
+    size_t index;
+};
+
+/// Orders entries by key, then exactly by value, then by index so that equal values keep their order
+class EntryLess {
+public:
+    explicit EntryLess(const NativeRational* vals) noexcept : vals(vals) {}
+
+    bool operator()(const SortEntry& a, const SortEntry& b) const noexcept {
+        if(a.key != b.key) return a.key < b.key;
+        if(vals[a.index] < vals[b.index]) return true;
+        if(vals[b.index] < vals[a.index]) return false;
+        return a.index < b.index;
+    }
+
+private:
+    const NativeRational* vals;
+};
+
+}  // namespace
+
+/// Stable least-significant-digit radix sort by the top bits of the key, skipping digits which every key shares.
+/// Keys which agree in those bits are left for break_ties, which is cheaper than further passes over every entry.
+static void radix_sort(SortEntry* entries, SortEntry* scratch, size_t num_entries) noexcept {
+    constexpr size_t NUM_BUCKETS = size_t(1) << RADIX_DIGIT_BITS;
+    constexpr size_t NUM_DIGITS = RADIX_NUM_DIGITS;
+    if(num_entries < 2) return;
+
+    // Digits from the least significant, where on 32-bit platforms the first overlaps the next harmlessly
+    size_t shifts[NUM_DIGITS];
+    for(size_t digit = 0; digit < NUM_DIGITS; digit++)
+        shifts[digit] = WORD_BITS - std::min(WORD_BITS, (NUM_DIGITS - digit)*RADIX_DIGIT_BITS);
+
+    // One read finds the counts of every digit
+    std::vector<size_t> counts(NUM_DIGITS * NUM_BUCKETS, 0);
+    for(size_t i = 0; i < num_entries; i++)
+        for(size_t digit = 0; digit < NUM_DIGITS; digit++)
+            counts[digit*NUM_BUCKETS + ((entries[i].key >> shifts[digit]) & (NUM_BUCKETS-1))]++;
+
+    SortEntry* src = entries;
+    SortEntry* dest = scratch;
+    for(size_t digit = 0; digit < NUM_DIGITS; digit++){
+        size_t* digit_counts = counts.data() + digit*NUM_BUCKETS;
+        if(digit_counts[(src[0].key >> shifts[digit]) & (NUM_BUCKETS-1)] == num_entries) continue;
+
+        size_t offset = 0;
+        for(size_t bucket = 0; bucket < NUM_BUCKETS; bucket++){
+            const size_t count = digit_counts[bucket];
+            digit_counts[bucket] = offset;
+            offset += count;
+        }
+
+        for(size_t i = 0; i < num_entries; i++)
+            dest[digit_counts[(src[i].key >> shifts[digit]) & (NUM_BUCKETS-1)]++] = src[i];
+        std::swap(src, dest);
+    }
+
+    if(src != entries) std::copy(src, src + num_entries, entries);
+}
+
+/// Sort runs which agree in the radix sorted bits of the key, comparing whole keys and then values exactly.
+/// Runs of duplicates are common and already in index order, so are only checked.
+static void break_ties(SortEntry* entries, size_t num_entries, const NativeRational* vals) {
+    size_t run_begin = 0;
+    for(size_t i = 1; i <= num_entries; i++){
+        if(i < num_entries && (entries[i].key >> RADIX_SHIFT) == (entries[run_begin].key >> RADIX_SHIFT)) continue;
+        if(i - run_begin > 1 && !std::is_sorted(entries + run_begin, entries + i, EntryLess(vals)))
+            std::sort(entries + run_begin, entries + i, EntryLess(vals));
+        run_begin = i;
+    }
+}
+
+/// Entries in ascending order of value, with equal values in index order
+static std::vector<SortEntry> sorted_entries(const NativeRational* vals, size_t num_vals, size_t num_threads) {
+    std::vector<SortEntry> entries(num_vals);
+    std::vector<SortEntry> scratch(num_vals);
+
+    parallel_for(num_vals, num_threads, [&entries, &scratch, vals](size_t begin, size_t end){
+        for(size_t i = begin; i < end; i++) entries[i] = SortEntry{rational_sort_key(vals[i]), i};
+        radix_sort(entries.data() + begin, scratch.data() + begin, end - begin);
+        break_ties(entries.data() + begin, end - begin, vals);
+    });
+
+    // Merge sorted blocks pairwise, with the merges of each round on separate threads
+    for(size_t width = parallel_block_size(num_vals, num_threads); width < num_vals; width *= 2){
+        std::vector<std::thread> threads;
+        for(size_t begin = 0; begin < num_vals; begin += 2*width){
+            const size_t middle = std::min(num_vals, begin + width);
+            const size_t end = std::min(num_vals, begin + 2*width);
+            threads.emplace_back([&entries, &scratch, vals, begin, middle, end](){
+                std::merge(entries.begin() + begin, entries.begin() + middle,
+                           entries.begin() + middle, entries.begin() + end,
+                           scratch.begin() + begin, EntryLess(vals));
+            });
+        }
+        for(std::thread& thread : threads) thread.join();
+        entries.swap(scratch);
+    }
+
+    return entries;
+}
+
+void sort_native_rationals(NativeRational* vals, size_t num_vals, size_t num_threads) {
+    const std::vector<SortEntry> entries = sorted_entries(vals, num_vals, num_threads);
+    const std::vector<NativeRational> unsorted(vals, vals + num_vals);
+    parallel_for(num_vals, num_threads, [&entries, &unsorted, vals](size_t begin, size_t end){
+        for(size_t i = begin; i < end; i++) vals[i] = unsorted[entries[i].index];
+    });
+}
+
+void argsort_native_rationals(size_t* indices, const NativeRational* vals, size_t num_vals, size_t num_threads) {
+    const std::vector<SortEntry> entries = sorted_entries(vals, num_vals, num_threads);
+    for(size_t i = 0; i < num_vals; i++) indices[i] = entries[i].index;
+}
+
+}  // namespace KiCAS2
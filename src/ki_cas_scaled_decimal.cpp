@@ -0,0 +1,212 @@
+#include "ki_cas_scaled_decimal.h"
+
+#include "ki_cas_digit_writing.h"
+#include "ki_cas_native_integer.h"
+#include "ki_cas_wide_integer.h"
+#include <algorithm>
+#include <cassert>
+#include <limits>
+#include <utility>
+
+namespace KiCAS2 {
+
+/// Returns true if mantissa * 10^power overflows
+static bool ckd_scale(size_t* result, size_t mantissa, size_t power) noexcept {
+    if(mantissa == 0){
+        *result = 0;
+        return false;
+    }
+
+    return power >= NUM_POWERS_OF_TEN || ckd_mul(result, mantissa, powers_of_ten[power]);
+}
+
+/// Returns true if the exponent is outside the range of a ScaledDecimal
+static bool ckd_exponent(int16_t* result, ptrdiff_t exponent) noexcept {
+    if(exponent < std::numeric_limits<int16_t>::min() || exponent > std::numeric_limits<int16_t>::max()) return true;
+    *result = static_cast<int16_t>(exponent);
+    return false;
+}
+
+ScaledDecimal::ScaledDecimal(size_t mantissa, int16_t exponent) noexcept
+    : mantissa(mantissa), exponent(exponent) {}
+
+/// Three-way comparison by value
+static int compare(ScaledDecimal a, ScaledDecimal b) noexcept {
+    if(a.exponent == b.exponent) return (a.mantissa > b.mantissa) - (a.mantissa < b.mantissa);
+
+    // Align the operand with the larger exponent down to the other,
+    // where an aligned mantissa which overflows is necessarily the larger
+    const bool swapped = a.exponent < b.exponent;
+    if(swapped) std::swap(a, b);
+
+    size_t a_scaled;
+    const int comparison = ckd_scale(&a_scaled, a.mantissa, static_cast<size_t>(a.exponent - b.exponent))
+                           ? 1 : (a_scaled > b.mantissa) - (a_scaled < b.mantissa);
+
+    return swapped ? -comparison : comparison;
+}
+
+bool operator==(ScaledDecimal a, ScaledDecimal b) noexcept {
+    return compare(a, b) == 0;
+}
+
+bool operator!=(ScaledDecimal a, ScaledDecimal b) noexcept {
+    return compare(a, b) != 0;
+}
+
+bool operator>(ScaledDecimal a, ScaledDecimal b) noexcept {
+    return compare(a, b) > 0;
+}
+
+bool operator>=(ScaledDecimal a, ScaledDecimal b) noexcept {
+    return compare(a, b) >= 0;
+}
+
+bool operator<(ScaledDecimal a, ScaledDecimal b) noexcept {
+    return compare(a, b) < 0;
+}
+
+bool operator<=(ScaledDecimal a, ScaledDecimal b) noexcept {
+    return compare(a, b) <= 0;
+}
+
+bool ckd_mul(ScaledDecimal* result, ScaledDecimal a, ScaledDecimal b) noexcept {
+    return ckd_mul(&result->mantissa, a.mantissa, b.mantissa)
+           || ckd_exponent(&result->exponent, static_cast<ptrdiff_t>(a.exponent) + b.exponent);
+}
+
+bool ckd_add(ScaledDecimal* result, ScaledDecimal a, ScaledDecimal b) noexcept {
+    // Align to the smaller exponent, so neither operand loses decimal places
+    if(a.exponent < b.exponent) std::swap(a, b);
+
+    size_t a_scaled;
+    if(ckd_scale(&a_scaled, a.mantissa, static_cast<size_t>(a.exponent - b.exponent))
+       || ckd_add(&result->mantissa, a_scaled, b.mantissa)) return true;
+
+    result->exponent = b.exponent;
+    return false;
+}
+
+bool ckd_sub(ScaledDecimal* result, ScaledDecimal a, ScaledDecimal b) noexcept {
+    assert(a >= b);
+
+    if(a.exponent <= b.exponent){
+        // The aligned subtrahend is at most the minuend, so fits
+        size_t b_scaled;
+        const bool overflow = ckd_scale(&b_scaled, b.mantissa, static_cast<size_t>(b.exponent - a.exponent));
+        assert(!overflow);
+        (void)overflow;
+        *result = ScaledDecimal(a.mantissa - b_scaled, a.exponent);
+        return false;
+    }
+
+    // A zero minuend leaves a zero subtrahend, which no exponent gap can overflow
+    if(a.mantissa == 0){
+        *result = ScaledDecimal(0, b.exponent);
+        return false;
+    }
+
+    // The aligned minuend may overflow while the difference fits
+    const size_t power = static_cast<size_t>(a.exponent - b.exponent);
+    if(power >= NUM_POWERS_OF_TEN) return true;
+    size_t high;
+    const size_t low = mul_wide(a.mantissa, powers_of_ten[power], &high);
+    if(high - (low < b.mantissa) != 0) return true;
+
+    *result = ScaledDecimal(low - b.mantissa, b.exponent);
+    return false;
+}
+
+/// Upper bound on the chars write_scaled_decimal may use, including the slot for the decimal point
+static size_t scaled_decimal_str_upperbound(ScaledDecimal val) noexcept {
+    // Decimal point and slot, leading zero, exponent marker, sign and digits, with some to spare
+    static constexpr size_t OVERHEAD = 16;
+    const size_t abs_exponent = static_cast<size_t>(val.exponent < 0 ? -val.exponent : val.exponent);
+    return std::numeric_limits<size_t>::digits10 + 1 + abs_exponent + OVERHEAD;
+}
+
+static char* write_scaled_decimal(char* dest, ScaledDecimal val, FloatNotation notation) noexcept {
+    // Digits are written one past the destination, leaving a slot for the decimal point
+    const size_t num_digits = count_base10_digits(val.mantissa);
+    write_base10_digits(dest+1, val.mantissa, num_digits);
+    return layout_scaled_decimal(dest, num_digits, val.exponent, notation);
+}
+
+void write_scaled_decimal(std::string& str, ScaledDecimal val, FloatNotation notation) {
+    const size_t start_index = str.size();
+    str.resize(start_index + scaled_decimal_str_upperbound(val));
+    const char* end = write_scaled_decimal(str.data() + start_index, val, notation);
+    str.resize(end - str.data());
+}
+
+void write_scaled_decimal(OutputBuilder& out, ScaledDecimal val, FloatNotation notation) {
+    char* buffer = out.reserve(scaled_decimal_str_upperbound(val));
+    const char* end = write_scaled_decimal(buffer, val, notation);
+    out.commit(end - buffer);
+}
+
+/// Set a ScaledDecimal from decimal digits scaled by 10^exponent.
+/// Returns true if the value is too large to fit.
+static bool ckd_strdecimal2scaled(ScaledDecimal* result, std::string_view str, ptrdiff_t exponent) noexcept {
+    const size_t decimal_index = std::min(str.find('.'), str.size());
+    #ifndef NDEBUG
+    for(size_t i = 0; i < str.size(); i++) assert((str[i] >= '0' && str[i] <= '9') || (i == decimal_index));
+    #endif
+
+    // Leading zeros do not contribute digits, including those of the fraction if there is no integer part
+    size_t integer_start = 0;
+    while(integer_start < decimal_index && str[integer_start] == '0') integer_start++;
+    const std::string_view integer_digits = str.substr(integer_start, decimal_index - integer_start);
+    std::string_view fraction_digits = str.substr(std::min(decimal_index+1, str.size()));
+    exponent -= static_cast<ptrdiff_t>(fraction_digits.size());
+    if(integer_digits.empty()){
+        size_t fraction_start = 0;
+        while(fraction_start < fraction_digits.size() && fraction_digits[fraction_start] == '0') fraction_start++;
+        fraction_digits.remove_prefix(fraction_start);
+    }
+
+    auto digit = [&](size_t i){
+        return (i < integer_digits.size()) ? integer_digits[i] : fraction_digits[i - integer_digits.size()];
+    };
+
+    // Trailing zeros move into the exponent only when the digits would not otherwise fit
+    constexpr size_t MAX_DIGITS = std::numeric_limits<size_t>::digits10 + 1;
+    size_t num_digits = integer_digits.size() + fraction_digits.size();
+    while(num_digits > MAX_DIGITS && digit(num_digits-1) == '0'){
+        num_digits--;
+        exponent++;
+    }
+    if(num_digits > MAX_DIGITS) return true;
+
+    // Only the last of the maximum number of digits can overflow
+    size_t mantissa = 0;
+    const size_t num_unchecked_digits = std::min(num_digits, MAX_DIGITS-1);
+    for(size_t i = 0; i < num_unchecked_digits; i++) mantissa = 10*mantissa + static_cast<size_t>(digit(i) - '0');
+    if(num_digits == MAX_DIGITS
+       && (ckd_mul(&mantissa, mantissa, 10) || ckd_add(&mantissa, mantissa, static_cast<size_t>(digit(MAX_DIGITS-1) - '0'))))
+        return true;
+
+    result->mantissa = mantissa;
+    return ckd_exponent(&result->exponent, exponent);
+}
+
+bool ckd_strdecimal2scaled(ScaledDecimal* result, std::string_view str) noexcept {
+    return ckd_strdecimal2scaled(result, str, 0);
+}
+
+bool ckd_strscientific2scaled(ScaledDecimal* result, std::string_view str) noexcept {
+    const size_t e_index = str.find('e');
+    assert(e_index != std::string::npos);
+    const size_t e_start = e_index+1;
+    const bool is_negative = (str[e_start] == '-');
+    const size_t digits_start = e_start + (is_negative || str[e_start] == '+');
+
+    size_t exp;
+    if(ckd_str2int(&exp, str.substr(digits_start)) || exp > static_cast<size_t>(std::numeric_limits<ptrdiff_t>::max() / 2))
+        return true;
+
+    const ptrdiff_t exponent = is_negative ? -static_cast<ptrdiff_t>(exp) : static_cast<ptrdiff_t>(exp);
+    return ckd_strdecimal2scaled(result, str.substr(0, e_index), exponent);
+}
+
+}  // namespace KiCAS2
@@ -0,0 +1,207 @@
+#ifndef KI_CAS_WIDE_INTEGER_H
+#define KI_CAS_WIDE_INTEGER_H
+
+#include <cassert>
+#include <limits>
+#include <stddef.h>
+
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
+
+#if !defined(__x86_64__) && !defined(__aarch64__) && !defined(_WIN64)  // 32-bit
+static_assert(sizeof(size_t)*8 == 32);
+#include <cstdint>
+#endif
+
+#if defined(_MSC_VER) && defined(_M_ARM64)  // 64-bit ARM MSVC
+#include <cstdint>
+
+// MSVC on arm64 does not have any way to multiply 128-bit numbers using intrinsics.
+// We would rather create this function than include boost_multiprecision.
+inline uint64_t _umul128(uint64_t a, uint64_t b, uint64_t* result_high) {
+    uint64_t a_lo = static_cast<uint32_t>(a);
+    uint64_t a_hi = a >> 32;
+    uint64_t b_lo = static_cast<uint32_t>(b);
+    uint64_t b_hi = b >> 32;
+
+    uint64_t p0 = a_lo * b_lo;
+    uint64_t p1 = a_lo * b_hi;
+    uint64_t p2 = a_hi * b_lo;
+    uint64_t p3 = a_hi * b_hi;
+
+    uint64_t mid = (p0 >> 32) + static_cast<uint32_t>(p1) + static_cast<uint32_t>(p2);
+
+    *result_high = p3 + (p1 >> 32) + (p2 >> 32) + (mid >> 32);
+    return (p0 & 0xffffffffull) | (mid << 32);
+}
+
+// Nor is there a 128-bit by 64-bit division, so shift and subtract one bit at a time.
+inline uint64_t _udiv128(uint64_t high, uint64_t low, uint64_t divisor, uint64_t* remainder) {
+    uint64_t quotient = 0;
+    for(int i = 0; i < 64; i++){
+        const bool carry = (high >> 63) != 0;
+        high = (high << 1) | (low >> 63);
+        low <<= 1;
+        quotient <<= 1;
+        if(carry || high >= divisor){
+            high -= divisor;
+            quotient |= 1;
+        }
+    }
+    *remainder = high;
+    return quotient;
+}
+#endif
+
+namespace KiCAS2 {
+
+/// Number of trailing zero bits of a nonzero word
+inline size_t count_trailing_zeros(size_t val) noexcept {
+    assert(val != 0);
+#if defined(_MSC_VER)
+    unsigned long index;
+#if defined(_WIN64)
+    _BitScanForward64(&index, val);
+#else
+    _BitScanForward(&index, val);
+#endif
+    return index;
+#else
+    return static_cast<size_t>(__builtin_ctzll(val));
+#endif
+}
+
+/// Number of leading zero bits of a nonzero word
+inline size_t count_leading_zeros(size_t val) noexcept {
+    assert(val != 0);
+#if defined(_MSC_VER)
+    unsigned long index;
+#if defined(_WIN64)
+    _BitScanReverse64(&index, val);
+#else
+    _BitScanReverse(&index, val);
+#endif
+    return std::numeric_limits<size_t>::digits - 1 - index;
+#else
+    return static_cast<size_t>(__builtin_clzll(val)) - (64 - std::numeric_limits<size_t>::digits);
+#endif
+}
+
+/// Greatest common divisor by Stein's algorithm, which shifts out factors of 2 rather than dividing
+inline size_t binary_gcd(size_t a, size_t b) noexcept {
+    if(a == 0) return b;
+    if(b == 0) return a;
+
+    const size_t a_zeros = count_trailing_zeros(a);
+    const size_t b_zeros = count_trailing_zeros(b);
+    const size_t shift = a_zeros < b_zeros ? a_zeros : b_zeros;
+    a >>= a_zeros;
+    b >>= b_zeros;
+
+    // The wrapped difference has the same trailing zeros as its magnitude,
+    // so counting them does not wait on the comparison
+    while(a != b){
+        const size_t diff = a - b;
+        const size_t magnitude = a < b ? b - a : diff;
+        b = a < b ? a : b;
+        a = magnitude >> count_trailing_zeros(diff);
+    }
+
+    return a << shift;
+}
+
+/// Inverse of an odd word modulo 2^bits by Newton's iteration, each step doubling the correct low bits
+inline size_t inverse_mod_word(size_t odd) noexcept {
+    assert(odd & 1);
+    size_t inverse = (3 * odd) ^ 2;  // Correct to 5 bits
+    for(size_t bits = 5; bits < std::numeric_limits<size_t>::digits; bits *= 2) inverse *= 2 - odd * inverse;
+    return inverse;
+}
+
+/// Full double-word product of two words, returning the low word and setting the high word
+inline size_t mul_wide(size_t a, size_t b, size_t* high) noexcept {
+#if defined( _WIN64 ) && defined(_MSC_VER)  // 64-bit MSVC
+    return _umul128(a, b, high);
+#elif defined(__x86_64__) || defined(__aarch64__)  // 64-bit GCC or Clang
+    const __uint128_t product = static_cast<__uint128_t>(a) * static_cast<__uint128_t>(b);
+    *high = static_cast<size_t>(product >> 64);
+    return static_cast<size_t>(product);
+#else  // 32-bit
+    const uint64_t product = static_cast<uint64_t>(a) * static_cast<uint64_t>(b);
+    *high = static_cast<size_t>(product >> 32);
+    return static_cast<size_t>(product);
+#endif
+}
+
+/// Divide the double word (high, low) by a divisor greater than high, returning the quotient and setting the remainder
+inline size_t div_wide(size_t high, size_t low, size_t divisor, size_t* remainder) noexcept {
+    assert(high < divisor);
+#if defined( _WIN64 ) && defined(_MSC_VER)  // 64-bit MSVC
+    return _udiv128(high, low, divisor, remainder);
+#elif defined(__x86_64__) || defined(__aarch64__)  // 64-bit GCC or Clang
+    const __uint128_t dividend = (static_cast<__uint128_t>(high) << 64) | low;
+    const size_t quotient = static_cast<size_t>(dividend / divisor);
+    *remainder = low - quotient * divisor;
+    return quotient;
+#else  // 32-bit
+    const uint64_t dividend = (static_cast<uint64_t>(high) << 32) | low;
+    const size_t quotient = static_cast<size_t>(dividend / divisor);
+    *remainder = low - quotient * divisor;
+    return quotient;
+#endif
+}
+
+/// Set the three words of sum, most significant first, to the sum of two double words
+inline void add_wide(size_t sum[3], size_t a_high, size_t a_low, size_t b_high, size_t b_low) noexcept {
+    sum[2] = a_low + b_low;
+    const size_t carry = sum[2] < a_low;
+    sum[1] = a_high + b_high;
+    sum[0] = sum[1] < a_high;
+    sum[1] += carry;
+    sum[0] += sum[1] < carry;
+}
+
+/// Set the three words of difference, most significant first, to the difference of two double words, where a ≥ b
+inline void sub_wide(size_t difference[3], size_t a_high, size_t a_low, size_t b_high, size_t b_low) noexcept {
+    difference[0] = 0;
+    difference[2] = a_low - b_low;
+    const size_t borrow = a_low < b_low;
+    assert(a_high >= b_high + borrow);
+    difference[1] = a_high - b_high - borrow;
+}
+
+/// Return the remainder of a multi-word integer, most significant word first, divided by a word
+inline size_t mod_words(const size_t* words, size_t num_words, size_t divisor) noexcept {
+    size_t remainder = 0;
+    for(size_t i = 0; i < num_words; i++){
+        if(remainder == 0 && words[i] < divisor) remainder = words[i];  // Skip leading words below the divisor
+        else div_wide(remainder, words[i], divisor, &remainder);
+    }
+    return remainder;
+}
+
+/// Greatest common divisor of a multi-word integer, most significant word first, and a nonzero word.
+/// A single remainder brings the wide operand down to a word, which is cheaper than shifting it bitwise.
+inline size_t binary_gcd(const size_t* words, size_t num_words, size_t divisor) noexcept {
+    assert(divisor != 0);
+    return binary_gcd(mod_words(words, num_words, divisor), divisor);
+}
+
+/// Divide a multi-word integer, most significant word first, by a word which divides it exactly
+inline void divexact_words(size_t* words, size_t num_words, size_t divisor) noexcept {
+    size_t remainder = 0;
+    for(size_t i = 0; i < num_words; i++){
+        if(remainder == 0 && words[i] < divisor){  // Skip leading words below the divisor
+            remainder = words[i];
+            words[i] = 0;
+        }else{
+            words[i] = div_wide(remainder, words[i], divisor, &remainder);
+        }
+    }
+    assert(remainder == 0);
+}
+
+}  // namespace KiCAS2
+
+#endif // KI_CAS_WIDE_INTEGER_H
@@ -0,0 +1,94 @@
+#include <catch2/catch_test_macros.hpp>
+
+#include "ki_cas_batch_writer.h"
+
+#include <vector>
+
+using namespace KiCAS2;
+
+static constexpr size_t MAX = std::numeric_limits<size_t>::max();
+
+TEST_CASE( "write_native_rationals" ) {
+    std::string str = "x = ";
+
+    SECTION("Empty"){
+        write_native_rationals(str, nullptr, 0);
+        REQUIRE(str == "x = ");
+    }
+
+    SECTION("Plaintext"){
+        const NativeRational vals[] = {NativeRational(3, 2), NativeRational(5, 1), NativeRational(MAX, MAX-1)};
+        write_native_rationals(str, vals, 3, PLAINTEXT_BATCH_FORMAT);
+        REQUIRE(str == "x = 3/2, 5, " + std::to_string(MAX) + '/' + std::to_string(MAX-1));
+    }
+
+    SECTION("Typeset"){
+        const NativeRational vals[] = {NativeRational(3, 2), NativeRational(5, 1)};
+        write_native_rationals(str, vals, 2, TYPESET_BATCH_FORMAT);
+        REQUIRE(str == "x = ⁜f⏴3⏵⏴2⏵, ⁜f⏴5⏵⏴1⏵");
+    }
+
+    SECTION("Custom format"){
+        constexpr RationalBatchFormat format = {"\n", "-", "(", ")/(", ")", "", "", false};
+        const NativeRational vals[] = {NativeRational(3, 2), NativeRational(0, 1)};
+        write_native_rationals(str, vals, 2, format);
+        REQUIRE(str == "x = (3)/(2)\n(0)/(1)");
+    }
+
+    SECTION("Threaded matches per-value writer"){
+        std::vector<NativeRational> vals;
+        std::string expected = str;
+        for(size_t i = 0; i < 20000; i++){
+            vals.push_back(NativeRational(i * 2654435761uLL, i + 1));
+            if(i != 0) expected += ", ";
+            write_native_rational<TYPESET_OUTPUT>(expected, vals.back());
+        }
+
+        write_native_rationals(str, vals.data(), vals.size(), TYPESET_BATCH_FORMAT, 4);
+        REQUIRE(str == expected);
+    }
+}
+
+TEST_CASE( "write_big_rationals" ) {
+    std::string str = "x = ";
+
+    std::vector<fmpq> vals(20000);
+    for(size_t i = 0; i < vals.size(); i++){
+        fmpq_init(&vals[i]);
+        fmpz_set_si(fmpq_numref(&vals[i]), (i % 2 == 0) ? -static_cast<slong>(i) : static_cast<slong>(i));
+        if(i % 3 == 0) fmpz_fac_ui(fmpq_denref(&vals[i]), 30);
+        else fmpz_set_ui(fmpq_denref(&vals[i]), i % 3);
+        fmpq_canonicalise(&vals[i]);
+    }
+
+    SECTION("Plaintext"){
+        write_big_rationals(str, vals.data(), 4, PLAINTEXT_BATCH_FORMAT);
+        REQUIRE(str == "x = 0, 1, -1, 1/88417619937397019545436160000000");
+    }
+
+    SECTION("Typeset"){
+        write_big_rationals(str, vals.data(), 4, TYPESET_BATCH_FORMAT);
+        REQUIRE(str == "x = ⁜f⏴0⏵⏴1⏵, ⁜f⏴1⏵⏴1⏵, -⁜f⏴1⏵⏴1⏵, ⁜f⏴1⏵⏴88417619937397019545436160000000⏵");
+    }
+
+    SECTION("MathML"){
+        write_big_rationals(str, vals.data(), 4, batch_format<MathMLStyle>(""));
+        REQUIRE(str == "x = <mn>0</mn><mn>1</mn><mo>-</mo><mn>1</mn>"
+                       "<mfrac><mn>1</mn><mn>88417619937397019545436160000000</mn></mfrac>");
+    }
+
+    SECTION("Threaded matches per-value writer"){
+        std::string expected = str;
+        for(size_t i = 0; i < vals.size(); i++){
+            if(i != 0) expected += ", ";
+            write_big_rational<PLAINTEXT_OUTPUT>(expected, &vals[i]);
+        }
+
+        write_big_rationals(str, vals.data(), vals.size(), PLAINTEXT_BATCH_FORMAT, 4);
+        REQUIRE(str == expected);
+    }
+
+    for(fmpq& val : vals) fmpq_clear(&val);
+
+    LEAK_CHECK_REQUIRE(isAllGmpMemoryFreed_resetIfNot());
+}
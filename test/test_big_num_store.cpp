@@ -0,0 +1,132 @@
+#include <catch2/catch_test_macros.hpp>
+
+#include "ki_cas_big_num_store.h"
+#include <thread>
+#include <vector>
+
+using namespace KiCAS2;
+
+static constexpr size_t MAX = std::numeric_limits<size_t>::max();
+
+TEST_CASE( "BigNumStore" ){
+    fmpq_t big_rat;
+    fmpq_init(big_rat);
+    fmpq_set_ui(big_rat, MAX, 7);
+    fmpq_mul(big_rat, big_rat, big_rat);
+
+    SECTION("Equal values share a handle"){
+        BigNumStore store;
+        const BigNumStore::Handle handle = store.intern(big_rat);
+        REQUIRE(fmpq_equal(store.get(handle), big_rat));
+        REQUIRE(store.refCount(handle) == 1);
+
+        fmpq_t copy;
+        fmpq_init(copy);
+        fmpq_set(copy, big_rat);
+        REQUIRE(store.intern(copy) == handle);
+        REQUIRE(store.internClear(copy) == handle);
+        REQUIRE(store.refCount(handle) == 3);
+        REQUIRE(store.size() == 1);
+        REQUIRE(store.find(big_rat) == handle);
+        REQUIRE(store.heapBytes() == fmpq_heap_bytes(big_rat));
+
+        fmpq_neg(big_rat, big_rat);
+        REQUIRE(store.find(big_rat) == BigNumStore::NO_HANDLE);
+        REQUIRE(store.intern(big_rat) != handle);
+        REQUIRE(store.size() == 2);
+    }
+
+    SECTION("Integers are stored over 1"){
+        BigNumStore store;
+        fmpz_t big_int;
+        fmpz_init(big_int);
+        fmpz_set_ui(big_int, MAX);
+        fmpz_mul_ui(big_int, big_int, 3);
+        const BigNumStore::Handle handle = store.intern(big_int);
+
+        fmpq_set_fmpz_frac(big_rat, big_int, FMPZ_ONE);
+        REQUIRE(store.intern(big_rat) == handle);
+        REQUIRE(fmpz_is_one(fmpq_denref(store.get(handle))));
+        fmpz_clear(big_int);
+    }
+
+    SECTION("Arithmetic results are interned"){
+        BigNumStore store;
+        const BigNumStore::Handle a = store.intern(big_rat);
+        fmpq_set_ui(big_rat, 2, 1);
+        const BigNumStore::Handle two = store.intern(big_rat);
+
+        const BigNumStore::Handle doubled = store.mul(a, two);
+        REQUIRE(store.add(a, a) == doubled);
+        REQUIRE(store.refCount(doubled) == 2);
+        REQUIRE(store.div(doubled, two) == a);
+        REQUIRE(store.sub(doubled, a) == a);
+        REQUIRE(store.refCount(a) == 3);
+        REQUIRE(store.size() == 3);
+    }
+
+    SECTION("Collection frees unreferenced entries"){
+        BigNumStore store;
+        const BigNumStore::Handle a = store.intern(big_rat);
+        fmpq_add_ui(big_rat, big_rat, 1);
+        const BigNumStore::Handle b = store.intern(big_rat);
+
+        store.release(a);
+        REQUIRE(store.find(big_rat) == b);
+        REQUIRE(store.collect() == 1);
+        REQUIRE(store.size() == 1);
+        REQUIRE(store.heapBytes() == fmpq_heap_bytes(big_rat));
+        REQUIRE(store.find(big_rat) == b);
+
+        // Collected handles are reused, and a released entry is revived if found before collection
+        fmpq_add_ui(big_rat, big_rat, 1);
+        REQUIRE(store.intern(big_rat) == a);
+        store.release(a);
+        REQUIRE(store.intern(big_rat) == a);
+        REQUIRE(store.collect() == 0);
+    }
+
+    SECTION("Growth keeps handles valid"){
+        BigNumStore store;
+        std::vector<BigNumStore::Handle> handles;
+        for(size_t i = 0; i < 5000; i++){
+            fmpq_set_ui(big_rat, MAX - i, 3);
+            handles.push_back(store.intern(big_rat));
+        }
+        REQUIRE(store.size() == 5000);
+
+        for(size_t i = 0; i < 5000; i++){
+            fmpq_set_ui(big_rat, MAX - i, 3);
+            REQUIRE(store.find(big_rat) == handles[i]);
+            REQUIRE(fmpq_equal(store.get(handles[i]), big_rat));
+        }
+    }
+
+    SECTION("Concurrent interning agrees on handles"){
+        BigNumStore store;
+        constexpr size_t NUM_THREADS = 4;
+        constexpr size_t NUM_VALS = 2000;
+        std::vector<std::vector<BigNumStore::Handle>> handles(NUM_THREADS, std::vector<BigNumStore::Handle>(NUM_VALS));
+
+        std::vector<std::thread> threads;
+        for(size_t t = 0; t < NUM_THREADS; t++){
+            threads.emplace_back([&store, &handles, t](){
+                fmpq_t val;
+                fmpq_init(val);
+                for(size_t i = 0; i < NUM_VALS; i++){
+                    fmpq_set_ui(val, MAX - i, 5);
+                    handles[t][i] = store.intern(val);
+                }
+                fmpq_clear(val);
+            });
+        }
+        for(std::thread& thread : threads) thread.join();
+
+        REQUIRE(store.size() == NUM_VALS);
+        for(size_t t = 1; t < NUM_THREADS; t++) REQUIRE(handles[t] == handles[0]);
+        for(size_t i = 0; i < NUM_VALS; i++) REQUIRE(store.refCount(handles[0][i]) == NUM_THREADS);
+    }
+
+    fmpq_clear(big_rat);
+    LEAK_CHECK_REQUIRE(isAllGmpMemoryFreed_resetIfNot());
+}
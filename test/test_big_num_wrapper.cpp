@@ -1,6 +1,8 @@
 #include <catch2/catch_test_macros.hpp>
 
 #include "ki_cas_big_num_wrapper.h"
+#include "ki_cas_native_rational.h"
+#include <vector>
 
 using namespace KiCAS2;
 
@@ -104,6 +106,10 @@ TEST_CASE( "mpz_sizeinbase10upperbound" ) {
     REQUIRE(mpz_sizeinbase10upperbound(val) >= mpz_sizeinbase(val, 10));
     mpz_clear(val);
 
+    mpz_init_set_ui(val, MAX);
+    REQUIRE(mpz_sizeinbase10upperbound(val) >= mpz_sizeinbase(val, 10));
+    mpz_clear(val);
+
     mpz_init_set_str(val, "265252859812191058636308480000000", 10);
     REQUIRE(mpz_sizeinbase10upperbound(val) >= mpz_sizeinbase(val, 10));
     mpz_clear(val);
@@ -122,6 +128,10 @@ TEST_CASE( "fmpz_sizeinbase10upperbound" ) {
     REQUIRE(fmpz_sizeinbase10upperbound(val) >= fmpz_sizeinbase(val, 10));
     fmpz_clear(val);
 
+    fmpz_init_set_ui(val, MAX);
+    REQUIRE(fmpz_sizeinbase10upperbound(val) >= fmpz_sizeinbase(val, 10));
+    fmpz_clear(val);
+
     fmpz_init(val);
     fmpz_set_str(val, "265252859812191058636308480000000", 10);
     REQUIRE(fmpz_sizeinbase10upperbound(val) >= fmpz_sizeinbase(val, 10));
@@ -240,6 +250,78 @@ TEST_CASE( "write_big_int" ) {
     LEAK_CHECK_REQUIRE(isAllGmpMemoryFreed_resetIfNot());
 }
 
+TEST_CASE( "write_rational_as_decimal fmpq" ) {
+    std::string str = "x + ";
+    fmpq_t big_num;
+    fmpq_init(big_num);
+    fmpz* num = fmpq_numref(big_num);
+    fmpz* den = fmpq_denref(big_num);
+
+    SECTION("Small"){
+        fmpq_set_si(big_num, -7, 6);
+        write_rational_as_decimal(str, big_num);
+        REQUIRE(str == "x + -1.1(6)");
+        str.clear();
+        fmpq_set_si(big_num, 3, 8);
+        write_rational_as_decimal(str, big_num);
+        REQUIRE(str == "0.375");
+        str.clear();
+        fmpq_set_si(big_num, -5, 1);
+        write_rational_as_decimal(str, big_num);
+        REQUIRE(str == "-5");
+    }
+
+    SECTION("Terminating"){
+        fmpz_set_si(num, -1);
+        fmpz_one_2exp(den, 100);
+        write_rational_as_decimal(str, big_num, 100);
+        REQUIRE(str == "x + -0.0000000000000000000000000000007888609052210118054117285652827862296732064351090230047702789306640625");
+        str.clear();
+        write_rational_as_decimal(str, big_num);
+        REQUIRE(str == "-0.00000000000000000000000000000078...");
+    }
+
+    SECTION("Repeating"){
+        fmpz_set_ui(num, 1);
+        fmpz_one_2exp(den, 70);
+        fmpz_mul_ui(den, den, 3);
+        write_rational_as_decimal(str, big_num, 80);
+        REQUIRE(str == "x + 0.0000000000000000000002823443157514334463561075002265473206837972005208(3)");
+        str.clear();
+        fmpz_set_ui(num, 10);
+        fmpz_pow_ui(num, num, 25);
+        fmpz_add_ui(num, num, 1);
+        fmpz_set_ui(den, 10);
+        fmpz_pow_ui(den, den, 20);
+        fmpz_sub_ui(den, den, 1);
+        write_rational_as_decimal(str, big_num);
+        REQUIRE(str == "100000.(00000000000000100001)");
+    }
+
+    SECTION("Cut off"){
+        fmpz_set_ui(num, 1);
+        fmpz_fac_ui(den, 30);
+        write_rational_as_decimal(str, big_num);
+        REQUIRE(str == "x + 0.00000000000000000000000000000000...");
+    }
+
+    SECTION("Matches NativeRational"){
+        OutputBuilder out;
+        for(size_t i = 1; i < 2000; i++){
+            const NativeRational val(i * 2654435761u % 100003, i);
+            fmpq_set_ui(big_num, val.num, val.den);
+            fmpq_canonicalise(big_num);
+            write_rational_as_decimal(str, val, 40);
+            write_rational_as_decimal(out, big_num, 40);
+        }
+        REQUIRE(out.str() == str.substr(4));
+    }
+
+    fmpq_clear(big_num);
+
+    LEAK_CHECK_REQUIRE(isAllGmpMemoryFreed_resetIfNot());
+}
+
 TEST_CASE( "write_big_rational" ) {
     std::string str = "x + ";
     fmpq_t big_num;
@@ -299,11 +381,86 @@ TEST_CASE( "write_big_rational" ) {
         REQUIRE(str == "x + -⁜f⏴1⏵⏴265252859812191058636308480000000⏵");
     }
 
+    SECTION("plaintext integer"){
+        fmpq_set_si(big_num, -5, 1);
+        write_big_rational<PLAINTEXT_OUTPUT>(str, big_num);
+        REQUIRE(str == "x + -5");
+    }
+
+    SECTION("typeset integer"){
+        fmpq_set_si(big_num, 5, 1);
+        write_big_rational<TYPESET_OUTPUT>(str, big_num);
+        REQUIRE(str == "x + ⁜f⏴5⏵⏴1⏵");
+    }
+
+    SECTION("latex negative"){
+        fmpq_set_si(big_num, -3, 2);
+        write_big_rational<LatexStyle>(str, big_num);
+        REQUIRE(str == "x + -\\frac{3}{2}");
+    }
+
+    SECTION("latex integer"){
+        fmpq_set_si(big_num, 5, 1);
+        write_big_rational<LatexStyle>(str, big_num);
+        REQUIRE(str == "x + 5");
+    }
+
+    SECTION("mathml big negative"){
+        fmpz_set_si(num, -1);
+        fmpz_fac_ui(den, 30);
+        write_big_rational<MathMLStyle>(str, big_num);
+        REQUIRE(str == "x + <mo>-</mo><mfrac><mn>1</mn><mn>265252859812191058636308480000000</mn></mfrac>");
+    }
+
+    SECTION("mathml integer"){
+        fmpz_fac_ui(num, 30);
+        fmpz_set_ui(den, 1);
+        write_big_rational<MathMLStyle>(str, big_num);
+        REQUIRE(str == "x + <mn>265252859812191058636308480000000</mn>");
+    }
+
     fmpq_clear(big_num);
 
     LEAK_CHECK_REQUIRE(isAllGmpMemoryFreed_resetIfNot());
 }
 
+/// Writes each value natively and as an fmpq, requiring the same text whatever the representation
+template<typename Style>
+static void require_native_matches_fmpq(const std::vector<SignedNativeRational>& vals) {
+    for(SignedNativeRational val : vals){
+        std::string native;
+        write_native_rational<Style>(native, val);
+        OutputBuilder native_out;
+        write_native_rational<Style>(native_out, val);
+
+        fmpq big_val = fmpq_from_signed_native_rational(val);
+        std::string big;
+        write_big_rational<Style>(big, &big_val);
+        fmpq_clear(&big_val);
+
+        REQUIRE(native == big);
+        REQUIRE(native_out.str() == big);
+    }
+}
+
+TEST_CASE( "write_big_rational matches write_native_rational" ) {
+    const std::vector<SignedNativeRational> vals = {
+        SignedNativeRational(NativeRational(3, 1), false),
+        SignedNativeRational(NativeRational(3, 1), true),
+        SignedNativeRational(NativeRational(0, 1), false),
+        SignedNativeRational(NativeRational(3, 2), true),
+        SignedNativeRational(NativeRational(MAX, 1), false),
+        SignedNativeRational(NativeRational(1, MAX), false),
+    };
+
+    require_native_matches_fmpq<PlaintextStyle>(vals);
+    require_native_matches_fmpq<TypesetStyle>(vals);
+    require_native_matches_fmpq<LatexStyle>(vals);
+    require_native_matches_fmpq<MathMLStyle>(vals);
+
+    LEAK_CHECK_REQUIRE(isAllGmpMemoryFreed_resetIfNot());
+}
+
 TEST_CASE( "fmpq_from_decimal_str" ) {
     fmpq_t big_rat;
 
@@ -472,3 +629,543 @@ TEST_CASE( "fmpq_from_scientific_str" ){
 
     LEAK_CHECK_REQUIRE(isAllGmpMemoryFreed_resetIfNot());
 }
+
+TEST_CASE( "SignedNativeRational fmpq interop" ){
+    SECTION("Round trip"){
+        fmpq_t big_rat;
+        *big_rat = fmpq_from_signed_native_rational(SignedNativeRational(NativeRational(6, 4), true));
+        REQUIRE(fmpz_get_si(fmpq_numref(big_rat)) == -3);
+        REQUIRE(fmpz_get_si(fmpq_denref(big_rat)) == 2);
+
+        SignedNativeRational result;
+        REQUIRE_FALSE(ckd_fmpq2signed(&result, big_rat));
+        REQUIRE(result == SignedNativeRational(NativeRational(3, 2), true));
+
+        fmpq_abs_inplace(big_rat);
+        REQUIRE_FALSE(ckd_fmpq2signed(&result, big_rat));
+        REQUIRE(result == SignedNativeRational(NativeRational(3, 2)));
+        fmpq_clear(big_rat);
+    }
+
+    SECTION("Magnitudes beyond the small coefficient range"){
+        fmpq_t big_rat;
+        *big_rat = fmpq_from_signed_native_rational(SignedNativeRational(NativeRational(MAX, 1), true));
+        REQUIRE(fmpz_sgn(fmpq_numref(big_rat)) == -1);
+
+        SignedNativeRational result;
+        REQUIRE_FALSE(ckd_fmpq2signed(&result, big_rat));
+        REQUIRE(result == SignedNativeRational(NativeRational(MAX, 1), true));
+
+        fmpq_abs_inplace(big_rat);
+        REQUIRE(fmpz_sgn(fmpq_numref(big_rat)) == 1);
+        REQUIRE(fmpz_get_ui(fmpq_numref(big_rat)) == MAX);
+
+        fmpz_mul_ui(fmpq_numref(big_rat), fmpq_numref(big_rat), 2);
+        REQUIRE(ckd_fmpq2signed(&result, big_rat));
+        fmpq_clear(big_rat);
+    }
+
+    SECTION("Matches fmpq arithmetic"){
+        size_t state = 0x9E3779B97F4A7C15u;
+        auto next = [&state](){
+            state ^= state << 13;
+            state ^= state >> 7;
+            state ^= state << 17;
+            return state;
+        };
+
+        fmpq_t big_a, big_b, expected;
+        fmpq_init(expected);
+        for(size_t i = 0; i < 10000; i++){
+            const size_t shift = next() % std::numeric_limits<size_t>::digits;
+            const SignedNativeRational a(NativeRational(next() >> shift, next() >> shift | 1), next() & 1);
+            const SignedNativeRational b(NativeRational(next() >> (shift/2), next() >> (shift/2) | 1), next() & 1);
+            *big_a = fmpq_from_signed_native_rational(a);
+            *big_b = fmpq_from_signed_native_rational(b);
+
+            REQUIRE((a < b) == (fmpq_cmp(big_a, big_b) < 0));
+            REQUIRE((a == b) == fmpq_equal(big_a, big_b));
+
+            const auto check = [&expected](bool overflow, SignedNativeRational result){
+                SignedNativeRational expected_native;
+                REQUIRE(overflow == ckd_fmpq2signed(&expected_native, expected));
+                if(!overflow) REQUIRE(result == expected_native);
+            };
+
+            SignedNativeRational result;
+            fmpq_add(expected, big_a, big_b);
+            check(ckd_add(&result, a, b), result);
+            fmpq_sub(expected, big_a, big_b);
+            check(ckd_sub(&result, a, b), result);
+            fmpq_mul(expected, big_a, big_b);
+            check(ckd_mul(&result, a, b), result);
+            if(b.magnitude().num != 0){
+                fmpq_div(expected, big_a, big_b);
+                check(ckd_div(&result, a, b), result);
+            }
+
+            fmpq_clear(big_a);
+            fmpq_clear(big_b);
+        }
+        fmpq_clear(expected);
+    }
+
+    LEAK_CHECK_REQUIRE(isAllGmpMemoryFreed_resetIfNot());
+}
+
+TEST_CASE( "DecimalRational fmpq conversions" ){
+    fmpq_t big_rat;
+
+    SECTION("Round trip"){
+        *big_rat = fmpq_from_decimal_rational(DecimalRational(617, 0, 3));
+        REQUIRE(fmpz_get_ui(fmpq_numref(big_rat)) == 617);
+        REQUIRE(fmpz_get_ui(fmpq_denref(big_rat)) == 125);
+
+        DecimalRational result;
+        REQUIRE_FALSE(ckd_fmpq2dec(&result, big_rat));
+        REQUIRE(result == DecimalRational(617, 0, 3));
+        fmpq_clear(big_rat);
+    }
+
+    SECTION("Not a decimal"){
+        DecimalRational result;
+
+        *big_rat = fmpq_from_decimal_str("0.5");
+        fmpq_neg(big_rat, big_rat);
+        REQUIRE(ckd_fmpq2dec(&result, big_rat));
+        fmpq_clear(big_rat);
+
+        *big_rat = fmpq_from_decimal_str("123456789012345678901234567890.5");
+        REQUIRE(ckd_fmpq2dec(&result, big_rat));
+        fmpq_clear(big_rat);
+
+        fmpq_init(big_rat);
+        fmpq_set_ui(big_rat, 1, 3);
+        REQUIRE(ckd_fmpq2dec(&result, big_rat));
+        fmpq_clear(big_rat);
+    }
+
+    LEAK_CHECK_REQUIRE(isAllGmpMemoryFreed_resetIfNot());
+}
+
+TEST_CASE( "BigScaledDecimal" ){
+    SECTION("Promotion on overflow"){
+        const ScaledDecimal a(MAX/10, -2);
+        const ScaledDecimal b(6, -3);
+        ScaledDecimal result;
+        REQUIRE(ckd_add(&result, a, b));
+
+        BigScaledDecimal big_a = bigdec_from_scaled(a);
+        BigScaledDecimal big_b = bigdec_from_scaled(b);
+        BigScaledDecimal sum = bigdec_from_scaled(ScaledDecimal(0, 0));
+        bigdec_add(&sum, big_a, big_b);
+        REQUIRE(sum.exponent == -3);
+        std::string str;
+        write_big_scaled_decimal(str, sum, FloatNotation::Fixed);
+        REQUIRE(str == std::to_string(MAX/1000) + '.' + std::to_string(MAX/10%100) + '6');
+        REQUIRE(ckd_bigdec2scaled(&result, sum));
+
+        // The difference of the promoted sum demotes again, keeping the smaller exponent
+        bigdec_sub(&sum, sum, big_b);
+        REQUIRE_FALSE(ckd_bigdec2scaled(&result, sum));
+        REQUIRE(result == a);
+        REQUIRE(result.exponent == -3);
+
+        bigdec_clear(&sum);
+        bigdec_clear(&big_b);
+        bigdec_clear(&big_a);
+    }
+
+    SECTION("Signed arithmetic"){
+        BigScaledDecimal a = bigdec_from_scaled(ScaledDecimal(15, -1));
+        BigScaledDecimal b = bigdec_from_scaled(ScaledDecimal(4, 0));
+        bigdec_sub(&a, a, b);
+        REQUIRE(bigdec_cmp(a, b) < 0);
+        REQUIRE(bigdec_cmp(b, a) > 0);
+        ScaledDecimal result;
+        REQUIRE(ckd_bigdec2scaled(&result, a));
+
+        std::string str;
+        write_big_scaled_decimal(str, a);
+        REQUIRE(str == "-2.5");
+
+        bigdec_mul(&a, a, a);
+        REQUIRE_FALSE(ckd_bigdec2scaled(&result, a));
+        REQUIRE(result == ScaledDecimal(625, -2));
+        REQUIRE(result.exponent == -2);
+
+        BigScaledDecimal scale = bigdec_from_scaled(ScaledDecimal(1, 30000));
+        bigdec_mul(&b, b, scale);
+        bigdec_mul(&b, b, b);
+        REQUIRE(ckd_bigdec2scaled(&result, b));
+        str.clear();
+        write_big_scaled_decimal(str, b, FloatNotation::Scientific);
+        REQUIRE(str == "1.6e+60001");
+
+        bigdec_clear(&scale);
+        bigdec_clear(&b);
+        bigdec_clear(&a);
+    }
+
+    SECTION("Comparison across exponents"){
+        BigScaledDecimal a = bigdec_from_scaled(ScaledDecimal(1500, -3));
+        BigScaledDecimal b = bigdec_from_scaled(ScaledDecimal(15, -1));
+        REQUIRE(bigdec_cmp(a, b) == 0);
+        fmpz_10_pow_ui(&b.mantissa, 40);
+        REQUIRE(bigdec_cmp(a, b) < 0);
+        bigdec_clear(&b);
+        bigdec_clear(&a);
+    }
+
+    LEAK_CHECK_REQUIRE(isAllGmpMemoryFreed_resetIfNot());
+}
+
+TEST_CASE( "fmpq_from_product" ){
+    SECTION("Native product"){
+        RationalProductAccumulator product;
+        product.mul(NativeRational(6, 4));
+        fmpq_t big_rat;
+        *big_rat = fmpq_from_product(product);
+        REQUIRE(fmpz_get_ui(fmpq_numref(big_rat)) == 3);
+        REQUIRE(fmpz_get_ui(fmpq_denref(big_rat)) == 2);
+        fmpq_clear(big_rat);
+    }
+
+    SECTION("Matches a chain of fmpq products"){
+        RationalProductAccumulator product;
+        fmpq_t expected;
+        fmpq_init(expected);
+        fmpq_set_ui(expected, 1, 1);
+        fmpq_t factor;
+        fmpq_init(factor);
+        for(size_t i = 1; i <= 40; i++){
+            const NativeRational val(MAX / (2*i + 1), 6*i);
+            product.mul(val);
+            fmpq_set_ui(factor, val.num, val.den);
+            fmpq_mul(expected, expected, factor);
+        }
+
+        NativeRational result;
+        REQUIRE(product.ckd_result(&result));
+        fmpq_t big_rat;
+        *big_rat = fmpq_from_product(product);
+        REQUIRE(fmpq_equal(big_rat, expected));
+        REQUIRE(fmpq_is_canonical(big_rat));
+
+        fmpq_clear(big_rat);
+        fmpq_clear(factor);
+        fmpq_clear(expected);
+    }
+
+    LEAK_CHECK_REQUIRE(isAllGmpMemoryFreed_resetIfNot());
+}
+
+TEST_CASE( "Demotion to native types" ){
+    fmpz_t big_int;
+    fmpz_init(big_int);
+    size_t word, high, low;
+
+    SECTION("fmpz and mpz to words"){
+        fmpz_set_ui(big_int, 42);  // Inline
+        REQUIRE_FALSE(ckd_fmpz2word(&word, big_int));
+        REQUIRE(word == 42);
+        REQUIRE_FALSE(ckd_fmpz2wide(&high, &low, big_int));
+        REQUIRE((high == 0 && low == 42));
+
+        fmpz_set_ui(big_int, MAX);  // An mpz which fits a word
+        REQUIRE_FALSE(ckd_fmpz2word(&word, big_int));
+        REQUIRE(word == MAX);
+
+        fmpz_mul_ui(big_int, big_int, MAX);
+        REQUIRE(ckd_fmpz2word(&word, big_int));
+        REQUIRE_FALSE(ckd_fmpz2wide(&high, &low, big_int));
+        REQUIRE((high == MAX - 1 && low == 1));  // (2^w - 1)^2 = (2^w - 2) * 2^w + 1
+
+        fmpz_mul_ui(big_int, big_int, 2);
+        REQUIRE(ckd_fmpz2wide(&high, &low, big_int));
+
+        fmpz_set_si(big_int, -1);
+        REQUIRE(ckd_fmpz2word(&word, big_int));
+        REQUIRE(ckd_fmpz2wide(&high, &low, big_int));
+        fmpz_set_ui(big_int, MAX);
+        fmpz_neg(big_int, big_int);
+        REQUIRE(ckd_fmpz2word(&word, big_int));
+
+        mpz_t gmp_int;
+        mpz_init_set_ui(gmp_int, 0);
+        REQUIRE_FALSE(ckd_mpz2word(&word, gmp_int));
+        REQUIRE(word == 0);
+        mpz_set_ui(gmp_int, 7);
+        mpz_mul_2exp(gmp_int, gmp_int, std::numeric_limits<size_t>::digits);
+        REQUIRE(ckd_mpz2word(&word, gmp_int));
+        REQUIRE_FALSE(ckd_mpz2wide(&high, &low, gmp_int));
+        REQUIRE((high == 7 && low == 0));
+        mpz_neg(gmp_int, gmp_int);
+        REQUIRE(ckd_mpz2wide(&high, &low, gmp_int));
+        mpz_clear(gmp_int);
+    }
+
+    SECTION("fmpq to NativeRational"){
+        std::vector<fmpq> vals(5);
+        for(fmpq& val : vals) fmpq_init(&val);
+        fmpq_set_ui(&vals[0], 3, 8);
+        fmpq_set_ui(&vals[1], MAX, MAX - 1);
+        fmpq_set_si(&vals[2], -3, 8);
+        fmpq_set_ui(&vals[3], MAX, 3);
+        fmpq_mul(&vals[3], &vals[3], &vals[3]);
+        fmpq_set_ui(&vals[4], 7, MAX);
+        fmpq_mul_ui(&vals[4], &vals[4], 2);
+
+        NativeRational native;
+        REQUIRE_FALSE(ckd_fmpq2native(&native, &vals[0]));
+        REQUIRE((native.num == 3 && native.den == 8));
+        REQUIRE_FALSE(ckd_fmpq2native(&native, &vals[1]));
+        REQUIRE((native.num == MAX && native.den == MAX - 1));
+        REQUIRE(ckd_fmpq2native(&native, &vals[2]));
+        REQUIRE(ckd_fmpq2native(&native, &vals[3]));
+
+        std::vector<NativeRational> results(vals.size());
+        std::vector<uint8_t> overflow(vals.size());
+        REQUIRE(ckd_fmpq2native(results.data(), overflow.data(), vals.data(), vals.size()));
+        REQUIRE(overflow == std::vector<uint8_t>{0, 0, 1, 1, 0});
+        REQUIRE(results[0] == NativeRational(3, 8));
+        REQUIRE((results[1].num == MAX && results[1].den == MAX - 1));
+        REQUIRE((results[4].num == 14 && results[4].den == MAX));
+        REQUIRE_FALSE(ckd_fmpq2native(results.data(), overflow.data(), vals.data(), 2));
+
+        std::vector<fmpz> ints(vals.size());
+        std::vector<size_t> words(vals.size());
+        for(size_t i = 0; i < vals.size(); i++) fmpz_init_set(&ints[i], fmpq_numref(&vals[i]));
+        REQUIRE(ckd_fmpz2word(words.data(), overflow.data(), ints.data(), ints.size()));
+        REQUIRE(overflow == std::vector<uint8_t>{0, 0, 1, 1, 0});
+        REQUIRE(words == std::vector<size_t>{3, MAX, words[2], words[3], 14});
+
+        for(fmpz& val : ints) fmpz_clear(&val);
+        for(fmpq& val : vals) fmpq_clear(&val);
+    }
+
+    fmpz_clear(big_int);
+    LEAK_CHECK_REQUIRE(isAllGmpMemoryFreed_resetIfNot());
+}
+
+TEST_CASE( "Mixed fmpq and NativeRational arithmetic" ){
+    std::vector<fmpq> big_vals(6);
+    for(fmpq& val : big_vals) fmpq_init(&val);
+    fmpq_set_ui(&big_vals[1], 3, 10);
+    fmpq_set_si(&big_vals[2], -7, 6);
+    fmpq_set_ui(&big_vals[3], MAX, 12);
+    fmpq_mul(&big_vals[3], &big_vals[3], &big_vals[3]);
+    fmpq_set_ui(&big_vals[4], 5, MAX);
+    fmpq_mul(&big_vals[4], &big_vals[4], &big_vals[4]);
+    fmpq_neg(&big_vals[5], &big_vals[3]);
+
+    const NativeRational native_vals[] = {NativeRational(0, 3), NativeRational(6, 4), NativeRational(7, 6), NativeRational(1, 1),
+                                          NativeRational(MAX, 3), NativeRational(5, MAX), NativeRational(MAX, MAX-1)};
+
+    fmpq_t native, expected, result;
+    fmpq_init(native);
+    fmpq_init(expected);
+    fmpq_init(result);
+    for(const fmpq& a : big_vals){
+        for(const NativeRational b : native_vals){
+            NativeRational reduced = b;
+            reduced.reduceInPlace();
+            fmpq_set_ui(native, reduced.num, reduced.den);
+
+            fmpq_add(expected, &a, native);
+            fmpq_add_native(result, &a, b);
+            REQUIRE(fmpq_equal(result, expected));
+            REQUIRE(fmpq_is_canonical(result));
+
+            fmpq_sub(expected, &a, native);
+            fmpq_sub_native(result, &a, b);
+            REQUIRE(fmpq_equal(result, expected));
+            REQUIRE(fmpq_is_canonical(result));
+
+            fmpq_mul(expected, &a, native);
+            fmpq_mul_native(result, &a, b);
+            REQUIRE(fmpq_equal(result, expected));
+            REQUIRE(fmpq_is_canonical(result));
+
+            if(b.num != 0){
+                fmpq_div(expected, &a, native);
+                fmpq_div_native(result, &a, b);
+                REQUIRE(fmpq_equal(result, expected));
+                REQUIRE(fmpq_is_canonical(result));
+            }
+
+            const int cmp = fmpq_cmp(&a, native);
+            REQUIRE(fmpq_cmp_native(&a, b) == (cmp > 0) - (cmp < 0));
+        }
+    }
+
+    SECTION("Result aliases the operand"){
+        fmpq_set(result, &big_vals[3]);
+        fmpq_add_native(result, result, NativeRational(5, 6));
+        fmpq_sub_native(result, result, NativeRational(5, 6));
+        REQUIRE(fmpq_equal(result, &big_vals[3]));
+        fmpq_mul_native(result, result, NativeRational(MAX, 7));
+        fmpq_div_native(result, result, NativeRational(MAX, 7));
+        REQUIRE(fmpq_equal(result, &big_vals[3]));
+    }
+
+    SECTION("Cross products differing only in the low word"){
+        fmpz_set_ui(fmpq_numref(result), MAX);
+        fmpz_mul_ui(fmpq_numref(result), fmpq_numref(result), MAX);
+        fmpz_add_ui(fmpq_numref(result), fmpq_numref(result), 1);
+        fmpz_set_ui(fmpq_denref(result), MAX);
+        REQUIRE(fmpq_cmp_native(result, NativeRational(MAX, 1)) > 0);  // (MAX^2 + 1) / MAX
+
+        fmpz_sub_ui(fmpq_numref(result), fmpq_numref(result), 2);
+        REQUIRE(fmpq_cmp_native(result, NativeRational(MAX, 1)) < 0);  // (MAX^2 - 1) / MAX
+    }
+
+    fmpq_clear(result);
+    fmpq_clear(expected);
+    fmpq_clear(native);
+    for(fmpq& val : big_vals) fmpq_clear(&val);
+    LEAK_CHECK_REQUIRE(isAllGmpMemoryFreed_resetIfNot());
+}
+
+TEST_CASE( "Filtered comparisons" ){
+    // Values far apart, values sharing their leading words, and values of either sign
+    std::vector<fmpq> vals(10);
+    for(fmpq& val : vals) fmpq_init(&val);
+    fmpq_set_ui(&vals[1], 1, 3);
+    fmpq_set_ui(&vals[2], MAX, 3);
+    fmpq_mul(&vals[2], &vals[2], &vals[2]);
+    fmpq_set(&vals[3], &vals[2]);
+    fmpq_add_ui(&vals[3], &vals[3], 1);
+    fmpq_set_ui(&vals[4], MAX - 2, MAX);
+    fmpq_set_ui(&vals[5], MAX - 1, MAX);
+    fmpq_set_ui(&vals[6], 7, MAX);
+    fmpq_mul(&vals[6], &vals[6], &vals[6]);
+    fmpq_set_ui(&vals[7], 3, 1);
+    fmpq_neg(&vals[8], &vals[3]);
+    fmpq_neg(&vals[9], &vals[2]);
+
+    const NativeRational native_vals[] = {NativeRational(0, 1), NativeRational(1, 3), NativeRational(2, 6), NativeRational(3, 1),
+                                          NativeRational(MAX - 1, MAX), NativeRational(MAX, 1), NativeRational(1, MAX)};
+
+    FilteredCmpCounters counters;
+    size_t num_cmps = 0;
+    fmpq_t native;
+    fmpq_init(native);
+    for(const fmpq& a : vals){
+        for(const fmpq& b : vals){
+            const int expected = fmpq_cmp(&a, &b);
+            const int result = fmpq_cmp_filtered(&a, &b, &counters);
+            REQUIRE((result > 0) - (result < 0) == (expected > 0) - (expected < 0));
+            num_cmps++;
+        }
+
+        for(NativeRational b : native_vals){
+            const int result = fmpq_cmp_filtered(&a, b, &counters);
+            b.reduceInPlace();
+            fmpq_set_ui(native, b.num, b.den);
+            const int expected = fmpq_cmp(&a, native);
+            REQUIRE((result > 0) - (result < 0) == (expected > 0) - (expected < 0));
+            num_cmps++;
+        }
+
+        for(const size_t b : {size_t(0), size_t(3), MAX}){
+            const int result = fmpq_cmp_filtered(&a, b, &counters);
+            fmpq_set_ui(native, b, 1);
+            const int expected = fmpq_cmp(&a, native);
+            REQUIRE((result > 0) - (result < 0) == (expected > 0) - (expected < 0));
+            num_cmps++;
+        }
+    }
+
+    REQUIRE(counters.by_bit_length + counters.by_estimate + counters.exact == num_cmps);
+    REQUIRE(counters.by_bit_length > counters.exact);
+    REQUIRE(counters.by_estimate != 0);
+
+    SECTION("Values sharing their leading words are compared exactly"){
+        counters = FilteredCmpCounters();
+        REQUIRE(fmpq_cmp_filtered(&vals[2], &vals[3], &counters) < 0);
+        REQUIRE(fmpq_cmp_filtered(&vals[8], &vals[9], &counters) < 0);
+        REQUIRE(fmpq_cmp_filtered(&vals[5], NativeRational(MAX - 1, MAX), &counters) == 0);
+        REQUIRE(counters.exact == 3);
+    }
+
+    SECTION("Near-equal values agree with the exact comparison"){
+        // 260124869/2 against 136084896901453617495316/1046304395459041, which differ by a relative 2^-38
+        fmpq_set_ui(&vals[0], 260124869, 2);
+        fmpz_set_ui(fmpq_numref(&vals[1]), 136084896901);
+        fmpz_mul_ui(fmpq_numref(&vals[1]), fmpq_numref(&vals[1]), 1000000000000);
+        fmpz_add_ui(fmpq_numref(&vals[1]), fmpq_numref(&vals[1]), 453617495316);
+        fmpz_set_ui(fmpq_denref(&vals[1]), 1046304395459041);
+        fmpq_canonicalise(&vals[1]);
+        REQUIRE(fmpq_cmp(&vals[0], &vals[1]) < 0);
+        REQUIRE(fmpq_cmp_filtered(&vals[0], &vals[1], nullptr) < 0);
+        REQUIRE(fmpq_cmp_filtered(&vals[1], &vals[0], nullptr) > 0);
+
+        // Values scaled by 1 + 2^-k, which separate or not either side of the margin
+        size_t state = 0x9E3779B97F4A7C15u;
+        auto next = [&state](){
+            state ^= state << 13;
+            state ^= state >> 7;
+            state ^= state << 17;
+            return state;
+        };
+        for(size_t i = 0; i < 1000; i++){
+            fmpq_set_ui(&vals[0], next() | 1, next() | 1);
+            fmpq_set_ui(&vals[1], next() | 1, next() | 1);
+            fmpq_mul(&vals[0], &vals[0], &vals[1]);
+            const size_t k = 20 + next() % (std::numeric_limits<size_t>::digits - 22);
+            fmpq_set_ui(&vals[1], (size_t(1) << k) + 1, size_t(1) << k);
+            fmpq_mul(&vals[1], &vals[1], &vals[0]);
+            REQUIRE(fmpq_cmp_filtered(&vals[0], &vals[1], nullptr) < 0);
+            REQUIRE(fmpq_cmp_filtered(&vals[1], &vals[0], nullptr) > 0);
+        }
+    }
+
+    SECTION("Long values are filtered against native values"){
+        counters = FilteredCmpCounters();
+        for(size_t i = 0; i < 3; i++) fmpq_mul(&vals[2], &vals[2], &vals[2]);
+        REQUIRE(fmpq_cmp_filtered(&vals[2], NativeRational(MAX, 1), &counters) > 0);
+        fmpz_swap(fmpq_numref(&vals[2]), fmpq_denref(&vals[2]));  // Positive, so the reciprocal stays canonical
+        REQUIRE(fmpq_cmp_filtered(&vals[2], NativeRational(1, MAX), &counters) < 0);
+        REQUIRE(counters.by_bit_length == 2);
+    }
+
+    fmpq_clear(native);
+    for(fmpq& val : vals) fmpq_clear(&val);
+    LEAK_CHECK_REQUIRE(isAllGmpMemoryFreed_resetIfNot());
+}
+
+TEST_CASE( "canonical_hash (fmpq)" ){
+    fmpq_t big_rat;
+    fmpq_init(big_rat);
+
+    SECTION("Equal to native hashes"){
+        // Values which are inline fmpz, values which fit a word but are mpz, and zero
+        for(const NativeRational val : {NativeRational(3, 2), NativeRational(MAX, 3), NativeRational(2, MAX),
+                                        NativeRational(MAX-1, MAX), NativeRational(0, 5)}){
+            fmpq_set_ui(big_rat, val.num, val.den);
+            REQUIRE(canonical_hash(big_rat) == canonical_hash(val));
+            REQUIRE(std::hash<fmpq>()(*big_rat) == std::hash<NativeRational>()(val));
+
+            fmpq_neg(big_rat, big_rat);
+            REQUIRE(canonical_hash(big_rat) == canonical_hash(SignedNativeRational(val, true)));
+        }
+    }
+
+    SECTION("Values beyond a word"){
+        fmpq_set_ui(big_rat, MAX, 7);
+        fmpq_t other;
+        fmpq_init(other);
+        fmpq_mul(big_rat, big_rat, big_rat);
+        fmpq_set_ui(other, MAX, 7);
+        fmpq_mul(other, other, other);
+        REQUIRE(canonical_hash(big_rat) == canonical_hash(other));
+
+        fmpq_add_ui(other, other, 1);
+        REQUIRE(canonical_hash(big_rat) != canonical_hash(other));
+        fmpq_clear(other);
+    }
+
+    fmpq_clear(big_rat);
+    LEAK_CHECK_REQUIRE(isAllGmpMemoryFreed_resetIfNot());
+}
@@ -0,0 +1,224 @@
+#include <catch2/catch_test_macros.hpp>
+
+#include "ki_cas_decimal_rational.h"
+
+#include <limits>
+
+using namespace KiCAS2;
+
+static constexpr size_t MAX = std::numeric_limits<size_t>::max();
+
+TEST_CASE( "DecimalRational conversions" ) {
+    const DecimalRational val(617, 0, 3);
+    REQUIRE(val.den() == 125);
+    REQUIRE(NativeRational(val) == NativeRational(617, 125));
+
+    DecimalRational result;
+    REQUIRE_FALSE(ckd_rat2dec(&result, NativeRational(2468, 500)));
+    REQUIRE(result == val);
+
+    REQUIRE_FALSE(ckd_rat2dec(&result, NativeRational(0, 40)));
+    REQUIRE(result == DecimalRational(0, 0, 0));
+
+    REQUIRE(ckd_rat2dec(&result, NativeRational(1, 3)));
+    REQUIRE(ckd_rat2dec(&result, NativeRational(1, 30)));
+
+    size_t den;
+    REQUIRE_FALSE(ckd_decimal_den(&den, 3, 2));
+    REQUIRE(den == 200);
+    REQUIRE(ckd_decimal_den(&den, std::numeric_limits<size_t>::digits, 0));
+    REQUIRE(ckd_decimal_den(&den, 0, std::numeric_limits<size_t>::digits));
+    REQUIRE(ckd_decimal_den(&den, std::numeric_limits<size_t>::digits10+1, std::numeric_limits<size_t>::digits10+1));
+}
+
+TEST_CASE( "ckd_strdecimal2dec" ) {
+    DecimalRational result;
+
+    REQUIRE_FALSE(ckd_strdecimal2dec(&result, "12.34"));
+    REQUIRE(result == DecimalRational(617, 1, 2));
+
+    REQUIRE_FALSE(ckd_strdecimal2dec(&result, "0.125"));
+    REQUIRE(result == DecimalRational(1, 3, 0));
+
+    REQUIRE_FALSE(ckd_strdecimal2dec(&result, "007.500"));
+    REQUIRE(result == DecimalRational(15, 1, 0));
+
+    REQUIRE_FALSE(ckd_strdecimal2dec(&result, "4200"));
+    REQUIRE(result == DecimalRational(4200, 0, 0));
+
+    REQUIRE_FALSE(ckd_strdecimal2dec(&result, "42."));
+    REQUIRE(result == DecimalRational(42, 0, 0));
+
+    REQUIRE_FALSE(ckd_strdecimal2dec(&result, ".000"));
+    REQUIRE(result == DecimalRational(0, 0, 0));
+
+    SECTION("Matches ckd_strdecimal2rat"){
+        for(const char* str : {"3.14159", "0.0001", "99.999", "1.5", "0.2", "10.25"}){
+            NativeRational expected;
+            REQUIRE_FALSE(ckd_strdecimal2rat(&expected, str));
+            REQUIRE_FALSE(ckd_strdecimal2dec(&result, str));
+            REQUIRE(NativeRational(result) == expected);
+        }
+    }
+
+    SECTION("Overflow"){
+        REQUIRE(ckd_strdecimal2dec(&result, "123456789012345678901234567890"));
+        REQUIRE(ckd_strdecimal2dec(&result, ".123456789012345678901"));
+
+        if(sizeof(size_t) == 8){
+            REQUIRE(ckd_strdecimal2dec(&result, ".12345678901234567891"));  // 10^20 does not fit
+            REQUIRE_FALSE(ckd_strdecimal2dec(&result, ".1234567890123456789"));
+            REQUIRE(result == DecimalRational(1234567890123456789, 19, 19));
+        }
+    }
+}
+
+TEST_CASE( "DecimalRational comparison" ) {
+    const DecimalRational half(1, 1, 0);
+    const DecimalRational fifth(1, 0, 1);
+    const DecimalRational three_tenths(3, 1, 1);
+
+    REQUIRE(half == half);
+    REQUIRE(half != fifth);
+    REQUIRE(fifth < three_tenths);
+    REQUIRE(three_tenths < half);
+    REQUIRE(half > fifth);
+    REQUIRE(half >= half);
+    REQUIRE(fifth <= three_tenths);
+    REQUIRE_FALSE(half < half);
+    REQUIRE(DecimalRational(MAX, 0, 0) > DecimalRational(MAX, 1, 0));
+}
+
+TEST_CASE( "ckd_mul (DecimalRational * DecimalRational)" ) {
+    DecimalRational result;
+
+    REQUIRE_FALSE(ckd_mul(&result, DecimalRational(3, 1, 0), DecimalRational(1, 0, 1)));
+    REQUIRE(result == DecimalRational(3, 1, 1));
+
+    SECTION("Cancellation"){
+        REQUIRE_FALSE(ckd_mul(&result, DecimalRational(4, 0, 0), DecimalRational(5, 3, 0)));
+        REQUIRE(result == DecimalRational(5, 1, 0));
+
+        REQUIRE_FALSE(ckd_mul(&result, DecimalRational(25, 4, 0), DecimalRational(3, 0, 2)));
+        REQUIRE(result == DecimalRational(3, 4, 0));
+
+        REQUIRE_FALSE(ckd_mul(&result, DecimalRational(MAX-1, 0, 0), DecimalRational(1, 1, 0)));
+        REQUIRE(result == DecimalRational(MAX/2, 0, 0));
+    }
+
+    SECTION("Zero"){
+        REQUIRE_FALSE(ckd_mul(&result, DecimalRational(0, 0, 0), DecimalRational(7, 5, 5)));
+        REQUIRE(result == DecimalRational(0, 0, 0));
+    }
+
+    SECTION("Overflow"){
+        REQUIRE(ckd_mul(&result, DecimalRational(MAX, 0, 0), DecimalRational(3, 0, 0)));
+        REQUIRE(ckd_mul(&result, DecimalRational(1, std::numeric_limits<size_t>::digits-1, 0), DecimalRational(1, 1, 0)));
+    }
+}
+
+TEST_CASE( "ckd_add (DecimalRational + DecimalRational)" ) {
+    DecimalRational result;
+
+    REQUIRE_FALSE(ckd_add(&result, DecimalRational(1, 1, 0), DecimalRational(1, 0, 1)));
+    REQUIRE(result == DecimalRational(7, 1, 1));
+
+    SECTION("Cancellation"){
+        REQUIRE_FALSE(ckd_add(&result, DecimalRational(1, 1, 0), DecimalRational(1, 1, 0)));
+        REQUIRE(result == DecimalRational(1, 0, 0));
+
+        REQUIRE_FALSE(ckd_add(&result, DecimalRational(3, 0, 1), DecimalRational(7, 0, 1)));
+        REQUIRE(result == DecimalRational(2, 0, 0));
+    }
+
+    SECTION("Cancellation of a wide sum"){
+        REQUIRE_FALSE(ckd_add(&result, DecimalRational(MAX, 1, 0), DecimalRational(MAX, 1, 0)));
+        REQUIRE(result == DecimalRational(MAX, 0, 0));
+
+        REQUIRE_FALSE(ckd_add(&result, DecimalRational(MAX-2, 0, 1), DecimalRational(MAX-3, 0, 1)));
+        REQUIRE(result == DecimalRational(2*(MAX/5) - 1, 0, 0));
+    }
+
+    SECTION("Overflow"){
+        REQUIRE(ckd_add(&result, DecimalRational(MAX, 0, 0), DecimalRational(1, 0, 0)));
+        REQUIRE(ckd_add(&result, DecimalRational(1, std::numeric_limits<size_t>::digits-1, 0),
+                                 DecimalRational(1, 0, 1)));
+    }
+}
+
+TEST_CASE( "ckd_sub (DecimalRational - DecimalRational)" ) {
+    DecimalRational result;
+
+    REQUIRE_FALSE(ckd_sub(&result, DecimalRational(1, 1, 0), DecimalRational(1, 0, 1)));
+    REQUIRE(result == DecimalRational(3, 1, 1));
+
+    REQUIRE_FALSE(ckd_sub(&result, DecimalRational(7, 1, 1), DecimalRational(7, 1, 1)));
+    REQUIRE(result == DecimalRational(0, 0, 0));
+
+    REQUIRE_FALSE(ckd_sub(&result, DecimalRational(3, 2, 0), DecimalRational(1, 2, 0)));
+    REQUIRE(result == DecimalRational(1, 1, 0));
+
+    SECTION("Wide difference"){
+        REQUIRE_FALSE(ckd_sub(&result, DecimalRational(MAX-1, 0, 0), DecimalRational(MAX, 1, 0)));
+        REQUIRE(result == DecimalRational(MAX-2, 1, 0));
+
+        REQUIRE(ckd_sub(&result, DecimalRational(MAX-1, 0, 0), DecimalRational(1, 1, 0)));
+    }
+}
+
+TEST_CASE( "DecimalRational matches NativeRational" ) {
+    size_t state = 0x9E3779B97F4A7C15u;
+    auto next = [&state](){
+        state ^= state << 13;
+        state ^= state >> 7;
+        state ^= state << 17;
+        return state;
+    };
+
+    auto random_decimal = [&next](){
+        constexpr size_t MAX_EXPONENT = std::numeric_limits<size_t>::digits10;
+        for(;;){
+            const size_t mantissa = next() >> (next() % std::numeric_limits<size_t>::digits);
+            const DecimalRational scale(1, static_cast<uint8_t>(next() % MAX_EXPONENT),
+                                           static_cast<uint8_t>(next() % MAX_EXPONENT));
+            DecimalRational result;
+            if(ckd_rat2dec(&result, NativeRational(mantissa, 1)) == false && ckd_mul(&result, result, scale) == false)
+                return result;
+        }
+    };
+
+    for(size_t i = 0; i < 20000; i++){
+        const DecimalRational a = random_decimal();
+        const DecimalRational b = random_decimal();
+
+        REQUIRE((a < b) == (NativeRational(a) < NativeRational(b)));
+        REQUIRE((a == b) == (NativeRational(a) == NativeRational(b)));
+
+        const auto check = [](bool decimal_overflow, DecimalRational result, bool native_overflow, NativeRational expected){
+            if(native_overflow){
+                REQUIRE(decimal_overflow);
+                return;
+            }
+
+            expected.reduceInPlace();
+            DecimalRational expected_decimal;
+            if(ckd_rat2dec(&expected_decimal, expected)){
+                REQUIRE(decimal_overflow);
+            }else{
+                REQUIRE_FALSE(decimal_overflow);
+                REQUIRE(result == expected_decimal);
+            }
+        };
+
+        DecimalRational result;
+        NativeRational expected;
+        bool overflow = ckd_mul(&result, a, b);
+        check(overflow, result, ckd_mul(&expected, a, b), expected);
+        overflow = ckd_add(&result, a, b);
+        check(overflow, result, ckd_add(&expected, a, b), expected);
+        if(a >= b){
+            overflow = ckd_sub(&result, a, b);
+            check(overflow, result, ckd_sub(&expected, a, b), expected);
+        }
+    }
+}
@@ -2,8 +2,42 @@
 
 #include "ki_cas_native_float.h"
 
+#include <charconv>
+#include <cmath>
+#include <cstdio>
+#include <limits>
+#include <random>
+
 using namespace KiCAS2;
 
+/// Random finite values spread over the whole exponent range, including subnormals
+static FloatingPoint random_float(std::mt19937_64& generator) {
+    constexpr int MIN_EXPONENT = std::numeric_limits<FloatingPoint>::min_exponent - std::numeric_limits<FloatingPoint>::digits;
+    constexpr int MAX_EXPONENT = std::numeric_limits<FloatingPoint>::max_exponent;
+    std::uniform_int_distribution<int> exponent(MIN_EXPONENT, MAX_EXPONENT - 1);
+    const FloatingPoint mantissa = std::ldexp(static_cast<FloatingPoint>(generator()), -64);
+    const FloatingPoint val = std::ldexp(mantissa, exponent(generator));
+    return (generator() & 1) ? -val : val;
+}
+
+/// Random finite doubles spread over the whole exponent range, including subnormals
+static double random_double(std::mt19937_64& generator) {
+    constexpr int MIN_EXPONENT = std::numeric_limits<double>::min_exponent - std::numeric_limits<double>::digits;
+    constexpr int MAX_EXPONENT = std::numeric_limits<double>::max_exponent;
+    std::uniform_int_distribution<int> exponent(MIN_EXPONENT, MAX_EXPONENT - 1);
+    const double mantissa = std::ldexp(static_cast<double>(generator() >> 11), -53);
+    const double val = std::ldexp(mantissa, exponent(generator));
+    return (generator() & 1) ? -val : val;
+}
+
+static std::string printf_float(const char* format, int precision, FloatingPoint val) {
+    const int size = std::snprintf(nullptr, 0, format, precision, val);
+    std::string str(static_cast<size_t>(size) + 1, '\0');
+    std::snprintf(str.data(), str.size(), format, precision, val);
+    str.pop_back();
+    return str;
+}
+
 #if !defined(__GNUC__) || __GNUC__ > 8
 TEST_CASE( "write_float" ){
     std::string out;
@@ -27,9 +61,235 @@ TEST_CASE( "write_float" ){
         write_float(out, 2.998e8);
         REQUIRE(out == "2.998e+08");
     }
+
+    SECTION("Small"){
+        write_float(out, 0.0001L);
+        REQUIRE(out == "0.0001");
+        out.clear();
+        write_float(out, 0.000012345L);
+        REQUIRE(out == "1.2345e-05");
+    }
+
+    SECTION("Negative"){
+        write_float(out, -100.5);
+        REQUIRE(out == "-100.5");
+        out.clear();
+        write_float(out, -0.0);
+        REQUIRE(out == "-0");
+    }
+
+    SECTION("Special"){
+        write_float(out, std::numeric_limits<FloatingPoint>::infinity());
+        REQUIRE(out == "inf");
+        out.clear();
+        write_float(out, -std::numeric_limits<FloatingPoint>::infinity());
+        REQUIRE(out == "-inf");
+        out.clear();
+        write_float(out, std::numeric_limits<FloatingPoint>::quiet_NaN());
+        REQUIRE(out == "nan");
+    }
+
+    SECTION("Fixed notation"){
+        write_float(out, 2.998e8, FloatNotation::Fixed);
+        REQUIRE(out == "299800000");
+        out.clear();
+        write_float(out, 0.0625, FloatNotation::Fixed);
+        REQUIRE(out == "0.0625");
+    }
+
+    SECTION("Scientific notation"){
+        write_float(out, 42.0, FloatNotation::Scientific);
+        REQUIRE(out == "4.2e+01");
+        out.clear();
+        write_float(out, 0.0, FloatNotation::Scientific);
+        REQUIRE(out == "0e+00");
+    }
+
+    SECTION("Precision"){
+        write_float(out, 2.5, FloatNotation::Fixed, 0);
+        REQUIRE(out == "2");
+        out.clear();
+        write_float(out, 0.125, FloatNotation::Fixed, 2);
+        REQUIRE(out == "0.12");
+        out.clear();
+        write_float(out, 9.9999, FloatNotation::Fixed, 2);
+        REQUIRE(out == "10.00");
+        out.clear();
+        write_float(out, 9.9999, FloatNotation::Scientific, 2);
+        REQUIRE(out == "1.00e+01");
+        out.clear();
+        write_float(out, 0.0004, FloatNotation::Fixed, 2);
+        REQUIRE(out == "0.00");
+        out.clear();
+        write_float(out, 1234567.0, FloatNotation::General, 3);
+        REQUIRE(out == "1.23e+06");
+    }
+
+    SECTION("Extremes round trip"){
+        for(const FloatingPoint val : {std::numeric_limits<FloatingPoint>::max(),
+                                       std::numeric_limits<FloatingPoint>::min(),
+                                       std::numeric_limits<FloatingPoint>::denorm_min(),
+                                       std::numeric_limits<FloatingPoint>::epsilon()}){
+            out.clear();
+            write_float(out, val);
+            REQUIRE(std::strtold(out.c_str(), nullptr) == val);
+        }
+    }
+
+    SECTION("Fixed extremes"){
+        // Thousands of integer digits or leading zeros, which the reserved size must cover exactly
+        for(const FloatingPoint val : {std::numeric_limits<FloatingPoint>::max(),
+                                       -std::numeric_limits<FloatingPoint>::max(),
+                                       std::numeric_limits<FloatingPoint>::min(),
+                                       -std::numeric_limits<FloatingPoint>::min(),
+                                       std::numeric_limits<FloatingPoint>::denorm_min(),
+                                       -std::numeric_limits<FloatingPoint>::denorm_min()}){
+            std::string buffer(8192, '\0');
+            const std::to_chars_result result =
+                std::to_chars(buffer.data(), buffer.data() + buffer.size(), val, std::chars_format::fixed);
+            out.clear();
+            write_float(out, val, FloatNotation::Fixed);
+            REQUIRE(out == std::string_view(buffer.data(), result.ptr - buffer.data()));
+
+            out.clear();
+            write_float(out, val, FloatNotation::Fixed, 0);
+            REQUIRE(out == printf_float("%.*Lf", 0, val));
+
+            OutputBuilder builder;
+            write_float(builder, val, FloatNotation::Fixed);
+            write_float(builder, val, FloatNotation::Fixed, 0);
+            REQUIRE(builder.str() == std::string(buffer.data(), result.ptr - buffer.data()) + out);
+        }
+    }
+}
+
+TEST_CASE( "write_float matches to_chars" ){
+    std::mt19937_64 generator(42);
+
+    for(size_t i = 0; i < 2000; i++){
+        const FloatingPoint val = random_float(generator);
+        char buffer[64];
+        const std::to_chars_result result = std::to_chars(buffer, buffer+64, val, std::chars_format::scientific);
+        std::string out;
+        write_float(out, val, FloatNotation::Scientific);
+        REQUIRE(out == std::string_view(buffer, result.ptr - buffer));
+    }
+}
+
+TEST_CASE( "write_float (double)" ){
+    std::string out;
+
+    SECTION("Shortest digits of the double"){
+        // As a FloatingPoint, the nearest double to 0.1 needs many more digits
+        write_float(out, 0.1);
+        REQUIRE(out == "0.1");
+        out.clear();
+        write_float(out, static_cast<FloatingPoint>(0.1));
+        REQUIRE(out == "0.10000000000000000555");
+        out.clear();
+        write_float(out, 1.0 / 3, FloatNotation::Scientific);
+        REQUIRE(out == "3.333333333333333e-01");
+    }
+
+    SECTION("Extremes"){
+        for(const double val : {std::numeric_limits<double>::max(),
+                                std::numeric_limits<double>::min(),
+                                std::numeric_limits<double>::denorm_min()}){
+            std::string buffer(2048, '\0');
+            for(const std::chars_format format : {std::chars_format::scientific, std::chars_format::fixed}){
+                const std::to_chars_result result =
+                    std::to_chars(buffer.data(), buffer.data() + buffer.size(), val, format);
+                out.clear();
+                write_float(out, val, format == std::chars_format::fixed ? FloatNotation::Fixed : FloatNotation::Scientific);
+                REQUIRE(out == std::string_view(buffer.data(), result.ptr - buffer.data()));
+            }
+
+            out.clear();
+            write_float(out, val, FloatNotation::Fixed, 0);
+            REQUIRE(out == printf_float("%.*Lf", 0, val));
+        }
+    }
+
+    SECTION("OutputBuilder"){
+        OutputBuilder builder;
+        write_float(builder, 0.1);
+        write_float(builder, 0.1, FloatNotation::Fixed, 3);
+        REQUIRE(builder.str() == "0.10.100");
+    }
+}
+
+TEST_CASE( "write_float (double) matches to_chars" ){
+    std::mt19937_64 generator(44);
+    std::string buffer(2048, '\0');
+
+    for(size_t i = 0; i < 2000; i++){
+        const double val = random_double(generator);
+        for(const std::chars_format format : {std::chars_format::scientific, std::chars_format::fixed}){
+            const std::to_chars_result result = std::to_chars(buffer.data(), buffer.data() + buffer.size(), val, format);
+            std::string out;
+            write_float(out, val, format == std::chars_format::fixed ? FloatNotation::Fixed : FloatNotation::Scientific);
+            REQUIRE(out == std::string_view(buffer.data(), result.ptr - buffer.data()));
+        }
+    }
+}
+
+TEST_CASE( "write_float matches to_chars in fixed notation" ){
+    std::mt19937_64 generator(43);
+    std::string buffer(8192, '\0');
+
+    for(size_t i = 0; i < 2000; i++){
+        const FloatingPoint val = random_float(generator);
+        const std::to_chars_result result =
+            std::to_chars(buffer.data(), buffer.data() + buffer.size(), val, std::chars_format::fixed);
+        std::string out;
+        write_float(out, val, FloatNotation::Fixed);
+        REQUIRE(out == std::string_view(buffer.data(), result.ptr - buffer.data()));
+    }
 }
 #endif
 
+TEST_CASE( "write_float with precision matches printf" ){
+    std::mt19937_64 generator(7);
+    std::uniform_int_distribution<int> precision(0, 30);
+
+    for(size_t i = 0; i < 1000; i++){
+        const FloatingPoint val = random_float(generator);
+        const int p = precision(generator);
+        std::string out;
+
+        write_float(out, val, FloatNotation::Scientific, static_cast<size_t>(p));
+        REQUIRE(out == printf_float("%.*Le", p, val));
+
+        out.clear();
+        write_float(out, val, FloatNotation::General, static_cast<size_t>(p));
+        REQUIRE(out == printf_float("%.*Lg", p, val));
+
+        // Keep fixed notation to modest magnitudes
+        const FloatingPoint modest = std::ldexp(val, -std::ilogb(val) + (i % 200) - 100);
+        out.clear();
+        write_float(out, modest, FloatNotation::Fixed, static_cast<size_t>(p));
+        REQUIRE(out == printf_float("%.*Lf", p, modest));
+    }
+}
+
+TEST_CASE( "write_float (double) with precision matches printf" ){
+    std::mt19937_64 generator(8);
+    std::uniform_int_distribution<int> precision(0, 30);
+
+    for(size_t i = 0; i < 1000; i++){
+        const double val = random_double(generator);
+        const int p = precision(generator);
+        std::string out;
+
+        write_float(out, val, FloatNotation::Scientific, static_cast<size_t>(p));
+        REQUIRE(out == printf_float("%.*Le", p, val));
+
+        out.clear();
+        write_float(out, val, FloatNotation::General, static_cast<size_t>(p));
+        REQUIRE(out == printf_float("%.*Lg", p, val));
+    }
+}
+
 TEST_CASE( "strdecimal2floatingpoint" ){
     REQUIRE( std::abs(strdecimal2floatingpoint("4.2") - 4.2) < 1e-9 );
     REQUIRE( std::abs(strdecimal2floatingpoint("1234") - 1234.0) < 1e-9 );
@@ -197,6 +197,60 @@ TEST_CASE( "ckd_nrt (Exhaustive)" ) {
     REQUIRE(!failing_nrt.has_value());
 }
 
+TEST_CASE( "Integer roots (Floor between powers)" ) {
+    // Either side of each power the root is floored, which exercises the downward correction after Newton's iteration
+    auto check_around = [](size_t root, size_t power, size_t raised){
+        size_t result;
+        const bool exact = (power == 2) ? ckd_sqrt(&result, raised) : (power == 3) ? ckd_cbrt(&result, raised) : ckd_nrt(&result, raised, power);
+        if(exact || result != root) return false;
+        if(raised > 2){
+            const bool below = (power == 2) ? ckd_sqrt(&result, raised-1) : (power == 3) ? ckd_cbrt(&result, raised-1) : ckd_nrt(&result, raised-1, power);
+            if(!below || result != root-1) return false;
+        }
+        if(raised != MAX && raised > 1){
+            const bool above = (power == 2) ? ckd_sqrt(&result, raised+1) : (power == 3) ? ckd_cbrt(&result, raised+1) : ckd_nrt(&result, raised+1, power);
+            if(!above || result != root) return false;
+        }
+        return true;
+    };
+
+    std::optional<std::pair<size_t, size_t>> failing_root = std::nullopt;
+    constexpr size_t max_squarable_number = MAX >> (sizeof(size_t)*8/2);
+    for(size_t i = 0; i < (1uLL << 20) && !failing_root.has_value(); i++){
+        if(!check_around(i, 2, i*i)) failing_root = std::make_pair(i, 2);
+        const size_t large = max_squarable_number - i;
+        if(!check_around(large, 2, large*large)) failing_root = std::make_pair(large, 2);
+    }
+
+    for(size_t power = 3; power < sizeof(size_t)*8 && !failing_root.has_value(); power++){
+        size_t result;
+        for(size_t base = 0; base < (1uLL << 20) && !ckd_pow(&result, base, power); base++){
+            if(!check_around(base, power, result)){
+                failing_root = std::make_pair(base, power);
+                break;
+            }
+        }
+    }
+
+    REQUIRE(!failing_root.has_value());
+
+    size_t result;
+    REQUIRE(ckd_sqrt(&result, MAX));
+    REQUIRE(result == max_squarable_number);
+    REQUIRE(ckd_cbrt(&result, MAX));
+    REQUIRE(result == static_cast<size_t>(std::cbrtl(static_cast<long double>(MAX))));
+    for(size_t power = 4; power < sizeof(size_t)*8; power++){
+        size_t raised;
+        REQUIRE(ckd_nrt(&result, MAX, power));
+        REQUIRE_FALSE(ckd_pow(&raised, result, power));
+        REQUIRE(ckd_pow(&raised, result + 1, power));
+    }
+    REQUIRE(ckd_nrt(&result, MAX, sizeof(size_t)*8 - 1));
+    REQUIRE(result == 2);
+    REQUIRE(ckd_nrt(&result, 2, sizeof(size_t)*8 + 1));
+    REQUIRE(result == 1);
+}
+
 TEST_CASE( "ckd_pow" ) {
     size_t result;
 
@@ -230,6 +284,104 @@ TEST_CASE( "ckd_pow (More thorough)" ) {
     REQUIRE(!failing_pow.has_value());
 }
 
+TEST_CASE( "ckd_pow (Overflow boundary)" ) {
+    // Powers by repeated checked multiplication, against which the table of largest bases is confirmed
+    auto reference_pow = [](size_t* result, size_t base, size_t power){
+        *result = 1;
+        for(size_t i = 0; i < power; i++) if(ckd_mul(result, *result, base)) return true;
+        return false;
+    };
+
+    size_t result, expected;
+    for(size_t power = 2; power <= sizeof(size_t)*8 + 2; power++){
+        size_t max_base = static_cast<size_t>(std::pow(static_cast<double>(MAX), 1.0/power)) + 2;
+        while(reference_pow(&expected, max_base, power)) max_base--;
+
+        REQUIRE_FALSE(ckd_pow(&result, max_base, power));
+        REQUIRE(result == expected);
+        REQUIRE(knownfit_pow(max_base, power) == expected);
+        REQUIRE(ckd_pow(&result, max_base + 1, power));
+        REQUIRE(ckd_pow(&result, MAX, power));
+
+        REQUIRE_FALSE(ckd_pow(&result, 0, power));
+        REQUIRE(result == 0);
+        REQUIRE_FALSE(ckd_pow(&result, 1, power));
+        REQUIRE(result == 1);
+    }
+
+    REQUIRE_FALSE(ckd_pow(&result, MAX, 0));
+    REQUIRE(result == 1);
+    REQUIRE_FALSE(ckd_pow(&result, MAX, 1));
+    REQUIRE(result == MAX);
+    if constexpr(sizeof(size_t) == 8) REQUIRE(knownfit_pow(3, 40) == 12157665459056928801uLL);
+}
+
+TEST_CASE( "is_perfect_power" ) {
+    size_t base;
+
+    REQUIRE(is_perfect_power(&base, 0) == 1);
+    REQUIRE(base == 0);
+    REQUIRE(is_perfect_power(&base, 1) == 1);
+    REQUIRE(base == 1);
+    REQUIRE(is_perfect_power(&base, 2) == 1);
+    REQUIRE(base == 2);
+
+    REQUIRE(is_perfect_power(&base, 64) == 6);
+    REQUIRE(base == 2);
+    REQUIRE(is_perfect_power(&base, 729) == 6);
+    REQUIRE(base == 3);
+    REQUIRE(is_perfect_power(&base, 7776) == 5);
+    REQUIRE(base == 6);
+    REQUIRE(is_perfect_power(&base, 7777) == 1);
+    REQUIRE(base == 7777);
+
+    REQUIRE(is_perfect_power(&base, MAX) == 1);
+    REQUIRE(base == MAX);
+    REQUIRE(is_perfect_power(&base, size_t(1) << (sizeof(size_t)*8 - 1)) == sizeof(size_t)*8 - 1);
+    REQUIRE(base == 2);
+    constexpr size_t max_squarable_number = MAX >> (sizeof(size_t)*8/2);
+    REQUIRE(is_perfect_power(&base, max_squarable_number * max_squarable_number) == 2);
+    REQUIRE(base == max_squarable_number);
+}
+
+TEST_CASE( "is_perfect_power (Every power of small bases)" ) {
+    // Against the largest exponent found by trying every one, for every power of bases up to 2^12 and their neighbours
+    auto reference_exponent = [](size_t* base, size_t arg){
+        *base = arg;
+        if(arg < 4) return size_t(1);
+        for(size_t exponent = sizeof(size_t)*8 - 1; exponent >= 2; exponent--){
+            const size_t estimate = static_cast<size_t>(std::pow(static_cast<double>(arg), 1.0/exponent));
+            for(size_t candidate = (estimate > 0) ? estimate - 1 : 0; candidate <= estimate + 1; candidate++){
+                size_t raised;
+                if(candidate >= 2 && !ckd_pow(&raised, candidate, exponent) && raised == arg){
+                    *base = candidate;
+                    return exponent;
+                }
+            }
+        }
+        return size_t(1);
+    };
+
+    std::optional<size_t> failing_arg = std::nullopt;
+    auto check = [&](size_t arg){
+        size_t base, expected_base;
+        const size_t exponent = is_perfect_power(&base, arg);
+        if(exponent != reference_exponent(&expected_base, arg) || base != expected_base) failing_arg = arg;
+    };
+
+    for(size_t arg = 0; arg < (1uLL << 16) && !failing_arg.has_value(); arg++) check(arg);
+    for(size_t root = 2; root < (1uLL << 12) && !failing_arg.has_value(); root++){
+        size_t raised = root;
+        while(!ckd_mul(&raised, raised, root)){
+            check(raised - 1);
+            check(raised);
+            check(raised + 1);
+        }
+    }
+
+    REQUIRE(!failing_arg.has_value());
+}
+
 TEST_CASE( "write_native_int" ) {
     std::string str;
 
@@ -3,6 +3,8 @@
 #include "ki_cas_native_rational.h"
 
 #include "ki_cas_native_integer.h"
+#include <numeric>
+#include <unordered_set>
 
 using namespace KiCAS2;
 
@@ -157,6 +159,60 @@ TEST_CASE( "ckd_mul (NativeRational * NativeRational)" ) {
     REQUIRE(true == ckd_mul(&result, NativeRational(1, 2), NativeRational(1, MAX)));
 }
 
+TEST_CASE( "ckd_mul near overflow" ) {
+    NativeRational result;
+
+    SECTION("Zero"){
+        REQUIRE_FALSE(ckd_mul(&result, NativeRational(0, MAX), NativeRational(MAX, 3)));
+        REQUIRE(result.num == 0);
+        REQUIRE(result.den == 1);
+    }
+
+    SECTION("Ratio too large to reduce"){
+        REQUIRE(true == ckd_mul(&result, NativeRational(MAX, 1), NativeRational(MAX, 1)));
+        REQUIRE(true == ckd_mul(&result, NativeRational(1, MAX), NativeRational(1, 2)));
+    }
+
+    SECTION("Non-canonical operands"){
+        REQUIRE_FALSE(ckd_mul(&result, NativeRational(MAX-1, MAX-1), NativeRational(MAX, 6)));
+        REQUIRE(result.num == MAX/3);
+        REQUIRE(result.den == 2);
+
+        REQUIRE_FALSE(ckd_mul(&result, NativeRational(2*(MAX/6), 4*(MAX/6)), MAX-1));
+        REQUIRE(result.num == (MAX-1)/2);
+        REQUIRE(result.den == 1);
+    }
+
+    SECTION("Matches canonical cross reduction"){
+        // Canonical operands are fully reduced by cancelling across them
+        size_t state = 0x9E3779B97F4A7C15u;
+        auto next = [&state](){
+            state ^= state << 13;
+            state ^= state >> 7;
+            state ^= state << 17;
+            return state;
+        };
+
+        for(size_t i = 0; i < 10000; i++){
+            const size_t shift = next() % (std::numeric_limits<size_t>::digits / 2);
+            NativeRational a(next() >> shift | 1, next() >> shift | 1);
+            NativeRational b(next() >> (shift/2) | 1, next() >> (shift/2) | 1);
+            a.reduceInPlace();
+            b.reduceInPlace();
+
+            const size_t gcd_a_num_b_den = std::gcd(a.num, b.den);
+            const size_t gcd_b_num_a_den = std::gcd(b.num, a.den);
+            NativeRational expected;
+            const bool overflow =
+                ckd_mul(&expected.num, a.num / gcd_a_num_b_den, b.num / gcd_b_num_a_den)
+                || ckd_mul(&expected.den, a.den / gcd_b_num_a_den, b.den / gcd_a_num_b_den);
+
+            REQUIRE(ckd_mul(&result, a, b) == overflow);
+            if(!overflow) REQUIRE(result == expected);
+        }
+    }
+}
+
 TEST_CASE( "ckd_div (NativeRational / size_t)" ) {
     NativeRational result;
 
@@ -240,6 +296,19 @@ TEST_CASE( "ckd_add (NativeRational + NativeRational)" ) {
     REQUIRE(result.den == 2);
 
     REQUIRE(true == ckd_add(&result, NativeRational(1, MAX), NativeRational(1, 2)));
+
+    if constexpr(std::numeric_limits<size_t>::digits == 64){
+        // Only fits once the numerator is reduced against the common factor of the denominators
+        constexpr size_t PRIME = (size_t(1) << 61) - 1;
+        REQUIRE_FALSE(ckd_add(&result, NativeRational(1, 3*PRIME), NativeRational((2*PRIME - 5)/3, 5*PRIME)));
+        REQUIRE(result.num == 2);
+        REQUIRE(result.den == 15);
+
+        // Sums near 2^128 before reduction
+        REQUIRE_FALSE(ckd_add(&result, NativeRational(MAX, MAX-1), NativeRational(MAX-2, MAX-1)));
+        REQUIRE(result.num == 2);
+        REQUIRE(result.den == 1);
+    }
 }
 
 TEST_CASE( "sub (NativeRational - size_t)" ) {
@@ -277,13 +346,380 @@ TEST_CASE( "ckd_sub (NativeRational - NativeRational)" ) {
 
     REQUIRE_FALSE(ckd_sub(&result, NativeRational(2, MAX), NativeRational(2, MAX)));
     REQUIRE(result.num == 0);
-    REQUIRE(result.den == MAX);
+    REQUIRE(result.den == 1);
 
     REQUIRE_FALSE(ckd_sub(&result, NativeRational(2, 3), NativeRational((MAX-1)/2, MAX-1)));
     REQUIRE(result.num == 1);
     REQUIRE(result.den == 6);
 
     REQUIRE(true == ckd_sub(&result, NativeRational(1, MAX-1), NativeRational(1, MAX)));
+
+    if constexpr(std::numeric_limits<size_t>::digits == 64){
+        // Only fits once the numerator is reduced against the common factor of the denominators
+        constexpr size_t PRIME = (size_t(1) << 61) - 1;
+        REQUIRE_FALSE(ckd_sub(&result, NativeRational((PRIME + 5)/3, 5*PRIME), NativeRational(1, 3*PRIME)));
+        REQUIRE(result.num == 1);
+        REQUIRE(result.den == 15);
+    }
+}
+
+TEST_CASE( "is_perfect_power (NativeRational)" ) {
+    NativeRational base;
+
+    // 2^12 / 3^6 = (4/3)^6, whose numerator alone is a 12th power
+    REQUIRE(is_perfect_power(&base, NativeRational(4096, 729)) == 6);
+    REQUIRE(base.num == 4);
+    REQUIRE(base.den == 3);
+
+    // 2^6 / 5^4 shares only squares
+    REQUIRE(is_perfect_power(&base, NativeRational(64, 625)) == 2);
+    REQUIRE(base.num == 8);
+    REQUIRE(base.den == 25);
+
+    // 2^3 / 3^2 shares no exponent
+    REQUIRE(is_perfect_power(&base, NativeRational(8, 9)) == 1);
+    REQUIRE(base.num == 8);
+    REQUIRE(base.den == 9);
+
+    REQUIRE(is_perfect_power(&base, NativeRational(10, 9)) == 1);
+    REQUIRE(base.num == 10);
+    REQUIRE(base.den == 9);
+
+    REQUIRE(is_perfect_power(&base, NativeRational(1, 243)) == 5);
+    REQUIRE(base.num == 1);
+    REQUIRE(base.den == 3);
+
+    REQUIRE(is_perfect_power(&base, NativeRational(343, 1)) == 3);
+    REQUIRE(base.num == 7);
+    REQUIRE(base.den == 1);
+
+    REQUIRE(is_perfect_power(&base, NativeRational(0, 1)) == 1);
+    REQUIRE(base.num == 0);
+    REQUIRE(base.den == 1);
+
+    REQUIRE(is_perfect_power(&base, NativeRational(1, 1)) == 1);
+    REQUIRE(base.num == 1);
+    REQUIRE(base.den == 1);
+
+    SECTION("Unreduced arguments"){
+        REQUIRE(is_perfect_power(&base, NativeRational(8, 32)) == 2);
+        REQUIRE(base.num == 1);
+        REQUIRE(base.den == 2);
+
+        REQUIRE(is_perfect_power(&base, NativeRational(2, 8)) == 2);
+        REQUIRE(base.num == 1);
+        REQUIRE(base.den == 2);
+
+        REQUIRE(is_perfect_power(&base, NativeRational(54, 16)) == 3);
+        REQUIRE(base.num == 3);
+        REQUIRE(base.den == 2);
+
+        REQUIRE(is_perfect_power(&base, NativeRational(4, 2)) == 1);
+        REQUIRE(base.num == 2);
+        REQUIRE(base.den == 1);
+
+        REQUIRE(is_perfect_power(&base, NativeRational(0, 5)) == 1);
+        REQUIRE(base.num == 0);
+        REQUIRE(base.den == 1);
+    }
+}
+
+TEST_CASE( "CanonicalRational" ) {
+    CanonicalRational result;
+
+    SECTION("Construction"){
+        const CanonicalRational val(NativeRational(6, 4));
+        REQUIRE(val.num() == 3);
+        REQUIRE(val.den() == 2);
+        REQUIRE(val.reciprocal().num() == 2);
+        REQUIRE(val.reciprocal().den() == 3);
+        REQUIRE(CanonicalRational(NativeRational(0, 7)).den() == 1);
+    }
+
+    SECTION("Integer operands"){
+        const CanonicalRational a(NativeRational(3, 10));
+
+        REQUIRE_FALSE(ckd_mul(&result, a, 4));
+        REQUIRE(result.num() == 6);
+        REQUIRE(result.den() == 5);
+
+        REQUIRE_FALSE(ckd_div(&result, a, 9));
+        REQUIRE(result.num() == 1);
+        REQUIRE(result.den() == 30);
+
+        REQUIRE_FALSE(ckd_add(&result, a, 2));
+        REQUIRE(result.num() == 23);
+        REQUIRE(result.den() == 10);
+
+        REQUIRE(true == ckd_mul(&result, CanonicalRational(NativeRational(MAX, 2)), 3));
+        REQUIRE(true == ckd_div(&result, CanonicalRational(NativeRational(2, MAX)), 3));
+        REQUIRE(true == ckd_add(&result, CanonicalRational(NativeRational(MAX, 2)), 1));
+    }
+
+    SECTION("Zero"){
+        const CanonicalRational zero(NativeRational(0, 1));
+        const CanonicalRational a(NativeRational(5, MAX));
+
+        REQUIRE_FALSE(ckd_mul(&result, zero, a));
+        REQUIRE(result.num() == 0);
+        REQUIRE(result.den() == 1);
+
+        REQUIRE_FALSE(ckd_sub(&result, a, a));
+        REQUIRE(result.num() == 0);
+        REQUIRE(result.den() == 1);
+    }
+
+    SECTION("Cancellation near overflow"){
+        const CanonicalRational a(NativeRational(MAX-2, MAX-1));
+        const CanonicalRational b(NativeRational(MAX, MAX-1));
+
+        REQUIRE_FALSE(ckd_add(&result, a, b));
+        REQUIRE(result.num() == 2);
+        REQUIRE(result.den() == 1);
+
+        REQUIRE_FALSE(ckd_sub(&result, b, a));
+        REQUIRE(result.num() == 1);
+        REQUIRE(result.den() == (MAX-1)/2);
+
+        REQUIRE_FALSE(ckd_mul(&result, a, b.reciprocal()));
+        REQUIRE(result.num() == MAX-2);
+        REQUIRE(result.den() == MAX);
+
+        REQUIRE(true == ckd_add(&result, CanonicalRational(NativeRational(1, MAX)), CanonicalRational(NativeRational(1, MAX-1))));
+    }
+
+    SECTION("Matches reduced NativeRational arithmetic"){
+        size_t state = 0x2545F4914F6CDD1Du;
+        auto next = [&state](){
+            state ^= state << 13;
+            state ^= state >> 7;
+            state ^= state << 17;
+            return state;
+        };
+
+        for(size_t i = 0; i < 10000; i++){
+            const size_t shift = next() % (std::numeric_limits<size_t>::digits / 2);
+            const CanonicalRational a(NativeRational(next() >> shift, next() >> shift | 1));
+            const CanonicalRational b(NativeRational(next() >> (shift/2), next() >> (shift/2) | 1));
+            const size_t n = next() >> (std::numeric_limits<size_t>::digits - 12) | 1;
+
+            const auto check = [&result](bool canonical_overflow, bool native_overflow, NativeRational expected){
+                REQUIRE(canonical_overflow == native_overflow);
+                if(canonical_overflow) return;
+                expected.reduceInPlace();
+                REQUIRE(result.num() == expected.num);
+                REQUIRE(result.den() == expected.den);
+            };
+
+            NativeRational expected;
+            check(ckd_mul(&result, a, b), ckd_mul(&expected, a, b), expected);
+            check(ckd_mul(&result, a, n), ckd_mul(&expected, a, n), expected);
+            check(ckd_add(&result, a, n), ckd_add(&expected, a, n), expected);
+            check(ckd_add(&result, a, b), ckd_add(&expected, a, b), expected);
+            if(NativeRational(a) >= NativeRational(b))
+                check(ckd_sub(&result, a, b), ckd_sub(&expected, a, b), expected);
+            if(b.num() != 0)
+                check(ckd_div(&result, a, b), ckd_div(&expected, a, b), expected);
+            check(ckd_div(&result, a, n), ckd_div(&expected, a, n), expected);
+        }
+    }
+}
+
+TEST_CASE( "SignedNativeRational" ) {
+    SignedNativeRational result;
+    const SignedNativeRational half(NativeRational(1, 2));
+    const SignedNativeRational minus_third(NativeRational(1, 3), true);
+
+    SECTION("Construction"){
+        REQUIRE(minus_third.isNegative());
+        REQUIRE(minus_third.magnitude() == NativeRational(1, 3));
+        REQUIRE_FALSE(minus_third.negated().isNegative());
+        REQUIRE(minus_third.reciprocal() == SignedNativeRational(NativeRational(3, 1), true));
+        REQUIRE(static_cast<double>(minus_third) == -1.0/3);
+
+        // Zero is never negative
+        REQUIRE_FALSE(SignedNativeRational(NativeRational(0, 5), true).isNegative());
+        REQUIRE(SignedNativeRational(NativeRational(0, 5), true) == SignedNativeRational(NativeRational(0, 1)));
+    }
+
+    SECTION("Comparisons"){
+        REQUIRE(minus_third < half);
+        REQUIRE(half > minus_third);
+        REQUIRE(minus_third.negated() < half);
+        REQUIRE(minus_third < SignedNativeRational(NativeRational(1, 4), true));
+        REQUIRE(SignedNativeRational(NativeRational(MAX, 1), true) < minus_third);
+        REQUIRE(minus_third <= SignedNativeRational(NativeRational(2, 6), true));
+        REQUIRE(minus_third >= SignedNativeRational(NativeRational(2, 6), true));
+        REQUIRE(minus_third == SignedNativeRational(NativeRational(2, 6), true));
+        REQUIRE(minus_third != minus_third.negated());
+    }
+
+    SECTION("Arithmetic"){
+        REQUIRE_FALSE(ckd_add(&result, half, minus_third));
+        REQUIRE(result == SignedNativeRational(NativeRational(1, 6)));
+
+        REQUIRE_FALSE(ckd_add(&result, minus_third, minus_third));
+        REQUIRE(result == SignedNativeRational(NativeRational(2, 3), true));
+
+        REQUIRE_FALSE(ckd_sub(&result, minus_third, half));
+        REQUIRE(result == SignedNativeRational(NativeRational(5, 6), true));
+
+        REQUIRE_FALSE(ckd_sub(&result, minus_third, minus_third));
+        REQUIRE(result.magnitude().num == 0);
+        REQUIRE_FALSE(result.isNegative());
+
+        REQUIRE_FALSE(ckd_mul(&result, half, minus_third));
+        REQUIRE(result == SignedNativeRational(NativeRational(1, 6), true));
+
+        REQUIRE_FALSE(ckd_mul(&result, minus_third, minus_third));
+        REQUIRE(result == SignedNativeRational(NativeRational(1, 9)));
+
+        REQUIRE_FALSE(ckd_div(&result, half, minus_third));
+        REQUIRE(result == SignedNativeRational(NativeRational(3, 2), true));
+
+        REQUIRE_FALSE(ckd_mul(&result, SignedNativeRational(NativeRational(0, 1)), minus_third));
+        REQUIRE_FALSE(result.isNegative());
+    }
+
+    SECTION("Full range"){
+        const SignedNativeRational max(NativeRational(MAX, 1));
+        const SignedNativeRational min(NativeRational(MAX, 1), true);
+
+        REQUIRE_FALSE(ckd_add(&result, max, min));
+        REQUIRE(result.magnitude().num == 0);
+
+        REQUIRE_FALSE(ckd_sub(&result, min, SignedNativeRational(NativeRational(1, 1), true)));
+        REQUIRE(result == SignedNativeRational(NativeRational(MAX-1, 1), true));
+
+        REQUIRE(ckd_sub(&result, min, SignedNativeRational(NativeRational(1, 1))));
+        REQUIRE(ckd_sub(&result, max, min));
+        REQUIRE(ckd_mul(&result, min, SignedNativeRational(NativeRational(2, 1), true)));
+
+        // The wide difference of opposite signs cancels near overflow
+        const SignedNativeRational a(NativeRational(MAX-2, MAX-1), true);
+        const SignedNativeRational b(NativeRational(MAX, MAX-1));
+        REQUIRE_FALSE(ckd_add(&result, a, b));
+        REQUIRE(result.magnitude().num == 1);
+        REQUIRE(result.magnitude().den == (MAX-1)/2);
+        REQUIRE_FALSE(result.isNegative());
+
+        REQUIRE_FALSE(ckd_add(&result, b.negated(), a.negated()));
+        REQUIRE(result.magnitude().num == 1);
+        REQUIRE(result.magnitude().den == (MAX-1)/2);
+        REQUIRE(result.isNegative());
+    }
+
+    SECTION("Matches NativeRational arithmetic on magnitudes"){
+        size_t state = 0x5851F42D4C957F2Du;
+        auto next = [&state](){
+            state ^= state << 13;
+            state ^= state >> 7;
+            state ^= state << 17;
+            return state;
+        };
+
+        for(size_t i = 0; i < 10000; i++){
+            const size_t shift = next() % (std::numeric_limits<size_t>::digits / 2);
+            const NativeRational a(next() >> shift, next() >> shift | 1);
+            const NativeRational b(next() >> (shift/2), next() >> (shift/2) | 1);
+            const SignedNativeRational signed_a(a, next() & 1);
+            const SignedNativeRational signed_b(b, next() & 1);
+
+            // Opposite signs make the sum a difference of magnitudes
+            NativeRational expected;
+            const bool same_sign = signed_a.isNegative() == signed_b.isNegative();
+            bool expected_overflow;
+            if(same_sign) expected_overflow = ckd_add(&expected, a, b);
+            else if(a >= b) expected_overflow = ckd_sub(&expected, a, b);
+            else expected_overflow = ckd_sub(&expected, b, a);
+
+            REQUIRE(ckd_add(&result, signed_a, signed_b) == expected_overflow);
+            if(!expected_overflow){
+                REQUIRE(result.magnitude() == expected);
+                const bool expected_negative = expected.num != 0
+                                               && (same_sign || a >= b ? signed_a.isNegative() : signed_b.isNegative());
+                REQUIRE(result.isNegative() == expected_negative);
+            }
+
+            const bool mul_overflow = ckd_mul(&expected, a, b);
+            REQUIRE(ckd_mul(&result, signed_a, signed_b) == mul_overflow);
+            if(!mul_overflow && expected.num != 0) REQUIRE(result.isNegative() == (signed_a.isNegative() != signed_b.isNegative()));
+        }
+    }
+}
+
+TEST_CASE( "canonical_hash" ) {
+    REQUIRE(canonical_hash(NativeRational(2, 4)) == canonical_hash(NativeRational(1, 2)));
+    REQUIRE(canonical_hash(NativeRational(0, 7)) == canonical_hash(NativeRational(0, 1)));
+    REQUIRE(canonical_hash(NativeRational(MAX, MAX)) == canonical_hash(NativeRational(1, 1)));
+    REQUIRE(canonical_hash(CanonicalRational(NativeRational(6, 4))) == canonical_hash(NativeRational(3, 2)));
+    REQUIRE(canonical_hash(NativeRational(1, 2)) != canonical_hash(NativeRational(2, 1)));
+    REQUIRE(canonical_hash(NativeRational(1, 2)) != canonical_hash(NativeRational(1, 3)));
+
+    REQUIRE(canonical_hash(SignedNativeRational(NativeRational(4, 6))) == canonical_hash(NativeRational(2, 3)));
+    REQUIRE(canonical_hash(SignedNativeRational(NativeRational(2, 3), true)) != canonical_hash(NativeRational(2, 3)));
+    REQUIRE(canonical_hash(SignedNativeRational(NativeRational(0, 3), true)) == canonical_hash(NativeRational(0, 1)));
+
+    SECTION("Unordered containers"){
+        std::unordered_set<NativeRational> set;
+        for(size_t den = 1; den <= 100; den++) set.insert(NativeRational(den, den));
+        REQUIRE(set.size() == 1);
+
+        std::unordered_set<SignedNativeRational> signed_set;
+        signed_set.insert(SignedNativeRational(NativeRational(1, 2)));
+        signed_set.insert(SignedNativeRational(NativeRational(1, 2), true));
+        signed_set.insert(SignedNativeRational(NativeRational(2, 4), true));
+        REQUIRE(signed_set.size() == 2);
+    }
+
+    SECTION("Few collisions"){
+        std::unordered_set<size_t> hashes;
+        for(size_t num = 0; num < 200; num++)
+            for(size_t den = 1; den <= 200; den++)
+                if(std::gcd(num, den) == 1) hashes.insert(canonical_hash(NativeRational(num, den)));
+        size_t num_canonical = 0;
+        for(size_t num = 0; num < 200; num++)
+            for(size_t den = 1; den <= 200; den++)
+                num_canonical += (std::gcd(num, den) == 1);
+        REQUIRE(hashes.size() == num_canonical);
+    }
+}
+
+TEST_CASE( "write_native_rational (SignedNativeRational)" ) {
+    std::string str = "x + ";
+    const SignedNativeRational val(NativeRational(3, 2), true);
+
+    SECTION("plaintext"){
+        write_native_rational<PLAINTEXT_OUTPUT>(str, val);
+        REQUIRE(str == "x + -3/2");
+    }
+
+    SECTION("latex"){
+        write_native_rational<LatexStyle>(str, val);
+        REQUIRE(str == "x + -\\frac{3}{2}");
+    }
+
+    SECTION("mathml"){
+        write_native_rational<MathMLStyle>(str, val);
+        REQUIRE(str == "x + <mo>-</mo><mfrac><mn>3</mn><mn>2</mn></mfrac>");
+    }
+
+    SECTION("positive"){
+        write_native_rational(str, val.negated());
+        REQUIRE(str == "x + 3/2");
+    }
+
+    SECTION("decimal"){
+        write_rational_as_decimal(str, SignedNativeRational(NativeRational(3, 8), true));
+        REQUIRE(str == "x + -0.375");
+    }
+
+    SECTION("OutputBuilder"){
+        OutputBuilder out;
+        write_native_rational(out, val);
+        write_rational_as_decimal(out, SignedNativeRational(NativeRational(1, 6), true));
+        REQUIRE(out.str() == "-3/2-0.1(6)");
+    }
 }
 
 TEST_CASE( "write_native_rational" ) {
@@ -299,6 +735,103 @@ TEST_CASE( "write_native_rational" ) {
         write_native_rational<TYPESET_OUTPUT>(str, num);
         REQUIRE(str == "x + ⁜f⏴3⏵⏴2⏵");
     }
+
+    SECTION("latex"){
+        write_native_rational<LatexStyle>(str, num);
+        REQUIRE(str == "x + \\frac{3}{2}");
+    }
+
+    SECTION("mathml"){
+        write_native_rational<MathMLStyle>(str, num);
+        REQUIRE(str == "x + <mfrac><mn>3</mn><mn>2</mn></mfrac>");
+    }
+
+    SECTION("max"){
+        write_native_rational(str, NativeRational(MAX, 1));
+        REQUIRE(str == "x + " + std::to_string(MAX));
+    }
+
+    SECTION("unit denominator"){
+        // Styles which omit a unit denominator write integers alone, while typeset keeps the fraction
+        write_native_rational<LatexStyle>(str, NativeRational(3, 1));
+        REQUIRE(str == "x + 3");
+        str.clear();
+        write_native_rational<MathMLStyle>(str, NativeRational(3, 1));
+        REQUIRE(str == "<mn>3</mn>");
+        str.clear();
+        write_native_rational<TYPESET_OUTPUT>(str, NativeRational(3, 1));
+        REQUIRE(str == "⁜f⏴3⏵⏴1⏵");
+    }
+}
+
+TEST_CASE( "write_rational_as_decimal" ) {
+    std::string str = "x + ";
+
+    SECTION("Integer"){
+        write_rational_as_decimal(str, NativeRational(10, 2));
+        REQUIRE(str == "x + 5");
+    }
+
+    SECTION("Terminating"){
+        write_rational_as_decimal(str, NativeRational(3, 8));
+        REQUIRE(str == "x + 0.375");
+        str.clear();
+        write_rational_as_decimal(str, NativeRational(2049, 1024));
+        REQUIRE(str == "2.0009765625");
+        str.clear();
+        write_rational_as_decimal(str, NativeRational(6, 16));
+        REQUIRE(str == "0.375");
+    }
+
+    SECTION("Repeating"){
+        write_rational_as_decimal(str, NativeRational(1, 3));
+        REQUIRE(str == "x + 0.(3)");
+        str.clear();
+        write_rational_as_decimal(str, NativeRational(1, 6));
+        REQUIRE(str == "0.1(6)");
+        str.clear();
+        write_rational_as_decimal(str, NativeRational(22, 7));
+        REQUIRE(str == "3.(142857)");
+        str.clear();
+        write_rational_as_decimal(str, NativeRational(1, 17));
+        REQUIRE(str == "0.(0588235294117647)");
+        str.clear();
+        write_rational_as_decimal(str, NativeRational(1, 99));
+        REQUIRE(str == "0.(01)");
+    }
+
+    SECTION("Cut off"){
+        write_rational_as_decimal(str, NativeRational(1, 97));
+        REQUIRE(str == "x + 0.01030927835051546391752577319587...");
+        str.clear();
+        write_rational_as_decimal(str, NativeRational(1, 7), 5);
+        REQUIRE(str == "0.14285...");
+        str.clear();
+        write_rational_as_decimal(str, NativeRational(1, 6), 1);
+        REQUIRE(str == "0.1...");
+        str.clear();
+        write_rational_as_decimal(str, NativeRational(1, 1024), 3);
+        REQUIRE(str == "0.000...");
+        str.clear();
+        write_rational_as_decimal(str, NativeRational(3, 2), 0);
+        REQUIRE(str == "1...");
+    }
+
+    SECTION("Large denominators"){
+        write_rational_as_decimal(str, NativeRational(1, size_t(1) << (std::numeric_limits<size_t>::digits-1)), 64);
+        write_rational_as_decimal(str, NativeRational(MAX, MAX-1));
+        write_rational_as_decimal(str, NativeRational(MAX-2, MAX));
+        if constexpr(std::numeric_limits<size_t>::digits == 64)
+            REQUIRE(str == "x + 0.000000000000000000108420217248550443400745280086994171142578125"
+                           "1.00000000000000000005421010862427..."
+                           "0.99999999999999999989157978275144...");
+    }
+
+    SECTION("Output builder"){
+        OutputBuilder out;
+        write_rational_as_decimal(out, NativeRational(1, 6));
+        REQUIRE(out.str() == "0.1(6)");
+    }
 }
 
 TEST_CASE( "ckd_strdecimaltail2rat" ) {
@@ -0,0 +1,199 @@
+#include <catch2/catch_test_macros.hpp>
+
+#include "ki_cas_native_rational_array.h"
+
+#include <limits>
+#include <vector>
+
+using namespace KiCAS2;
+
+static constexpr size_t MAX = std::numeric_limits<size_t>::max();
+
+/// Operand pairs mixing small values, which take the branch-free pass, with large values, which fall back to scalar
+static void randomOperands(NativeRationalArray* a, NativeRationalArray* b, size_t size) {
+    size_t state = 0x9E3779B97F4A7C15u;
+    auto next = [&state](){
+        state ^= state << 13;
+        state ^= state >> 7;
+        state ^= state << 17;
+        return state;
+    };
+    auto operand = [&next](){
+        const size_t shift = next() % std::numeric_limits<size_t>::digits;
+        return NativeRational(next() >> shift, (next() >> (next() % std::numeric_limits<size_t>::digits)) | 1);
+    };
+
+    for(size_t i = 0; i < size; i++){
+        a->push_back(operand());
+        b->push_back(operand());
+    }
+}
+
+TEST_CASE( "NativeRationalArray" ) {
+    NativeRationalArray a;
+    a.push_back(NativeRational(1, 2));
+    a.push_back(NativeRational(MAX, 3));
+    a.push_back(NativeRational(3, 4));
+
+    NativeRationalArray b(3);
+    b.set(0, NativeRational(1, 3));
+    b.set(1, NativeRational(MAX, 2));
+    b.set(2, NativeRational(3, 4));
+
+    REQUIRE(a.size() == 3);
+    REQUIRE(a[1].num == MAX);
+    REQUIRE(b[2].den == 4);
+
+    NativeRationalArray result;
+    std::vector<uint8_t> overflow;
+
+    SECTION("add"){
+        REQUIRE(ckd_add(&result, a, b, &overflow));
+        REQUIRE(overflow == std::vector<uint8_t>{0, 1, 0});
+        REQUIRE(result[0] == NativeRational(5, 6));
+        REQUIRE(result[2] == NativeRational(3, 2));
+    }
+
+    SECTION("sub"){
+        REQUIRE(ckd_sub(&result, a, b, &overflow));
+        REQUIRE(overflow == std::vector<uint8_t>{0, 1, 0});
+        REQUIRE(result[0] == NativeRational(1, 6));
+        REQUIRE(result[2].num == 0);
+    }
+
+    SECTION("mul"){
+        REQUIRE(ckd_mul(&result, a, b, &overflow));
+        REQUIRE(overflow == std::vector<uint8_t>{0, 1, 0});
+        REQUIRE(result[0] == NativeRational(1, 6));
+        REQUIRE(result[2] == NativeRational(9, 16));
+    }
+
+    SECTION("div"){
+        // MAX/3 / (MAX/2) overflows the branch-free pass, but reduces to fit in the scalar pass
+        REQUIRE_FALSE(ckd_div(&result, a, b, &overflow));
+        REQUIRE(overflow == std::vector<uint8_t>{0, 0, 0});
+        REQUIRE(result[0] == NativeRational(3, 2));
+        REQUIRE(result[1] == NativeRational(2, 3));
+        REQUIRE(result[2] == size_t(1));
+    }
+
+    SECTION("cmp"){
+        std::vector<int8_t> ordering;
+        cmp(&ordering, a, b);
+        REQUIRE(ordering == std::vector<int8_t>{1, -1, 0});
+    }
+
+    SECTION("Negative differences are flagged"){
+        REQUIRE(ckd_sub(&result, b, a, &overflow));
+        REQUIRE(overflow == std::vector<uint8_t>{1, 0, 0});
+        REQUIRE(result[1] == NativeRational(MAX, 6));
+    }
+
+    SECTION("Result aliasing an operand"){
+        REQUIRE_FALSE(ckd_div(&a, a, b, &overflow));
+        REQUIRE(a[1] == NativeRational(2, 3));
+        REQUIRE_FALSE(ckd_mul(&b, a, b, &overflow));
+        REQUIRE(b[1] == NativeRational(MAX, 3));
+    }
+
+    SECTION("Empty"){
+        const NativeRationalArray empty;
+        REQUIRE_FALSE(ckd_add(&result, empty, empty, &overflow));
+        REQUIRE(result.size() == 0);
+        REQUIRE(overflow.empty());
+    }
+}
+
+TEST_CASE( "NativeRationalArray kernels match scalar functions" ) {
+    NativeRationalArray a;
+    NativeRationalArray b;
+    randomOperands(&a, &b, 5000);
+
+    NativeRationalArray result;
+    std::vector<uint8_t> overflow;
+
+    const auto check = [&](bool any_overflow, auto scalar){
+        bool expected_any = false;
+        for(size_t i = 0; i < a.size(); i++){
+            NativeRational expected;
+            const bool expected_overflow = scalar(&expected, a[i], b[i]);
+            expected_any |= expected_overflow;
+            REQUIRE(overflow[i] == expected_overflow);
+            if(!expected_overflow) REQUIRE(result[i] == expected);
+        }
+        REQUIRE(any_overflow == expected_any);
+    };
+
+    check(ckd_add(&result, a, b, &overflow),
+          [](NativeRational* val, NativeRational a, NativeRational b){ return ckd_add(val, a, b); });
+    check(ckd_sub(&result, a, b, &overflow),
+          [](NativeRational* val, NativeRational a, NativeRational b){ return a < b || ckd_sub(val, a, b); });
+    check(ckd_mul(&result, a, b, &overflow),
+          [](NativeRational* val, NativeRational a, NativeRational b){ return ckd_mul(val, a, b); });
+
+    for(size_t i = 0; i < b.size(); i++) if(b.num[i] == 0) b.num[i] = 1;
+    check(ckd_div(&result, a, b, &overflow),
+          [](NativeRational* val, NativeRational a, NativeRational b){ return ckd_div(val, a, b); });
+
+    std::vector<int8_t> ordering;
+    cmp(&ordering, a, b);
+    for(size_t i = 0; i < a.size(); i++) REQUIRE(ordering[i] == (a[i] < b[i] ? -1 : a[i] > b[i] ? 1 : 0));
+}
+
+TEST_CASE( "canonicalise" ) {
+    NativeRationalArray vals;
+    randomOperands(&vals, &vals, 5000);  // Enough for the threaded driver to split
+
+    // Common factors, powers of 2, zeros, equal values and a tail shorter than a block of lanes
+    vals.push_back(NativeRational(0, MAX));
+    vals.push_back(NativeRational(12, 18));
+    vals.push_back(NativeRational(MAX, MAX));
+    vals.push_back(NativeRational(size_t(1) << (std::numeric_limits<size_t>::digits-1), 1024));
+    vals.push_back(NativeRational(1250, 1000));
+    vals.push_back(NativeRational(MAX-1, (MAX-1)/2));
+    for(size_t i = 0; i < vals.size(); i += 7) vals.num[i] *= 10;
+
+    std::vector<NativeRational> expected;
+    for(size_t i = 0; i < vals.size(); i++){
+        NativeRational val = vals[i];
+        val.reduceInPlace();
+        expected.push_back(val);
+    }
+
+    for(const size_t num_threads : {1, 3}){
+        NativeRationalArray soa = vals;
+        canonicalise(&soa, num_threads);
+        std::vector<NativeRational> aos;
+        for(size_t i = 0; i < vals.size(); i++) aos.push_back(vals[i]);
+        canonicalise(aos.data(), aos.size(), num_threads);
+
+        for(size_t i = 0; i < vals.size(); i++){
+            REQUIRE(soa.num[i] == expected[i].num);
+            REQUIRE(soa.den[i] == expected[i].den);
+            REQUIRE(aos[i].num == expected[i].num);
+            REQUIRE(aos[i].den == expected[i].den);
+        }
+    }
+
+    canonicalise(static_cast<NativeRational*>(nullptr), 0);
+}
+
+TEST_CASE( "canonical_hashes" ) {
+    NativeRationalArray vals;
+    randomOperands(&vals, &vals, 500);
+    vals.push_back(NativeRational(0, 3));
+    vals.push_back(NativeRational(6, 4));
+    vals.push_back(NativeRational(MAX, MAX));
+
+    std::vector<size_t> hashes(vals.size());
+    canonical_hashes(hashes.data(), vals);
+    std::vector<NativeRational> aos;
+    for(size_t i = 0; i < vals.size(); i++) aos.push_back(vals[i]);
+    std::vector<size_t> aos_hashes(aos.size());
+    canonical_hashes(aos_hashes.data(), aos.data(), aos.size());
+
+    for(size_t i = 0; i < vals.size(); i++){
+        REQUIRE(hashes[i] == canonical_hash(vals[i]));
+        REQUIRE(aos_hashes[i] == hashes[i]);
+    }
+}
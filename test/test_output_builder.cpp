@@ -0,0 +1,145 @@
+#include <catch2/catch_test_macros.hpp>
+
+#include "ki_cas_output_builder.h"
+
+#include "ki_cas_big_num_wrapper.h"
+#include "ki_cas_native_float.h"
+#include "ki_cas_native_integer.h"
+#include "ki_cas_native_rational.h"
+#include <cstdio>
+
+#ifdef _WIN32
+#define fileno _fileno
+#endif
+
+using namespace KiCAS2;
+
+static constexpr size_t MAX = std::numeric_limits<size_t>::max();
+
+TEST_CASE( "OutputBuilder" ) {
+    // Deliberately tiny chunks to exercise the chunk boundaries
+    OutputBuilder out(8);
+    REQUIRE(out.size() == 0);
+    REQUIRE(out.str() == "");
+
+    out.append("x + ");
+    out.append('y');
+    REQUIRE(out.size() == 5);
+    REQUIRE(out.str() == "x + y");
+
+    out.append(" = a much longer string than one chunk");
+    REQUIRE(out.str() == "x + y = a much longer string than one chunk");
+
+    char* buffer = out.reserve(32);
+    buffer[0] = '!';
+    buffer[1] = '?';
+    out.commit(1);
+    REQUIRE(out.str() == "x + y = a much longer string than one chunk!");
+
+    std::string str = "prefix: ";
+    out.appendTo(str);
+    REQUIRE(str == "prefix: x + y = a much longer string than one chunk!");
+
+    SECTION("Reuse after clear"){
+        out.clear();
+        REQUIRE(out.size() == 0);
+        REQUIRE(out.str() == "");
+
+        std::string expected;
+        for(size_t i = 0; i < 100; i++){
+            out.append("abc");
+            expected += "abc";
+        }
+        REQUIRE(out.str() == expected);
+    }
+}
+
+TEST_CASE( "OutputBuilder::writeTo" ) {
+    OutputBuilder out(16);
+    std::string expected;
+    for(size_t i = 0; i < 1000; i++){
+        write_native_int(out, i);
+        out.append(',');
+        write_native_int(expected, i);
+        expected += ',';
+    }
+
+    FILE* file = std::tmpfile();
+    REQUIRE(file != nullptr);
+    REQUIRE_FALSE(out.writeTo(fileno(file)));
+
+    std::rewind(file);
+    std::string written(expected.size(), '\0');
+    REQUIRE(std::fread(written.data(), 1, written.size(), file) == expected.size());
+    REQUIRE(written == expected);
+    std::fclose(file);
+}
+
+TEST_CASE( "OutputBuilder writers" ) {
+    OutputBuilder out(16);
+    std::string expected;
+
+    SECTION("write_native_int"){
+        for(const size_t val : {size_t(0), size_t(42), MAX}){
+            write_native_int(out, val);
+            write_native_int(expected, val);
+        }
+        REQUIRE(out.str() == expected);
+    }
+
+    SECTION("write_native_rational"){
+        for(const NativeRational val : {NativeRational(3, 2), NativeRational(MAX, MAX-1)}){
+            write_native_rational<PLAINTEXT_OUTPUT>(out, val);
+            write_native_rational<PLAINTEXT_OUTPUT>(expected, val);
+            write_native_rational<TYPESET_OUTPUT>(out, val);
+            write_native_rational<TYPESET_OUTPUT>(expected, val);
+        }
+        REQUIRE(out.str() == expected);
+    }
+
+    SECTION("write_float"){
+        for(const FloatingPoint val : {0.0l, 1.5l, 2.998e8l}){
+            write_float(out, val);
+            write_float(expected, val);
+        }
+        REQUIRE(out.str() == expected);
+    }
+
+    SECTION("write_big_int"){
+        mpz_t val;
+        mpz_init(val);
+        mpz_fac_ui(val, 30);
+        write_big_int(out, val);
+        write_big_int(expected, val);
+        mpz_neg(val, val);
+        write_big_int(out, val);
+        write_big_int(expected, val);
+        mpz_clear(val);
+
+        REQUIRE(out.str() == expected);
+        REQUIRE(expected == "265252859812191058636308480000000-265252859812191058636308480000000");
+    }
+
+    SECTION("write_big_rational"){
+        fmpq_t val;
+        fmpq_init(val);
+        fmpz_set_si(fmpq_numref(val), -1);
+        fmpz_fac_ui(fmpq_denref(val), 30);
+
+        write_big_rational<PLAINTEXT_OUTPUT>(out, val);
+        write_big_rational<PLAINTEXT_OUTPUT>(expected, val);
+        write_big_rational<TYPESET_OUTPUT>(out, val);
+        write_big_rational<TYPESET_OUTPUT>(expected, val);
+
+        fmpq_set_ui(val, 3, 2);
+        write_big_rational<PLAINTEXT_OUTPUT>(out, val);
+        write_big_rational<PLAINTEXT_OUTPUT>(expected, val);
+        write_big_rational<TYPESET_OUTPUT>(out, val);
+        write_big_rational<TYPESET_OUTPUT>(expected, val);
+        fmpq_clear(val);
+
+        REQUIRE(out.str() == expected);
+    }
+
+    LEAK_CHECK_REQUIRE(isAllGmpMemoryFreed_resetIfNot());
+}
@@ -0,0 +1,253 @@
+#include <catch2/catch_test_macros.hpp>
+
+#include "ki_cas_rational_accumulator.h"
+
+#include <limits>
+#include <numeric>
+#include <vector>
+
+using namespace KiCAS2;
+
+static constexpr size_t MAX = std::numeric_limits<size_t>::max();
+
+TEST_CASE( "RationalSumAccumulator" ) {
+    RationalSumAccumulator sum;
+    NativeRational result;
+
+    SECTION("Empty"){
+        REQUIRE_FALSE(sum.ckd_result(&result));
+        REQUIRE(result.num == 0);
+        REQUIRE(result.den == 1);
+    }
+
+    SECTION("Reduces once at the end"){
+        REQUIRE_FALSE(sum.ckd_add(NativeRational(1, 6)));
+        REQUIRE_FALSE(sum.ckd_add(NativeRational(1, 4)));
+        REQUIRE_FALSE(sum.ckd_add(NativeRational(1, 12)));
+        REQUIRE_FALSE(sum.ckd_result(&result));
+        REQUIRE(result.num == 1);
+        REQUIRE(result.den == 2);
+    }
+
+    SECTION("Numerator wider than a word"){
+        for(size_t i = 0; i < 1000; i++) REQUIRE_FALSE(sum.ckd_add(NativeRational(MAX, 3)));
+        REQUIRE(sum.ckd_result(&result));
+
+        RationalSumAccumulator cancelling;
+        REQUIRE_FALSE(cancelling.ckd_add(NativeRational(MAX, MAX-1)));
+        REQUIRE_FALSE(cancelling.ckd_add(NativeRational(MAX-2, MAX-1)));
+        REQUIRE_FALSE(cancelling.ckd_result(&result));
+        REQUIRE(result.num == 2);
+        REQUIRE(result.den == 1);
+    }
+
+    SECTION("Cancels before giving up on the denominator"){
+        // The running denominator is a large multiple of the reduced one
+        REQUIRE_FALSE(sum.ckd_add(NativeRational(1, MAX/3)));
+        REQUIRE_FALSE(sum.ckd_add(NativeRational(MAX/3 - 1, MAX/3)));
+        REQUIRE_FALSE(sum.ckd_add(NativeRational(1, 7)));
+        REQUIRE_FALSE(sum.ckd_result(&result));
+        REQUIRE(result.num == 8);
+        REQUIRE(result.den == 7);
+    }
+
+    SECTION("Cancels over a denominator wider than a word"){
+        // The lcm 15·2^61 overflows, but the sum 8/(15·2^61) cancels to fit
+        const size_t power_of_two = size_t(1) << (std::numeric_limits<size_t>::digits - 3);
+        REQUIRE_FALSE(sum.ckd_add(NativeRational(1, 3*power_of_two)));
+        REQUIRE_FALSE(sum.ckd_add(NativeRational(1, 5*power_of_two)));
+        REQUIRE_FALSE(sum.ckd_result(&result));
+        REQUIRE(result.num == 1);
+        REQUIRE(result.den == 15*(power_of_two/8));
+
+        // An unreduced term cancels too: 4/(3·2^61) + 4/(5·2^61) == 32/(15·2^61)
+        RationalSumAccumulator unreduced;
+        REQUIRE_FALSE(unreduced.ckd_add(NativeRational(3, 9*(power_of_two/4))));
+        REQUIRE_FALSE(unreduced.ckd_add(NativeRational(4, 5*power_of_two)));
+        REQUIRE_FALSE(unreduced.ckd_result(&result));
+        REQUIRE(result.num == 1);
+        REQUIRE(result.den == 15*(power_of_two/32));
+    }
+
+    SECTION("Overflow leaves the sum unchanged"){
+        REQUIRE_FALSE(sum.ckd_add(NativeRational(1, MAX)));
+        REQUIRE(sum.ckd_add(NativeRational(1, MAX-1)));
+        REQUIRE_FALSE(sum.ckd_add(NativeRational(2, MAX)));
+        REQUIRE_FALSE(sum.ckd_result(&result));
+        REQUIRE(result == NativeRational(3, MAX));
+
+        REQUIRE(sum.ckd_add_product(NativeRational(MAX, 1), NativeRational(2, 1)));
+        REQUIRE_FALSE(sum.ckd_result(&result));
+        REQUIRE(result == NativeRational(3, MAX));
+    }
+
+    SECTION("Zero terms do not grow the denominator"){
+        REQUIRE_FALSE(sum.ckd_add(NativeRational(1, MAX)));
+        REQUIRE_FALSE(sum.ckd_add(NativeRational(0, MAX-1)));
+        REQUIRE_FALSE(sum.ckd_add(NativeRational(1, MAX)));
+        REQUIRE_FALSE(sum.ckd_result(&result));
+        REQUIRE(result.num == 2);
+        REQUIRE(result.den == MAX);
+    }
+}
+
+TEST_CASE( "ckd_sum and ckd_dot" ) {
+    NativeRational result;
+
+    const std::vector<NativeRational> vals = {NativeRational(1, 2), NativeRational(2, 3), NativeRational(5, 6),
+                                              NativeRational(3, 4), NativeRational(7, 12)};
+    REQUIRE_FALSE(ckd_sum(&result, vals.data(), vals.size()));
+    REQUIRE(result.num == 10);
+    REQUIRE(result.den == 3);
+
+    REQUIRE_FALSE(ckd_dot(&result, vals.data(), vals.data(), vals.size()));
+    NativeRational expected(0, 1);
+    for(const NativeRational val : vals){
+        NativeRational square;
+        REQUIRE_FALSE(ckd_mul(&square, val, val));
+        REQUIRE_FALSE(ckd_add(&expected, expected, square));
+    }
+    expected.reduceInPlace();
+    REQUIRE(result.num == expected.num);
+    REQUIRE(result.den == expected.den);
+
+    REQUIRE_FALSE(ckd_sum(&result, nullptr, 0));
+    REQUIRE(result.num == 0);
+
+    SECTION("Denominators whose lcm overflows"){
+        const size_t power_of_two = size_t(1) << (std::numeric_limits<size_t>::digits - 3);
+        const std::vector<NativeRational> wide = {NativeRational(1, 3*power_of_two), NativeRational(1, 5*power_of_two)};
+        REQUIRE_FALSE(ckd_sum(&result, wide.data(), wide.size()));
+        REQUIRE(result == NativeRational(1, 15*(power_of_two/8)));
+
+        const std::vector<NativeRational> ones = {NativeRational(1, 1), NativeRational(1, 1)};
+        REQUIRE_FALSE(ckd_dot(&result, wide.data(), ones.data(), wide.size()));
+        REQUIRE(result == NativeRational(1, 15*(power_of_two/8)));
+
+        NativeRational chained;
+        REQUIRE_FALSE(ckd_add(&chained, wide[0], wide[1]));
+        REQUIRE(chained == result);
+    }
+
+    SECTION("Matches chained ckd_add"){
+        size_t state = 0x2545F4914F6CDD1Du;
+        auto next = [&state](){
+            state ^= state << 13;
+            state ^= state >> 7;
+            state ^= state << 17;
+            return state;
+        };
+
+        for(size_t i = 0; i < 4000; i++){
+            std::vector<NativeRational> terms;
+            const size_t num_terms = next() % 16;
+            // Some denominators share a large power of two, so their lcm overflows while sums may cancel to fit
+            const size_t shift = (i % 2) ? std::numeric_limits<size_t>::digits - 6 : 0;
+            for(size_t j = 0; j < num_terms; j++)
+                terms.emplace_back(next() >> (next() % std::numeric_limits<size_t>::digits | 8), (next() % 30 + 1) << shift);
+
+            NativeRational chained(0, 1);
+            bool chained_overflow = false;
+            for(const NativeRational term : terms){
+                chained_overflow = ckd_add(&chained, chained, term);
+                if(chained_overflow) break;
+                chained.reduceInPlace();
+            }
+
+            const bool overflow = ckd_sum(&result, terms.data(), terms.size());
+            if(!chained_overflow){
+                REQUIRE_FALSE(overflow);
+                REQUIRE(result.num == chained.num);
+                REQUIRE(result.den == chained.den);
+            }
+        }
+    }
+}
+
+TEST_CASE( "RationalProductAccumulator" ) {
+    RationalProductAccumulator product;
+    NativeRational result;
+
+    SECTION("Empty"){
+        REQUIRE_FALSE(product.ckd_result(&result));
+        REQUIRE(result.num == 1);
+        REQUIRE(result.den == 1);
+    }
+
+    SECTION("Native chain"){
+        product.mul(NativeRational(3, 4));
+        product.div(NativeRational(9, 8));
+        REQUIRE_FALSE(product.ckd_result(&result));
+        REQUIRE(result.num == 2);
+        REQUIRE(result.den == 3);
+        REQUIRE(product.numeratorFactors().empty());
+    }
+
+    SECTION("Intermediate products which do not fit"){
+        // A chain out and back again, whose running product overflows half way
+        const size_t primes[] = {1000003, 1000033, 1000037, 1000039, 1000081, 1000099};
+        for(const size_t prime : primes) product.mul(NativeRational(prime, 7));
+        REQUIRE_FALSE(product.numeratorFactors().empty());
+        for(const size_t prime : primes) product.div(NativeRational(prime, 5));
+
+        REQUIRE_FALSE(product.ckd_result(&result));
+        REQUIRE(result.num == 15625);
+        REQUIRE(result.den == 117649);
+        REQUIRE(product.numeratorFactors().empty());
+        REQUIRE(product.denominatorFactors().empty());
+
+        // The chain continues natively from the result
+        product.mul(NativeRational(117649, 5));
+        REQUIRE_FALSE(product.ckd_result(&result));
+        REQUIRE(result.num == 3125);
+        REQUIRE(result.den == 1);
+    }
+
+    SECTION("Result which does not fit"){
+        for(size_t i = 0; i < 8; i++) product.mul(NativeRational(MAX, 2*i + 3));
+        REQUIRE(product.ckd_result(&result));
+
+        // The factors are left cancelled and pairwise coprime
+        for(const size_t num_factor : product.numeratorFactors())
+            for(const size_t den_factor : product.denominatorFactors())
+                REQUIRE(std::gcd(num_factor, den_factor) == 1);
+    }
+
+    SECTION("Zero"){
+        for(size_t i = 0; i < 8; i++) product.mul(NativeRational(MAX, 2*i + 3));
+        product.mul(NativeRational(0, 1));
+        product.mul(NativeRational(MAX, 5));
+        REQUIRE_FALSE(product.ckd_result(&result));
+        REQUIRE(result.num == 0);
+        REQUIRE(result.den == 1);
+    }
+
+    SECTION("Matches fully reduced chains"){
+        size_t state = 0x5851F42D4C957F2Du;
+        auto next = [&state](){
+            state ^= state << 13;
+            state ^= state >> 7;
+            state ^= state << 17;
+            return state;
+        };
+
+        for(size_t i = 0; i < 2000; i++){
+            RationalProductAccumulator accumulator;
+            NativeRational expected(1, 1);
+            bool expected_overflow = false;
+            const size_t num_factors = next() % 24;
+            for(size_t j = 0; j < num_factors; j++){
+                const NativeRational factor(next() % 1000 + 1, next() % 1000 + 1);
+                accumulator.mul(factor);
+                expected_overflow = expected_overflow || ckd_mul(&expected, expected, factor);
+                expected.reduceInPlace();
+            }
+
+            if(!expected_overflow){
+                REQUIRE_FALSE(accumulator.ckd_result(&result));
+                REQUIRE(result.num == expected.num);
+                REQUIRE(result.den == expected.den);
+            }
+        }
+    }
+}
@@ -0,0 +1,97 @@
+#include <catch2/catch_test_macros.hpp>
+
+#include "ki_cas_rational_sort.h"
+
+#include <algorithm>
+#include <limits>
+#include <numeric>
+#include <vector>
+
+using namespace KiCAS2;
+
+static constexpr size_t MAX = std::numeric_limits<size_t>::max();
+
+/// Values across the whole range, with many which are equal or differ only beyond the bits of a key
+static std::vector<NativeRational> unsortedValues(size_t size) {
+    size_t state = 0x2545F4914F6CDD1Du;
+    auto next = [&state](){
+        state ^= state << 13;
+        state ^= state >> 7;
+        state ^= state << 17;
+        return state;
+    };
+
+    std::vector<NativeRational> vals;
+    for(size_t i = 0; i < size; i++){
+        switch(next() % 4){
+            case 0: vals.emplace_back(next() >> (next() % std::numeric_limits<size_t>::digits),
+                                      (next() >> (next() % std::numeric_limits<size_t>::digits)) | 1); break;
+            case 1: vals.emplace_back(next() % 10, next() % 10 + 1); break;
+            case 2: vals.emplace_back(MAX - next() % 4, MAX - 1 - next() % 4); break;
+            default: vals.emplace_back(next() % 3 + 1, MAX - next() % 3); break;
+        }
+    }
+
+    return vals;
+}
+
+TEST_CASE( "rational_sort_key" ) {
+    REQUIRE(rational_sort_key(NativeRational(0, 7)) == 0);
+    REQUIRE(rational_sort_key(NativeRational(1, 2)) == rational_sort_key(NativeRational(2, 4)));
+    REQUIRE(rational_sort_key(NativeRational(1, 3)) < rational_sort_key(NativeRational(1, 2)));
+    REQUIRE(rational_sort_key(NativeRational(1, 1000001)) < rational_sort_key(NativeRational(1, 1000000)));
+
+    // Values which differ beyond the bits of the key tie
+    REQUIRE(rational_sort_key(NativeRational(1, MAX)) == rational_sort_key(NativeRational(1, MAX-1)));
+    REQUIRE(rational_sort_key(NativeRational(MAX-1, 1)) == rational_sort_key(NativeRational(MAX, 1)));
+    REQUIRE(rational_sort_key(NativeRational(MAX, MAX-1)) == rational_sort_key(NativeRational(MAX-1, MAX-2)));
+
+    SECTION("Never decreases as the value increases"){
+        std::vector<NativeRational> vals = unsortedValues(5000);
+        std::sort(vals.begin(), vals.end());
+        for(size_t i = 1; i < vals.size(); i++){
+            REQUIRE(rational_sort_key(vals[i-1]) <= rational_sort_key(vals[i]));
+            if(vals[i-1] == vals[i]) REQUIRE(rational_sort_key(vals[i-1]) == rational_sort_key(vals[i]));
+        }
+    }
+}
+
+TEST_CASE( "sort_native_rationals and argsort_native_rationals" ) {
+    SECTION("Small"){
+        std::vector<NativeRational> vals = {NativeRational(3, 4), NativeRational(0, 1), NativeRational(6, 8),
+                                            NativeRational(MAX, 1), NativeRational(1, MAX)};
+        std::vector<size_t> indices(vals.size());
+        argsort_native_rationals(indices.data(), vals.data(), vals.size());
+        REQUIRE(indices == std::vector<size_t>{1, 4, 0, 2, 3});
+
+        sort_native_rationals(vals.data(), vals.size());
+        REQUIRE(vals[0].num == 0);
+        REQUIRE(vals[1] == NativeRational(1, MAX));
+        REQUIRE(vals[2].num == 3);
+        REQUIRE(vals[3].num == 6);
+        REQUIRE(vals[4] == MAX);
+
+        sort_native_rationals(nullptr, 0);
+        argsort_native_rationals(nullptr, nullptr, 0);
+    }
+
+    SECTION("Matches std::stable_sort"){
+        const std::vector<NativeRational> vals = unsortedValues(20000);
+        std::vector<size_t> expected(vals.size());
+        std::iota(expected.begin(), expected.end(), size_t(0));
+        std::stable_sort(expected.begin(), expected.end(), [&vals](size_t a, size_t b){ return vals[a] < vals[b]; });
+
+        for(const size_t num_threads : {1, 2, 3}){
+            std::vector<size_t> indices(vals.size());
+            argsort_native_rationals(indices.data(), vals.data(), vals.size(), num_threads);
+            REQUIRE(indices == expected);
+
+            std::vector<NativeRational> sorted = vals;
+            sort_native_rationals(sorted.data(), sorted.size(), num_threads);
+            for(size_t i = 0; i < sorted.size(); i++){
+                REQUIRE(sorted[i].num == vals[expected[i]].num);
+                REQUIRE(sorted[i].den == vals[expected[i]].den);
+            }
+        }
+    }
+}
@@ -0,0 +1,254 @@
+#include <catch2/catch_test_macros.hpp>
+
+#include "ki_cas_scaled_decimal.h"
+
+#include <cmath>
+#include <limits>
+
+using namespace KiCAS2;
+
+static constexpr size_t MAX = std::numeric_limits<size_t>::max();
+
+static bool identical(ScaledDecimal a, ScaledDecimal b) noexcept {
+    return a.mantissa == b.mantissa && a.exponent == b.exponent;
+}
+
+TEST_CASE( "ckd_strdecimal2scaled" ) {
+    ScaledDecimal result;
+
+    REQUIRE_FALSE(ckd_strdecimal2scaled(&result, "12.34"));
+    REQUIRE(identical(result, ScaledDecimal(1234, -2)));
+
+    SECTION("Trailing zeros are kept"){
+        REQUIRE_FALSE(ckd_strdecimal2scaled(&result, "12.50"));
+        REQUIRE(identical(result, ScaledDecimal(1250, -2)));
+
+        REQUIRE_FALSE(ckd_strdecimal2scaled(&result, "4200"));
+        REQUIRE(identical(result, ScaledDecimal(4200, 0)));
+
+        REQUIRE_FALSE(ckd_strdecimal2scaled(&result, "42."));
+        REQUIRE(identical(result, ScaledDecimal(42, 0)));
+    }
+
+    SECTION("Leading zeros"){
+        REQUIRE_FALSE(ckd_strdecimal2scaled(&result, "007.500"));
+        REQUIRE(identical(result, ScaledDecimal(7500, -3)));
+
+        REQUIRE_FALSE(ckd_strdecimal2scaled(&result, ".0001"));
+        REQUIRE(identical(result, ScaledDecimal(1, -4)));
+
+        REQUIRE_FALSE(ckd_strdecimal2scaled(&result, ".000"));
+        REQUIRE(identical(result, ScaledDecimal(0, -3)));
+
+        REQUIRE_FALSE(ckd_strdecimal2scaled(&result, ".00000000000000000000000000001"));
+        REQUIRE(identical(result, ScaledDecimal(1, -29)));
+    }
+
+    SECTION("Overflow"){
+        REQUIRE(ckd_strdecimal2scaled(&result, "123456789012345678901234567890"));
+        REQUIRE(ckd_strdecimal2scaled(&result, "1.23456789012345678901234567890"));
+
+        const std::string max_str = std::to_string(MAX);
+        REQUIRE_FALSE(ckd_strdecimal2scaled(&result, max_str));
+        REQUIRE(identical(result, ScaledDecimal(MAX, 0)));
+        REQUIRE(ckd_strdecimal2scaled(&result, std::to_string(MAX/10 + 1) + '0'));
+        REQUIRE(ckd_strdecimal2scaled(&result, std::to_string(MAX/10) + '9'));
+
+        // Trailing zeros beyond the capacity of the mantissa move into the exponent
+        REQUIRE_FALSE(ckd_strdecimal2scaled(&result, max_str + "000"));
+        REQUIRE(identical(result, ScaledDecimal(MAX, 3)));
+        REQUIRE_FALSE(ckd_strdecimal2scaled(&result, "1." + std::string(40, '0')));
+        REQUIRE(result == ScaledDecimal(1, 0));
+        REQUIRE(result.exponent > -40);
+    }
+}
+
+TEST_CASE( "ckd_strscientific2scaled" ) {
+    ScaledDecimal result;
+
+    REQUIRE_FALSE(ckd_strscientific2scaled(&result, "2.998e8"));
+    REQUIRE(identical(result, ScaledDecimal(2998, 5)));
+
+    REQUIRE_FALSE(ckd_strscientific2scaled(&result, "4.70e-6"));
+    REQUIRE(identical(result, ScaledDecimal(470, -8)));
+
+    REQUIRE_FALSE(ckd_strscientific2scaled(&result, "15e+3"));
+    REQUIRE(identical(result, ScaledDecimal(15, 3)));
+
+    REQUIRE_FALSE(ckd_strscientific2scaled(&result, ".5e1"));
+    REQUIRE(identical(result, ScaledDecimal(5, 0)));
+
+    SECTION("Exponent overflow"){
+        REQUIRE_FALSE(ckd_strscientific2scaled(&result, "1e32767"));
+        REQUIRE(identical(result, ScaledDecimal(1, 32767)));
+        REQUIRE(ckd_strscientific2scaled(&result, "1e32768"));
+        REQUIRE_FALSE(ckd_strscientific2scaled(&result, "1e-32768"));
+        REQUIRE(ckd_strscientific2scaled(&result, "1.5e-32768"));
+        REQUIRE(ckd_strscientific2scaled(&result, "1e99999999999999999999999"));
+    }
+}
+
+TEST_CASE( "ScaledDecimal comparison" ) {
+    const ScaledDecimal one_and_a_half(15, -1);
+    const ScaledDecimal one_and_a_half_padded(1500, -3);
+    const ScaledDecimal two(2, 0);
+    const ScaledDecimal kilo(1, 3);
+
+    REQUIRE(one_and_a_half == one_and_a_half_padded);
+    REQUIRE_FALSE(one_and_a_half != one_and_a_half_padded);
+    REQUIRE(one_and_a_half < two);
+    REQUIRE(two > one_and_a_half_padded);
+    REQUIRE(kilo > ScaledDecimal(999, 0));
+    REQUIRE(kilo >= ScaledDecimal(1000, 0));
+    REQUIRE(kilo <= ScaledDecimal(1000, 0));
+    REQUIRE(ScaledDecimal(0, 5) == ScaledDecimal(0, -5));
+
+    SECTION("Alignment overflow"){
+        REQUIRE(ScaledDecimal(1, 100) > ScaledDecimal(MAX, 0));
+        REQUIRE(ScaledDecimal(MAX, -100) < ScaledDecimal(1, 0));
+        REQUIRE(ScaledDecimal(MAX, 1) > ScaledDecimal(MAX, 0));
+    }
+}
+
+TEST_CASE( "ckd_mul (ScaledDecimal * ScaledDecimal)" ) {
+    ScaledDecimal result;
+
+    REQUIRE_FALSE(ckd_mul(&result, ScaledDecimal(250, -2), ScaledDecimal(4, 3)));
+    REQUIRE(identical(result, ScaledDecimal(1000, 1)));
+
+    SECTION("Overflow"){
+        REQUIRE(ckd_mul(&result, ScaledDecimal(MAX, 0), ScaledDecimal(2, 0)));
+        REQUIRE(ckd_mul(&result, ScaledDecimal(1, 30000), ScaledDecimal(1, 30000)));
+        REQUIRE(ckd_mul(&result, ScaledDecimal(1, -30000), ScaledDecimal(1, -30000)));
+    }
+}
+
+TEST_CASE( "ckd_add (ScaledDecimal + ScaledDecimal)" ) {
+    ScaledDecimal result;
+
+    REQUIRE_FALSE(ckd_add(&result, ScaledDecimal(1250, -2), ScaledDecimal(3, 0)));
+    REQUIRE(identical(result, ScaledDecimal(1550, -2)));
+
+    REQUIRE_FALSE(ckd_add(&result, ScaledDecimal(1, 3), ScaledDecimal(5, -1)));
+    REQUIRE(identical(result, ScaledDecimal(10005, -1)));
+
+    REQUIRE_FALSE(ckd_add(&result, ScaledDecimal(0, 100), ScaledDecimal(7, 0)));
+    REQUIRE(identical(result, ScaledDecimal(7, 0)));
+
+    SECTION("Overflow"){
+        REQUIRE(ckd_add(&result, ScaledDecimal(MAX, 0), ScaledDecimal(1, 0)));
+        REQUIRE(ckd_add(&result, ScaledDecimal(1, 100), ScaledDecimal(1, 0)));
+    }
+}
+
+TEST_CASE( "ckd_sub (ScaledDecimal - ScaledDecimal)" ) {
+    ScaledDecimal result;
+
+    REQUIRE_FALSE(ckd_sub(&result, ScaledDecimal(1250, -2), ScaledDecimal(3, 0)));
+    REQUIRE(identical(result, ScaledDecimal(950, -2)));
+
+    REQUIRE_FALSE(ckd_sub(&result, ScaledDecimal(3, 0), ScaledDecimal(250, -2)));
+    REQUIRE(identical(result, ScaledDecimal(50, -2)));
+
+    REQUIRE_FALSE(ckd_sub(&result, ScaledDecimal(15, -1), ScaledDecimal(1500, -3)));
+    REQUIRE(identical(result, ScaledDecimal(0, -3)));
+
+    SECTION("Wide minuend"){
+        // The aligned minuend overflows, but the difference fits
+        REQUIRE_FALSE(ckd_sub(&result, ScaledDecimal(MAX/10 + 1, 1), ScaledDecimal(10, 0)));
+        REQUIRE(identical(result, ScaledDecimal((MAX/10 + 1)*10 - 10, 0)));
+
+        REQUIRE(ckd_sub(&result, ScaledDecimal(MAX, 1), ScaledDecimal(1, 0)));
+        REQUIRE(ckd_sub(&result, ScaledDecimal(1, 100), ScaledDecimal(1, 0)));
+    }
+
+    SECTION("Zero with a wide exponent gap"){
+        REQUIRE_FALSE(ckd_sub(&result, ScaledDecimal(0, 30), ScaledDecimal(0, 0)));
+        REQUIRE(identical(result, ScaledDecimal(0, 0)));
+
+        REQUIRE_FALSE(ckd_sub(&result, ScaledDecimal(0, 30), ScaledDecimal(0, -5)));
+        REQUIRE(identical(result, ScaledDecimal(0, -5)));
+    }
+}
+
+TEST_CASE( "write_scaled_decimal" ) {
+    std::string out;
+
+    SECTION("General"){
+        write_scaled_decimal(out, ScaledDecimal(1250, -2));
+        REQUIRE(out == "12.5");
+        out.clear();
+        write_scaled_decimal(out, ScaledDecimal(42, 0));
+        REQUIRE(out == "42");
+        out.clear();
+        write_scaled_decimal(out, ScaledDecimal(2998, 5));
+        REQUIRE(out == "2.998e+08");
+        out.clear();
+        write_scaled_decimal(out, ScaledDecimal(1, -4));
+        REQUIRE(out == "0.0001");
+        out.clear();
+        write_scaled_decimal(out, ScaledDecimal(12345, -9));
+        REQUIRE(out == "1.2345e-05");
+        out.clear();
+        write_scaled_decimal(out, ScaledDecimal(0, -3));
+        REQUIRE(out == "0");
+    }
+
+    SECTION("Fixed keeps decimal places"){
+        write_scaled_decimal(out, ScaledDecimal(1250, -2), FloatNotation::Fixed);
+        REQUIRE(out == "12.50");
+        out.clear();
+        write_scaled_decimal(out, ScaledDecimal(5, -3), FloatNotation::Fixed);
+        REQUIRE(out == "0.005");
+        out.clear();
+        write_scaled_decimal(out, ScaledDecimal(2998, 5), FloatNotation::Fixed);
+        REQUIRE(out == "299800000");
+        out.clear();
+        write_scaled_decimal(out, ScaledDecimal(0, -3), FloatNotation::Fixed);
+        REQUIRE(out == "0.000");
+        out.clear();
+        write_scaled_decimal(out, ScaledDecimal(0, 3), FloatNotation::Fixed);
+        REQUIRE(out == "0");
+    }
+
+    SECTION("Scientific"){
+        write_scaled_decimal(out, ScaledDecimal(4200, 0), FloatNotation::Scientific);
+        REQUIRE(out == "4.2e+03");
+        out.clear();
+        write_scaled_decimal(out, ScaledDecimal(0, 0), FloatNotation::Scientific);
+        REQUIRE(out == "0e+00");
+        out.clear();
+        write_scaled_decimal(out, ScaledDecimal(1, -300), FloatNotation::Scientific);
+        REQUIRE(out == "1e-300");
+    }
+
+    SECTION("Matches write_float where exact"){
+        for(const ScaledDecimal val : {ScaledDecimal(15, -1), ScaledDecimal(625, -4), ScaledDecimal(42, 0),
+                                       ScaledDecimal(2998, 5), ScaledDecimal(1, -4), ScaledDecimal(125, -5)}){
+            for(const FloatNotation notation : {FloatNotation::General, FloatNotation::Scientific}){
+                std::string expected;
+                write_float(expected, static_cast<FloatingPoint>(val.mantissa) * std::pow(FloatingPoint(10), val.exponent),
+                            notation);
+                std::string str;
+                write_scaled_decimal(str, val, notation);
+                REQUIRE(str == expected);
+            }
+        }
+    }
+
+    SECTION("OutputBuilder"){
+        OutputBuilder builder;
+        write_scaled_decimal(builder, ScaledDecimal(1250, -2), FloatNotation::Fixed);
+        REQUIRE(builder.str() == "12.50");
+    }
+}
+
+TEST_CASE( "ScaledDecimal round trip" ) {
+    for(const char* str : {"12.50", "0.001", "4200", "3.14159", "0.000"}){
+        ScaledDecimal val;
+        REQUIRE_FALSE(ckd_strdecimal2scaled(&val, str));
+        std::string out;
+        write_scaled_decimal(out, val, FloatNotation::Fixed);
+        REQUIRE(out == str);
+    }
+}
@@ -0,0 +1,81 @@
+#include <catch2/catch_test_macros.hpp>
+
+#include "ki_cas_wide_integer.h"
+
+#include <limits>
+#include <numeric>
+
+using namespace KiCAS2;
+
+static constexpr size_t MAX = std::numeric_limits<size_t>::max();
+
+TEST_CASE( "count_trailing_zeros" ) {
+    REQUIRE(count_trailing_zeros(1) == 0);
+    REQUIRE(count_trailing_zeros(12) == 2);
+    REQUIRE(count_trailing_zeros(MAX) == 0);
+    REQUIRE(count_trailing_zeros(size_t(1) << (std::numeric_limits<size_t>::digits-1))
+            == std::numeric_limits<size_t>::digits-1);
+}
+
+TEST_CASE( "mul_wide and div_wide" ) {
+    size_t high;
+    size_t remainder;
+
+    REQUIRE(mul_wide(3, 5, &high) == 15);
+    REQUIRE(high == 0);
+
+    // (2^n - 1)^2 = 2^n (2^n - 2) + 1
+    REQUIRE(mul_wide(MAX, MAX, &high) == 1);
+    REQUIRE(high == MAX-1);
+
+    REQUIRE(div_wide(MAX-1, 1, MAX, &remainder) == MAX);
+    REQUIRE(remainder == 0);
+
+    REQUIRE(div_wide(0, 17, 5, &remainder) == 3);
+    REQUIRE(remainder == 2);
+
+    const size_t words[] = {1, 0, 3};
+    REQUIRE(mod_words(words, 3, MAX) == 4);
+}
+
+TEST_CASE( "inverse_mod_word" ) {
+    for(const size_t odd : {size_t(1), size_t(3), size_t(125), MAX/3, MAX}){
+        REQUIRE(odd * inverse_mod_word(odd) == 1);
+    }
+
+    // Dividing by an odd divisor which divides exactly is multiplying by its inverse
+    REQUIRE(size_t(625 * 12345) * inverse_mod_word(625) == 12345);
+}
+
+TEST_CASE( "binary_gcd" ) {
+    REQUIRE(binary_gcd(0, 0) == 0);
+    REQUIRE(binary_gcd(0, 7) == 7);
+    REQUIRE(binary_gcd(7, 0) == 7);
+    REQUIRE(binary_gcd(12, 18) == 6);
+    REQUIRE(binary_gcd(MAX, MAX-1) == 1);
+    REQUIRE(binary_gcd(MAX-1, (MAX-1)/2) == (MAX-1)/2);
+
+    SECTION("Matches std::gcd"){
+        size_t state = 0x9E3779B97F4A7C15u;
+        auto next = [&state](){
+            state ^= state << 13;
+            state ^= state >> 7;
+            state ^= state << 17;
+            return state;
+        };
+
+        for(size_t i = 0; i < 10000; i++){
+            const size_t common = next() >> (next() % std::numeric_limits<size_t>::digits);
+            const size_t a = next() % 1000000 * common;
+            const size_t b = next() >> (next() % std::numeric_limits<size_t>::digits) << (next() % 8);
+            REQUIRE(binary_gcd(a, b) == std::gcd(a, b));
+        }
+    }
+
+    SECTION("Multi-word"){
+        // 6 * 2^n shares only the factor 6 with 6 * (2^(n-3) - 1)
+        const size_t words[] = {6, 0};
+        const size_t odd = (size_t(1) << (std::numeric_limits<size_t>::digits-3)) - 1;
+        REQUIRE(binary_gcd(words, 2, 6*odd) == 6);
+    }
+}